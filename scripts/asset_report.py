@@ -0,0 +1,98 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Report the ROM and RAM footprint of every embedded web asset found in the
+# final Zephyr ELF image.
+#
+# A symbol placed in a read-only allocated section costs ROM only. A symbol in
+# an initialised writable section (.data) costs RAM plus the ROM copy used to
+# initialise it at boot, and a symbol in a NOBITS section (.bss) costs RAM
+# only. The report makes it obvious when an asset falls back into RAM, e.g.
+# because a "const" qualifier went missing.
+
+import argparse
+import re
+import sys
+
+from elftools.elf.constants import SH_FLAGS
+from elftools.elf.elffile import ELFFile
+from elftools.elf.sections import SymbolTableSection
+
+
+def classify(section):
+    """Return (rom, ram) multipliers for a symbol living in @section."""
+    flags = section['sh_flags']
+
+    if not flags & SH_FLAGS.SHF_ALLOC:
+        return 0, 0
+
+    if not flags & SH_FLAGS.SHF_WRITE:
+        return 1, 0
+
+    if section['sh_type'] == 'SHT_NOBITS':
+        return 0, 1
+
+    return 1, 1
+
+
+def collect(elf, pattern):
+    symtab = elf.get_section_by_name('.symtab')
+    if not isinstance(symtab, SymbolTableSection):
+        sys.exit("No symbol table in ELF file, cannot report asset sizes")
+
+    assets = []
+    for sym in symtab.iter_symbols():
+        if sym['st_info']['type'] != 'STT_OBJECT' or sym['st_size'] == 0:
+            continue
+
+        if not pattern.search(sym.name):
+            continue
+
+        shndx = sym['st_shndx']
+        if not isinstance(shndx, int):
+            continue
+
+        section = elf.get_section(shndx)
+        rom, ram = classify(section)
+        size = sym['st_size']
+        assets.append((sym.name, section.name, size * rom, size * ram))
+
+    return sorted(assets)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('elf', help='Zephyr ELF image')
+    parser.add_argument('--pattern', default=r'_(gz|br|raw)$',
+                        help='Regular expression matching asset symbol names')
+    parser.add_argument('--output', help='Also write the report to this file')
+    args = parser.parse_args()
+
+    with open(args.elf, 'rb') as f:
+        assets = collect(ELFFile(f), re.compile(args.pattern))
+
+    lines = [f"{'asset':<32} {'section':<24} {'ROM':>8} {'RAM':>8}"]
+    total_rom = 0
+    total_ram = 0
+    for name, section, rom, ram in assets:
+        lines.append(f"{name:<32} {section:<24} {rom:>8} {ram:>8}")
+        total_rom += rom
+        total_ram += ram
+    lines.append(f"{'total':<32} {'':<24} {total_rom:>8} {total_ram:>8}")
+
+    report = "\n".join(lines)
+    print("Web asset footprint (bytes):")
+    print(report)
+
+    if args.output:
+        with open(args.output, 'w') as f:
+            f.write(report + "\n")
+
+    if total_ram:
+        print("warning: web assets occupy RAM, check they are declared const",
+              file=sys.stderr)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Print the CAN frames streamed by CONFIG_NET_SAMPLE_CAN_GATEWAY.
+
+Connects to the WebSocket resource and decodes the 20 byte records of
+every binary message, see src/CanGateway.h. With --stats only the frame
+and message rates and the frames the device dropped are printed once a
+second. --filter, --channels, --latest and --interval are sent to the
+device as a trace command, so only the selected frames are streamed.
+Needs no packages beyond the standard library, for example:
+
+    can_monitor.py 192.0.2.1 --path /can --stats
+    can_monitor.py 192.0.2.1 --filter 100/700 --filter 18DAF110 --latest
+"""
+
+import argparse
+import base64
+import json
+import os
+import socket
+import struct
+import sys
+import time
+
+RECORD = struct.Struct("<IIBBBB8s")
+
+EXTENDED = 0x01
+RTR = 0x02
+FD = 0x04
+TRUNCATED = 0x08
+OVERFLOW = 0x80
+
+OPCODE_CONTINUATION = 0x0
+OPCODE_TEXT = 0x1
+OPCODE_BINARY = 0x2
+OPCODE_CLOSE = 0x8
+OPCODE_PING = 0x9
+
+
+class WebSocket:
+    """Just enough of RFC 6455 to receive binary messages and send commands."""
+
+    def __init__(self, host, port, path):
+        self.sock = socket.create_connection((host, port), timeout=10)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n"
+                           "Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                           "Sec-WebSocket-Version: 13\r\n\r\n" % (path, host, key)).encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("connection closed during the upgrade")
+            response += chunk
+        status, self.pending = response.split(b"\r\n\r\n", 1)
+        if b" 101 " not in status.split(b"\r\n")[0]:
+            raise ConnectionError(status.split(b"\r\n")[0].decode())
+        self.sock.settimeout(None)
+
+    def read(self, n):
+        while len(self.pending) < n:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            self.pending += chunk
+        data, self.pending = self.pending[:n], self.pending[n:]
+        return data
+
+    def send(self, opcode, payload=b""):
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        if len(payload) < 126:
+            head = struct.pack("!BB", 0x80 | opcode, 0x80 | len(payload))
+        else:
+            head = struct.pack("!BBH", 0x80 | opcode, 0x80 | 126, len(payload))
+        self.sock.sendall(head + mask + masked)
+
+    def message(self):
+        """Return the payload of the next data message, None once closed."""
+        payload = b""
+        while True:
+            head, size = struct.unpack("!BB", self.read(2))
+            size &= 0x7F
+            if size == 126:
+                size = struct.unpack("!H", self.read(2))[0]
+            elif size == 127:
+                size = struct.unpack("!Q", self.read(8))[0]
+            data = self.read(size)
+            opcode = head & 0x0F
+            if opcode == OPCODE_CLOSE:
+                return None
+            if opcode == OPCODE_PING:
+                self.send(0xA, data)
+                continue
+            if opcode in (OPCODE_BINARY, OPCODE_CONTINUATION):
+                payload += data
+                if head & 0x80:
+                    return payload
+
+
+def describe(record):
+    timestamp, can_id, channel, length, flags, count, data = record
+    name = "CAN_%d_%d" % (channel // 4 + 1, channel % 4)
+    if flags & OVERFLOW:
+        return "%10.6f %s dropped %d frames" % (timestamp / 1e6, name, can_id)
+    ident = "%08X" % can_id if flags & EXTENDED else "%03X" % can_id
+    body = "remote" if flags & RTR else data[:length].hex(" ")
+    extra = (" fd" if flags & FD else "") + (" truncated" if flags & TRUNCATED else "")
+    extra += " (%d frames)" % count if count > 1 else ""
+    return "%10.6f %s %s [%d] %s%s" % (timestamp / 1e6, name, ident, length, body, extra)
+
+
+def parse_filter(text):
+    """ID[/MASK] in hex, eight digit identifiers are extended like in candump."""
+    ident, _, mask = text.partition("/")
+    extended = len(ident) == 8
+    full = 0x1FFFFFFF if extended else 0x7FF
+    return {"id": int(ident, 16), "mask": int(mask, 16) if mask else full, "ext": extended}
+
+
+def trace_command(args):
+    command = {}
+    if args.filter:
+        command["filters"] = args.filter
+    if args.channels is not None:
+        command["channels"] = args.channels
+    if args.latest:
+        command["latest"] = True
+    if args.interval is not None:
+        command["interval"] = args.interval
+    return command
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--path", default="/can")
+    parser.add_argument("--stats", action="store_true",
+                        help="print rates and drops instead of frames")
+    parser.add_argument("--filter", type=parse_filter, action="append", metavar="ID[/MASK]",
+                        help="only frames matching this hex identifier, repeatable")
+    parser.add_argument("--channels", type=lambda text: int(text, 0), metavar="MASK",
+                        help="bit mask of controller * 4 + channel")
+    parser.add_argument("--latest", action="store_true",
+                        help="only the latest frame of each identifier per interval")
+    parser.add_argument("--interval", type=int, metavar="MS",
+                        help="milliseconds between messages")
+    args = parser.parse_args()
+
+    ws = WebSocket(args.host, args.port, args.path)
+    command = trace_command(args)
+    if command:
+        ws.send(OPCODE_TEXT, json.dumps(command).encode())
+    frames = messages = dropped = 0
+    report = time.monotonic() + 1
+
+    while True:
+        payload = ws.message()
+        if payload is None:
+            print("closed by the device", file=sys.stderr)
+            return
+        if len(payload) % RECORD.size:
+            print("message of %d bytes is not whole records" % len(payload), file=sys.stderr)
+            continue
+
+        messages += 1
+        for record in RECORD.iter_unpack(payload):
+            if record[4] & OVERFLOW:
+                dropped += record[1]
+            else:
+                frames += max(record[5], 1)
+            if not args.stats:
+                print(describe(record))
+
+        if args.stats and time.monotonic() >= report:
+            print("%d frames/s in %d messages, %d dropped" % (frames, messages, dropped))
+            frames = messages = dropped = 0
+            report += 1
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Run a fleet of native_sim devices on one host and roll configurations out.
+
+"up" starts COUNT instances of the image built with overlay-nsos.conf. Each
+one gets its own HTTP port, flash simulator file and random seed, and an
+identity: a locally administered MAC and an IPv4 address. The address is
+written into the device configuration, which the device keeps in its own
+flash, so a fleet started again from the same directory still knows it.
+The instances run until "up" is interrupted, the manifest it writes
+describes them:
+
+    fleet_sim.py up --exe build/zephyr/zephyr.exe --count 200 --dir fleet
+
+"rollout" pushes a batch of configurations to every device of a manifest
+at once over the WebSocket service, then reads /api/config back until the
+last one is in effect. The time each device took and the time the whole
+fleet took are written as JSON:
+
+    fleet_sim.py rollout fleet/manifest.json --batch 3 --output rollout.json
+
+Needs no packages beyond the standard library.
+"""
+
+import argparse
+import ipaddress
+import json
+import os
+import random
+import signal
+import socket
+import subprocess
+import sys
+import threading
+import time
+import urllib.request
+
+from ws_load_bench import OPCODE_TEXT, WebSocket, config_message, summary
+
+
+def identity(index, network):
+    """MAC and address of instance @index, both derived from the index."""
+    mac = "02:00:5e:%02x:%02x:%02x" % ((index >> 16) & 0xFF, (index >> 8) & 0xFF, index & 0xFF)
+    address = network.network_address + index + 1
+    if address not in network or address == network.broadcast_address:
+        raise ValueError("%s has no address for instance %d" % (network, index))
+    return mac, str(address)
+
+
+def wait_listening(device, process, deadline):
+    while time.monotonic() < deadline:
+        if process.poll() is not None:
+            return "exited with %d" % process.returncode
+        try:
+            socket.create_connection(("127.0.0.1", device["port"]), timeout=1).close()
+            return None
+        except OSError:
+            time.sleep(0.2)
+    return "not listening"
+
+
+def push(device, messages, timeout):
+    """Send @messages over the WebSocket, each one waiting for its reply."""
+    ws = WebSocket(device["host"], device["port"], "/ws_echo", timeout)
+    try:
+        for message in messages:
+            ws.send(OPCODE_TEXT, message)
+            if ws.message() is None:
+                raise ConnectionError("closed by the device")
+    finally:
+        ws.close()
+
+
+def applied(device, expected, timeout):
+    url = "http://%s:%d/api/config" % (device["host"], device["port"])
+    with urllib.request.urlopen(url, timeout=timeout) as rsp:
+        current = json.load(rsp)
+    return all(current.get(key) == value for key, value in expected.items())
+
+
+def provision(device, timeout):
+    message = {"IP4Address": device["ip"]}
+    push(device, [json.dumps(message).encode()], timeout)
+
+
+def up(args):
+    network = ipaddress.ip_network(args.network)
+    os.makedirs(args.dir, exist_ok=True)
+    devices = []
+    processes = []
+
+    def stop(*_):
+        for process in processes:
+            if process.poll() is None:
+                process.terminate()
+        for process in processes:
+            process.wait()
+
+    signal.signal(signal.SIGTERM, lambda *_: sys.exit(0))
+
+    try:
+        for index in range(args.count):
+            name = "dev%03d" % index
+            directory = os.path.join(args.dir, name)
+            os.makedirs(directory, exist_ok=True)
+            mac, address = identity(index, network)
+            device = {
+                "name": name,
+                "host": "127.0.0.1",
+                "port": args.base_port + index,
+                "mac": mac,
+                "ip": address,
+                "flash": os.path.abspath(os.path.join(directory, "flash.bin")),
+                "log": os.path.abspath(os.path.join(directory, "console.log")),
+            }
+            with open(device["log"], "w") as log:
+                process = subprocess.Popen(
+                    [args.exe, "--http-port=%d" % device["port"],
+                     "--flash=%s" % device["flash"], "--seed=%d" % (index + 1)],
+                    stdout=log, stderr=subprocess.STDOUT, stdin=subprocess.DEVNULL)
+            device["pid"] = process.pid
+            devices.append(device)
+            processes.append(process)
+
+        deadline = time.monotonic() + args.startup
+        for device, process in zip(devices, processes):
+            error = wait_listening(device, process, deadline)
+            if error:
+                raise RuntimeError("%s %s, see %s" % (device["name"], error, device["log"]))
+
+        for device in devices:
+            provision(device, args.timeout)
+
+        manifest = os.path.join(args.dir, "manifest.json")
+        with open(manifest, "w") as f:
+            json.dump({"exe": os.path.abspath(args.exe), "devices": devices}, f, indent=2)
+            f.write("\n")
+
+        print("%d devices on ports %d-%d, see %s" %
+              (len(devices), args.base_port, args.base_port + len(devices) - 1, manifest))
+        while all(process.poll() is None for process in processes):
+            time.sleep(1)
+
+        for device, process in zip(devices, processes):
+            if process.poll() is not None:
+                print("%s exited with %d, see %s" %
+                      (device["name"], process.returncode, device["log"]), file=sys.stderr)
+        return 1
+    except KeyboardInterrupt:
+        return 0
+    finally:
+        stop()
+
+
+def load_batch(args, rng):
+    """The configurations every device is sent, the last one is verified."""
+    if args.configs:
+        with open(args.configs) as f:
+            batch = json.load(f)
+        return batch if isinstance(batch, list) else [batch]
+    return [json.loads(config_message(rng)) for _ in range(args.batch)]
+
+
+def rollout_device(device, batch, args, start, results, lock):
+    result = {"name": device["name"], "port": device["port"]}
+    # The address is the device's identity, the batch does not change it
+    messages = [dict(config, IP4Address=device["ip"]) for config in batch]
+    try:
+        begin = time.monotonic()
+        push(device, [json.dumps(m, separators=(",", ":")).encode() for m in messages],
+             args.timeout)
+        pushed = time.monotonic()
+
+        deadline = pushed + args.timeout
+        while not applied(device, messages[-1], args.timeout):
+            if time.monotonic() > deadline:
+                raise TimeoutError("configuration not applied")
+            time.sleep(0.05)
+        done = time.monotonic()
+
+        result.update({
+            "ok": True,
+            "queued_ms": (begin - start) * 1000,
+            "push_ms": (pushed - begin) * 1000,
+            "verify_ms": (done - pushed) * 1000,
+            "total_ms": (done - start) * 1000,
+        })
+    except (OSError, ConnectionError, ValueError) as e:
+        result.update({"ok": False, "error": str(e) or type(e).__name__})
+
+    with lock:
+        results.append(result)
+
+
+def rollout(args):
+    with open(args.manifest) as f:
+        devices = json.load(f)["devices"]
+    batch = load_batch(args, random.Random(args.seed))
+
+    results = []
+    lock = threading.Lock()
+    slots = threading.Semaphore(args.parallel or len(devices))
+
+    def run(device):
+        with slots:
+            rollout_device(device, batch, args, start, results, lock)
+
+    threads = [threading.Thread(target=run, args=(device,)) for device in devices]
+    start = time.monotonic()
+    for thread in threads:
+        thread.start()
+    for thread in threads:
+        thread.join()
+    fleet = time.monotonic() - start
+
+    results.sort(key=lambda result: result["name"])
+    totals = [r["total_ms"] / 1000 for r in results if r["ok"]]
+    report = {
+        "devices": len(devices),
+        "updated": len(totals),
+        "failed": len(devices) - len(totals),
+        "batch": len(batch),
+        "parallel": args.parallel or len(devices),
+        "fleet_ms": fleet * 1000,
+        "device_total": summary(totals, fleet),
+        "results": results,
+    }
+
+    text = json.dumps(report, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    print(text)
+
+    return 0 if report["failed"] == 0 else 1
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    start = commands.add_parser("up", help="start a fleet and keep it running")
+    start.add_argument("--exe", required=True, help="native_sim image, zephyr.exe")
+    start.add_argument("--count", type=int, default=10)
+    start.add_argument("--dir", default="fleet",
+                       help="flash files, console logs and the manifest go here")
+    start.add_argument("--base-port", type=int, default=8080,
+                       help="HTTP port of the first instance, the others follow")
+    start.add_argument("--network", default="10.0.0.0/16",
+                       help="the instances get consecutive addresses of it")
+    start.add_argument("--startup", type=float, default=60, metavar="S",
+                       help="how long the instances may take to listen")
+    start.add_argument("--timeout", type=float, default=10, metavar="S")
+
+    push_cmd = commands.add_parser("rollout", help="push configurations to a fleet")
+    push_cmd.add_argument("manifest", help="manifest.json written by up")
+    push_cmd.add_argument("--batch", type=int, default=1,
+                          help="random configurations sent to every device")
+    push_cmd.add_argument("--configs", metavar="FILE",
+                          help="JSON object or list of them to send instead")
+    push_cmd.add_argument("--parallel", type=int, default=0,
+                          help="devices updated at the same time, 0 for all")
+    push_cmd.add_argument("--timeout", type=float, default=10, metavar="S")
+    push_cmd.add_argument("--seed", type=int, default=1)
+    push_cmd.add_argument("--output", help="write the results as JSON")
+
+    args = parser.parse_args()
+    return up(args) if args.command == "up" else rollout(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,277 @@
+#!/usr/bin/env python3
+#
+# SPDX-License-Identifier: Apache-2.0
+#
+# Generate the HTTP resource table for every file in the static web resource
+# directory.
+#
+# Each file is minified (HTML, JS and CSS), precompressed and emitted as a
+# const byte array together with one WEB_ASSET_*() entry per URL, carrying the
+# URL, the file name relative to the resource directory, the content type and
+# the payload(s). The including C file defines those macros and turns every
+# entry into an HTTP resource, so adding a page to the UI only needs a new
+# file in the resource directory.
+#
+# gzip is always generated and kept when it is smaller than the file. With
+# --brotli a Brotli variant is generated as well and kept when it is smaller
+# than whichever of the two is kept; such assets are served through a dynamic
+# resource which picks the encoding from the request's Accept-Encoding header.
+# When compression does not pay off the file is stored as is.
+
+import argparse
+import gzip
+import os
+import re
+import sys
+
+CONTENT_TYPES = {
+    '.html': 'text/html',
+    '.htm': 'text/html',
+    '.js': 'text/javascript',
+    '.mjs': 'text/javascript',
+    '.css': 'text/css',
+    '.json': 'application/json',
+    '.svg': 'image/svg+xml',
+    '.png': 'image/png',
+    '.jpg': 'image/jpeg',
+    '.jpeg': 'image/jpeg',
+    '.gif': 'image/gif',
+    '.ico': 'image/x-icon',
+    '.txt': 'text/plain',
+    '.wasm': 'application/wasm',
+}
+
+INDEX_FILE = 'index.html'
+
+# Characters after which a '/' starts a regular expression literal rather than
+# a division.
+JS_REGEX_PRECEDERS = set('(,=:[!&|?{};+-*%<>~^')
+
+# Keywords after which a '/' starts a regular expression literal, as in
+# "return /x/.test(s)". Any other word is an operand and '/' divides it.
+JS_REGEX_KEYWORDS = {
+    'case', 'delete', 'do', 'else', 'in', 'instanceof', 'new', 'of', 'return',
+    'throw', 'typeof', 'void', 'yield', 'await',
+}
+
+
+def is_word_char(c):
+    return c.isalnum() or c in '_$'
+
+
+def minify_js(src):
+    """Strip comments and redundant whitespace, keeping line breaks.
+
+    Line breaks are preserved so automatic semicolon insertion behaves exactly
+    as in the original source.
+    """
+    out = []
+    i = 0
+    n = len(src)
+    last = ''
+    # Identifier or keyword that was emitted last, '' if something else was
+    word = ''
+
+    while i < n:
+        c = src[i]
+
+        if c in '\'"`':
+            j = i + 1
+            while j < n and src[j] != c:
+                j += 2 if src[j] == '\\' else 1
+            out.append(src[i:j + 1])
+            last = c
+            word = ''
+            i = j + 1
+        elif src.startswith('/*', i):
+            end = src.find('*/', i + 2)
+            i = n if end < 0 else end + 2
+        elif src.startswith('//', i):
+            end = src.find('\n', i)
+            i = n if end < 0 else end
+        elif c == '/' and (last == '' or last in JS_REGEX_PRECEDERS
+                           or word in JS_REGEX_KEYWORDS):
+            j = i + 1
+            in_class = False
+            while j < n and (in_class or src[j] != '/') and src[j] != '\n':
+                if src[j] == '\\':
+                    j += 1
+                elif src[j] == '[':
+                    in_class = True
+                elif src[j] == ']':
+                    in_class = False
+                j += 1
+            out.append(src[i:j + 1])
+            last = '/'
+            word = ''
+            i = j + 1
+        elif c in ' \t\r':
+            while i < n and src[i] in ' \t\r':
+                i += 1
+            out.append(' ')
+        elif is_word_char(c):
+            j = i
+            while j < n and is_word_char(src[j]):
+                j += 1
+            word = src[i:j]
+            out.append(word)
+            last = src[j - 1]
+            i = j
+        else:
+            out.append(c)
+            if c != '\n':
+                last = c
+                word = ''
+            i += 1
+
+    lines = (line.strip() for line in ''.join(out).split('\n'))
+    return '\n'.join(line for line in lines if line)
+
+
+def minify_css(src):
+    src = re.sub(r'/\*.*?\*/', '', src, flags=re.S)
+    src = re.sub(r'\s+', ' ', src)
+    src = re.sub(r'\s*([{};,>])\s*', r'\1', src)
+    return src.replace(';}', '}').strip()
+
+
+def minify_html(src):
+    src = re.sub(r'<!--(?!\[if).*?-->', '', src, flags=re.S)
+
+    def inline(match):
+        open_tag, body, close_tag = match.groups()
+        if open_tag.lower().startswith('<style'):
+            body = minify_css(body)
+        elif 'src=' not in open_tag.lower():
+            body = minify_js(body)
+        return open_tag + body + close_tag
+
+    # Keep <pre> and <textarea> verbatim, everything else only loses
+    # indentation and blank lines, which never changes how it renders.
+    parts = re.split(r'(<(?:pre|textarea)\b.*?</(?:pre|textarea)>)', src,
+                     flags=re.S | re.I)
+    for idx in range(0, len(parts), 2):
+        part = re.sub(r'(<(?:script|style)\b[^>]*>)(.*?)(</(?:script|style)>)',
+                      inline, parts[idx], flags=re.S | re.I)
+        lines = (line.strip() for line in part.split('\n'))
+        parts[idx] = '\n'.join(line for line in lines if line)
+
+    return ''.join(parts)
+
+
+MINIFIERS = {
+    '.html': minify_html,
+    '.htm': minify_html,
+    '.js': minify_js,
+    '.mjs': minify_js,
+    '.css': minify_css,
+}
+
+
+def c_identifier(rel_path):
+    return re.sub(r'\W', '_', rel_path).lower()
+
+
+def c_array(name, data):
+    lines = [f"static const uint8_t {name}[] = {{"]
+    for off in range(0, len(data), 12):
+        chunk = data[off:off + 12]
+        lines.append("\t" + " ".join(f"0x{b:02x}," for b in chunk))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def url_paths(rel_path):
+    url = "/" + rel_path.replace(os.sep, "/")
+    if os.path.basename(rel_path) == INDEX_FILE:
+        root = os.path.dirname(url)
+        return [root if root.endswith("/") else root + "/", url]
+    return [url]
+
+
+def scan(input_dir):
+    for root, dirs, files in os.walk(input_dir):
+        dirs[:] = sorted(d for d in dirs if not d.startswith('.'))
+        for name in sorted(files):
+            if name.startswith('.'):
+                continue
+            path = os.path.join(root, name)
+            yield path, os.path.relpath(path, input_dir)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('--input', required=True,
+                        help='Static web resource directory')
+    parser.add_argument('--output', required=True,
+                        help='Generated C include file')
+    parser.add_argument('--brotli', action='store_true',
+                        help='Also precompress with Brotli')
+    parser.add_argument('--no-minify', action='store_true',
+                        help='Embed HTML/JS/CSS as written')
+    args = parser.parse_args()
+
+    brotli = None
+    if args.brotli:
+        try:
+            import brotli
+        except ImportError:
+            print("warning: Python 'brotli' module not found, "
+                  "generating gzip only", file=sys.stderr)
+
+    out = ["/* Generated by gen_web_resources.py, do not edit. */", ""]
+
+    for path, rel_path in scan(args.input):
+        ext = os.path.splitext(path)[1].lower()
+        content_type = CONTENT_TYPES.get(ext)
+        if content_type is None:
+            print(f"warning: skipping {rel_path}, unknown content type",
+                  file=sys.stderr)
+            continue
+
+        with open(path, 'rb') as f:
+            data = f.read()
+
+        if not args.no_minify and ext in MINIFIERS:
+            data = MINIFIERS[ext](data.decode('utf-8')).encode('utf-8')
+
+        name = c_identifier(rel_path)
+        file_name = rel_path.replace(os.sep, "/")
+        gz = gzip.compress(data, compresslevel=9, mtime=0)
+        br = brotli.compress(data, quality=11) if brotli else None
+
+        # The variant served to clients without Brotli support
+        if len(gz) < len(data):
+            out.append(c_array(f"{name}_gz", gz))
+            fallback = f'"gzip", {name}_gz'
+            fallback_len = len(gz)
+        else:
+            out.append(c_array(f"{name}_raw", data))
+            fallback = f'NULL, {name}_raw'
+            fallback_len = len(data)
+
+        if br is not None and len(br) < fallback_len:
+            out.append(c_array(f"{name}_br", br))
+            macro = "WEB_ASSET_NEGOTIATED"
+            payload = f'"{content_type}", {fallback}, {name}_br'
+        else:
+            macro = "WEB_ASSET_STATIC"
+            payload = f'"{content_type}", {fallback}'
+
+        for idx, url in enumerate(url_paths(rel_path)):
+            entry = f"{name}_{idx}" if idx else name
+            out.append(f'{macro}({entry}, "{url}", "{file_name}", {payload});')
+        out.append("")
+
+        print(f"web resource {rel_path}: {os.path.getsize(path)} -> "
+              f"{len(data)} minified, {len(gz)} gzip"
+              + (f", {len(br)} brotli" if br is not None else ""))
+
+    tmp = args.output + ".tmp"
+    with open(tmp, 'w') as f:
+        f.write("\n".join(out))
+    os.replace(tmp, args.output)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Measure full versus resumed TLS handshake time against the HTTPS service.
+
+Each round opens a connection without a session (full handshake) and one
+offering the session of the previous connection (abbreviated handshake).
+TLS 1.2 is forced, since that is what the server side session cache resumes.
+Run it against native_sim built with overlay-tls.conf, for example:
+
+    tls_resumption_bench.py 192.0.2.1 --port 443 --rounds 20 --output bench.json
+"""
+
+import argparse
+import json
+import socket
+import ssl
+import statistics
+import sys
+import time
+import urllib.request
+
+
+def handshake(host, port, context, session=None):
+    """Return (handshake seconds, session, reused) for one connection."""
+    with socket.create_connection((host, port), timeout=10) as sock:
+        start = time.perf_counter()
+        with context.wrap_socket(sock, server_hostname=host,
+                                 session=session) as tls:
+            elapsed = time.perf_counter() - start
+            # The session is only complete once the server had a chance to
+            # send its Finished message, a request makes sure of that.
+            tls.sendall(b"HEAD / HTTP/1.1\r\nHost: " + host.encode() +
+                        b"\r\nConnection: close\r\n\r\n")
+            tls.recv(1)
+            return elapsed, tls.session, tls.session_reused
+
+
+def summary(samples):
+    if not samples:
+        return None
+
+    return {
+        "count": len(samples),
+        "min_ms": min(samples) * 1000,
+        "median_ms": statistics.median(samples) * 1000,
+        "mean_ms": statistics.mean(samples) * 1000,
+        "max_ms": max(samples) * 1000,
+    }
+
+
+def server_stats(host, port, context):
+    url = f"https://{host}:{port}/api/tls"
+    try:
+        with urllib.request.urlopen(url, context=context, timeout=10) as rsp:
+            return json.load(rsp)
+    except (OSError, ValueError):
+        return None
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("host", help="Address of the HTTPS service")
+    parser.add_argument("--port", type=int, default=443)
+    parser.add_argument("--rounds", type=int, default=10,
+                        help="Full and resumed handshakes to measure")
+    parser.add_argument("--cafile",
+                        help="Verify the server against this CA certificate")
+    parser.add_argument("--output", help="Write the results as JSON")
+    args = parser.parse_args()
+
+    context = ssl.SSLContext(ssl.PROTOCOL_TLS_CLIENT)
+    context.maximum_version = ssl.TLSVersion.TLSv1_2
+    if args.cafile:
+        context.load_verify_locations(args.cafile)
+    else:
+        context.check_hostname = False
+        context.verify_mode = ssl.CERT_NONE
+
+    full = []
+    resumed = []
+    not_reused = 0
+
+    for _ in range(args.rounds):
+        elapsed, session, _ = handshake(args.host, args.port, context)
+        full.append(elapsed)
+
+        elapsed, _, reused = handshake(args.host, args.port, context, session)
+        if reused:
+            resumed.append(elapsed)
+        else:
+            not_reused += 1
+
+    results = {
+        "full": summary(full),
+        "resumed": summary(resumed),
+        "not_reused": not_reused,
+        "server": server_stats(args.host, args.port, context),
+    }
+
+    if results["full"] and results["resumed"]:
+        results["speedup"] = (results["full"]["median_ms"] /
+                              results["resumed"]["median_ms"])
+
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    print(text)
+
+    if not_reused == args.rounds:
+        print("warning: no session was resumed", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
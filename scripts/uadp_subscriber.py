@@ -0,0 +1,175 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Receive the OPC UA PubSub telemetry published with UADP over multicast.
+
+Decodes the NetworkMessages sent with CONFIG_NET_SAMPLE_OPCUA_PUBSUB and
+prints the fields of every DataSetMessage, or with --stats only the message
+rate and lost sequence numbers once a second. Only the header options and
+the Variant field encoding the sample uses are decoded. For example, on the
+host side of the native_sim TAP interface:
+
+    uadp_subscriber.py --group 239.0.0.1 --interface 192.0.2.2
+"""
+
+import argparse
+import socket
+import struct
+import sys
+import time
+
+FIELD_NAMES = [
+    "bytes_recv", "bytes_sent", "ipv6_recv", "ipv6_sent",
+    "ipv4_recv", "ipv4_sent", "tcp_recv", "tcp_sent",
+    "CAN_1_0", "CAN_1_1", "CAN_1_2", "CAN_1_3",
+    "CAN_2_0", "CAN_2_1", "CAN_2_2", "CAN_2_3",
+]
+
+# Variant built-in types the publisher uses: Boolean and UInt32
+VARIANT_FORMATS = {1: "<?", 7: "<I"}
+
+# 100 ns intervals between 1601-01-01 and the Unix epoch
+DATETIME_EPOCH = 116444736000000000
+
+
+class Reader:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def take(self, fmt):
+        values = struct.unpack_from(fmt, self.data, self.pos)
+        self.pos += struct.calcsize(fmt)
+        return values[0] if len(values) == 1 else values
+
+
+def decode(data):
+    """Return (publisher id, group sequence number, [DataSetMessage dicts])."""
+    r = Reader(data)
+    flags = r.take("<B")
+    if flags & 0x0F != 1:
+        raise ValueError("UADP version %d" % (flags & 0x0F))
+
+    ext_flags1 = r.take("<B") if flags & 0x80 else 0
+    if ext_flags1 & 0x80:
+        r.take("<B")
+    if ext_flags1 & 0x18:
+        raise ValueError("DataSetClassId or security not supported")
+
+    publisher = None
+    if flags & 0x10:
+        publisher = r.take(["<B", "<H", "<I", "<Q"][ext_flags1 & 0x07])
+
+    group_seq = None
+    if flags & 0x20:
+        group_flags = r.take("<B")
+        if group_flags & 0x01:
+            r.take("<H")
+        if group_flags & 0x02:
+            r.take("<I")
+        if group_flags & 0x04:
+            r.take("<H")
+        if group_flags & 0x08:
+            group_seq = r.take("<H")
+
+    writers = [None]
+    if flags & 0x40:
+        count = r.take("<B")
+        writers = [r.take("<H") for _ in range(count)]
+        if count > 1:
+            r.pos += 2 * count
+
+    if ext_flags1 & 0x20:
+        r.take("<q")
+    if ext_flags1 & 0x40:
+        r.take("<H")
+
+    messages = []
+    for writer in writers:
+        ds_flags1 = r.take("<B")
+        ds_flags2 = r.take("<B") if ds_flags1 & 0x80 else 0
+        if ds_flags1 & 0x06 or ds_flags2 & 0x0F:
+            raise ValueError("only Variant key frames are supported")
+
+        msg = {"writer": writer, "valid": bool(ds_flags1 & 0x01)}
+        if ds_flags1 & 0x08:
+            msg["seq"] = r.take("<H")
+        if ds_flags2 & 0x10:
+            msg["time"] = (r.take("<q") - DATETIME_EPOCH) / 1e7
+        if ds_flags2 & 0x20:
+            r.take("<H")
+        if ds_flags1 & 0x10:
+            msg["status"] = r.take("<H")
+        if ds_flags1 & 0x20:
+            r.take("<I")
+        if ds_flags1 & 0x40:
+            r.take("<I")
+
+        fields = []
+        for _ in range(r.take("<H")):
+            fields.append(r.take(VARIANT_FORMATS[r.take("<B")]))
+        msg["fields"] = fields
+        messages.append(msg)
+
+    return publisher, group_seq, messages
+
+
+def open_socket(group, port, interface):
+    sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM, socket.IPPROTO_UDP)
+    sock.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    sock.bind(("", port))
+    mreq = socket.inet_aton(group) + socket.inet_aton(interface)
+    sock.setsockopt(socket.IPPROTO_IP, socket.IP_ADD_MEMBERSHIP, mreq)
+    return sock
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--group", default="239.0.0.1")
+    parser.add_argument("--port", type=int, default=4840)
+    parser.add_argument("--interface", default="0.0.0.0",
+                        help="address of the interface to join the group on")
+    parser.add_argument("--stats", action="store_true",
+                        help="print the message rate and losses instead of values")
+    args = parser.parse_args()
+
+    sock = open_socket(args.group, args.port, args.interface)
+    expected = None
+    received = lost = 0
+    report = time.monotonic() + 1
+
+    while True:
+        data, sender = sock.recvfrom(2048)
+        try:
+            publisher, seq, messages = decode(data)
+        except (ValueError, KeyError, struct.error) as err:
+            print("%s: undecodable message (%s)" % (sender[0], err), file=sys.stderr)
+            continue
+
+        received += 1
+        if seq is not None:
+            if expected is not None and seq != expected:
+                lost += (seq - expected) & 0xFFFF
+            expected = (seq + 1) & 0xFFFF
+
+        if not args.stats:
+            for msg in messages:
+                names = FIELD_NAMES if len(msg["fields"]) == len(FIELD_NAMES) else \
+                    ["field%d" % i for i in range(len(msg["fields"]))]
+                values = " ".join("%s=%s" % (n, int(v)) for n, v in zip(names, msg["fields"]))
+                print("publisher %s seq %s: %s" % (publisher, msg.get("seq"), values))
+        elif time.monotonic() >= report:
+            print("%d messages/s, %d lost" % (received, lost))
+            received = lost = 0
+            report += 1
+
+
+if __name__ == "__main__":
+    try:
+        main()
+    except KeyboardInterrupt:
+        pass
@@ -0,0 +1,421 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Load the WebSocket service with concurrent clients and measure latency.
+
+N config clients connect to the echo resource and send the messages of the
+web UI in a loop, a configuration or a fetch request, timing each until its
+acknowledgement. M subscribers connect to a stats resource and count the
+samples they get. Throughput, p50/p99/p999 latency, refused and dropped
+connections and the device's own counters from /api/netstats are written as
+JSON, so runs against different releases can be compared.
+
+With --launch the native_sim image is started first, built with offloaded
+sockets so the device listens on the host itself:
+
+    west build -b native_sim/native/64 -- -DEXTRA_CONF_FILE=overlay-nsos.conf
+    sudo ws_load_bench.py --launch build/zephyr/zephyr.exe \\
+        --clients 4 --subscribers 2 --duration 30 --output load.json
+
+Needs no packages beyond the standard library.
+"""
+
+import argparse
+import base64
+import json
+import os
+import random
+import select
+import socket
+import struct
+import subprocess
+import sys
+import threading
+import time
+import urllib.request
+
+OPCODE_CONTINUATION = 0x0
+OPCODE_TEXT = 0x1
+OPCODE_BINARY = 0x2
+OPCODE_CLOSE = 0x8
+OPCODE_PING = 0x9
+OPCODE_PONG = 0xA
+
+FETCH = b'{"action":"fetch"}'
+
+
+class WebSocket:
+    """Just enough of RFC 6455 for text and binary messages."""
+
+    def __init__(self, host, port, path, timeout):
+        self.sock = socket.create_connection((host, port), timeout=timeout)
+        self.sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+        key = base64.b64encode(os.urandom(16)).decode()
+        self.sock.sendall(("GET %s HTTP/1.1\r\nHost: %s\r\nUpgrade: websocket\r\n"
+                           "Connection: Upgrade\r\nSec-WebSocket-Key: %s\r\n"
+                           "Sec-WebSocket-Version: 13\r\n\r\n" % (path, host, key)).encode())
+        response = b""
+        while b"\r\n\r\n" not in response:
+            chunk = self.sock.recv(1024)
+            if not chunk:
+                raise ConnectionError("connection closed during the upgrade")
+            response += chunk
+        status, self.pending = response.split(b"\r\n\r\n", 1)
+        if b" 101 " not in status.split(b"\r\n")[0]:
+            raise ConnectionError(status.split(b"\r\n")[0].decode())
+
+    def close(self):
+        try:
+            self.send(OPCODE_CLOSE)
+        except OSError:
+            pass
+        self.sock.close()
+
+    def read(self, n):
+        while len(self.pending) < n:
+            chunk = self.sock.recv(65536)
+            if not chunk:
+                raise ConnectionError("connection closed")
+            self.pending += chunk
+        data, self.pending = self.pending[:n], self.pending[n:]
+        return data
+
+    def send(self, opcode, payload=b""):
+        mask = os.urandom(4)
+        masked = bytes(b ^ mask[i % 4] for i, b in enumerate(payload))
+        if len(payload) < 126:
+            head = struct.pack("!BB", 0x80 | opcode, 0x80 | len(payload))
+        else:
+            head = struct.pack("!BBH", 0x80 | opcode, 0x80 | 126, len(payload))
+        self.sock.sendall(head + mask + masked)
+
+    def message(self):
+        """Return the payload of the next data message, None once closed."""
+        payload = b""
+        while True:
+            head, size = struct.unpack("!BB", self.read(2))
+            size &= 0x7F
+            if size == 126:
+                size = struct.unpack("!H", self.read(2))[0]
+            elif size == 127:
+                size = struct.unpack("!Q", self.read(8))[0]
+            data = self.read(size)
+            opcode = head & 0x0F
+            if opcode == OPCODE_CLOSE:
+                return None
+            if opcode == OPCODE_PING:
+                self.send(OPCODE_PONG, data)
+                continue
+            if opcode in (OPCODE_TEXT, OPCODE_BINARY, OPCODE_CONTINUATION):
+                payload += data
+                if head & 0x80:
+                    return payload
+
+
+def config_message(rng):
+    """A configuration like the web UI sends it, with random values."""
+    message = {
+        "DHCP": rng.choice(["on", "off"]),
+        "IP4Address": "192.0.2.%d" % rng.randint(2, 254),
+        "NetMask": "255.255.255.0",
+    }
+    for bus in (1, 2):
+        for channel in range(4):
+            message["isEnabled_CAN_%d_%d" % (bus, channel)] = rng.randint(0, 1)
+    return json.dumps(message, separators=(",", ":")).encode()
+
+
+class Stats:
+    """Counters shared by the client threads."""
+
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.latency = {"config": [], "fetch": []}
+        self.connected = 0
+        self.refused = 0
+        self.dropped = 0
+        self.timeouts = 0
+        self.samples = 0
+        self.sample_gap = 0.0
+        self.last_sample = None
+
+    def add(self, **counts):
+        with self.lock:
+            for name, value in counts.items():
+                setattr(self, name, getattr(self, name) + value)
+
+
+def connect(args, path, stats):
+    try:
+        ws = WebSocket(args.host, args.port, path, args.timeout)
+    except (OSError, ConnectionError):
+        stats.add(refused=1)
+        return None
+    stats.add(connected=1)
+    return ws
+
+
+def config_client(args, index, stats, stop):
+    rng = random.Random(args.seed + index)
+    ws = None
+
+    while not stop.is_set():
+        if ws is None:
+            ws = connect(args, args.path, stats)
+            if ws is None:
+                stop.wait(args.reconnect)
+                continue
+
+        kind = "fetch" if rng.random() < args.fetch_ratio else "config"
+        payload = FETCH if kind == "fetch" else config_message(rng)
+        try:
+            start = time.perf_counter()
+            ws.send(OPCODE_TEXT, payload)
+            reply = ws.message()
+            elapsed = time.perf_counter() - start
+        except socket.timeout:
+            reply = None
+            stats.add(timeouts=1)
+        except (OSError, ConnectionError):
+            reply = None
+
+        if reply is None:
+            if not stop.is_set():
+                stats.add(dropped=1)
+            ws.sock.close()
+            ws = None
+            continue
+
+        with stats.lock:
+            stats.latency[kind].append(elapsed)
+
+        if args.think:
+            stop.wait(rng.uniform(0, 2 * args.think) / 1000)
+
+    if ws is not None:
+        ws.close()
+
+
+def stats_subscriber(args, stats, stop):
+    ws = None
+
+    while not stop.is_set():
+        if ws is None:
+            ws = connect(args, args.stats_path, stats)
+            if ws is None:
+                stop.wait(args.reconnect)
+                continue
+            previous = time.monotonic()
+
+        # Wait in select(), a timeout inside a message would lose its framing
+        if not ws.pending and not select.select([ws.sock], [], [], 0.5)[0]:
+            continue
+
+        try:
+            payload = ws.message()
+        except (OSError, ConnectionError):
+            payload = None
+
+        if payload is None:
+            if not stop.is_set():
+                stats.add(dropped=1)
+            ws.sock.close()
+            ws = None
+            continue
+
+        now = time.monotonic()
+        with stats.lock:
+            stats.samples += 1
+            stats.sample_gap = max(stats.sample_gap, now - previous)
+            stats.last_sample = payload
+        previous = now
+
+    if ws is not None:
+        ws.close()
+
+
+def percentile(ordered, fraction):
+    """Nearest rank, so p999 of fewer than 1000 samples is the maximum."""
+    index = min(len(ordered) - 1, max(0, int(fraction * len(ordered) + 0.5) - 1))
+    return ordered[index] * 1000
+
+
+def summary(samples, duration):
+    if not samples:
+        return None
+
+    ordered = sorted(samples)
+    return {
+        "count": len(ordered),
+        "per_second": len(ordered) / duration,
+        "min_ms": ordered[0] * 1000,
+        "p50_ms": percentile(ordered, 0.50),
+        "p99_ms": percentile(ordered, 0.99),
+        "p999_ms": percentile(ordered, 0.999),
+        "max_ms": ordered[-1] * 1000,
+    }
+
+
+def device_counters(host, port, timeout):
+    url = "http://%s:%d/api/netstats" % (host, port)
+    try:
+        with urllib.request.urlopen(url, timeout=timeout) as rsp:
+            return json.load(rsp)
+    except (OSError, ValueError):
+        return None
+
+
+def counter_delta(before, after):
+    """Difference of the top level counters, pools are reported as they end."""
+    if before is None or after is None:
+        return None
+    return {key: after[key] - before[key] for key in after
+            if isinstance(after.get(key), int) and isinstance(before.get(key), int)}
+
+
+def launch(args):
+    log = open(args.firmware_log, "w") if args.firmware_log else subprocess.DEVNULL
+    firmware = subprocess.Popen([args.launch], stdout=log, stderr=subprocess.STDOUT)
+    deadline = time.monotonic() + args.startup
+
+    while time.monotonic() < deadline:
+        if firmware.poll() is not None:
+            raise RuntimeError("%s exited with %d" % (args.launch, firmware.returncode))
+        try:
+            socket.create_connection((args.host, args.port), timeout=1).close()
+            return firmware
+        except OSError:
+            time.sleep(0.2)
+
+    firmware.terminate()
+    raise RuntimeError("nothing listens on port %d after %d s" % (args.port, args.startup))
+
+
+def git_describe():
+    try:
+        return subprocess.run(["git", "describe", "--always", "--dirty"],
+                              capture_output=True, text=True, check=True,
+                              cwd=os.path.dirname(os.path.abspath(__file__))).stdout.strip()
+    except (OSError, subprocess.CalledProcessError):
+        return None
+
+
+def run(args):
+    stats = Stats()
+    stop = threading.Event()
+    threads = [threading.Thread(target=config_client, args=(args, i, stats, stop))
+               for i in range(args.clients)]
+    threads += [threading.Thread(target=stats_subscriber, args=(args, stats, stop))
+                for _ in range(args.subscribers)]
+
+    before = device_counters(args.host, args.port, args.timeout)
+    start = time.monotonic()
+    for thread in threads:
+        thread.start()
+    stop.wait(args.duration)
+    stop.set()
+    for thread in threads:
+        thread.join()
+    duration = time.monotonic() - start
+    after = device_counters(args.host, args.port, args.timeout)
+
+    requests = stats.latency["config"] + stats.latency["fetch"]
+    last_sample = None
+    if stats.last_sample is not None:
+        try:
+            last_sample = json.loads(stats.last_sample)
+        except ValueError:
+            pass
+
+    return {
+        "version": args.label or git_describe(),
+        "parameters": {
+            "clients": args.clients,
+            "subscribers": args.subscribers,
+            "duration_s": args.duration,
+            "fetch_ratio": args.fetch_ratio,
+            "think_ms": args.think,
+            "path": args.path,
+            "stats_path": args.stats_path,
+        },
+        "requests": summary(requests, duration),
+        "config": summary(stats.latency["config"], duration),
+        "fetch": summary(stats.latency["fetch"], duration),
+        "connections": {
+            "connected": stats.connected,
+            "refused": stats.refused,
+            "dropped": stats.dropped,
+            "timeouts": stats.timeouts,
+        },
+        "subscriptions": {
+            "samples": stats.samples,
+            "per_second": stats.samples / duration,
+            "max_gap_ms": stats.sample_gap * 1000,
+            "last": last_sample,
+        },
+        "device": {
+            "before": before,
+            "after": after,
+            "delta": counter_delta(before, after),
+        },
+    }
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("host", nargs="?", default="127.0.0.1")
+    parser.add_argument("--port", type=int, default=80)
+    parser.add_argument("--path", default="/ws_echo",
+                        help="WebSocket resource the config clients use")
+    parser.add_argument("--stats-path", default="/threads",
+                        help="WebSocket resource the subscribers use")
+    parser.add_argument("--clients", type=int, default=1, metavar="N")
+    parser.add_argument("--subscribers", type=int, default=0, metavar="M")
+    parser.add_argument("--duration", type=float, default=10, metavar="S")
+    parser.add_argument("--fetch-ratio", type=float, default=0.5,
+                        help="share of fetch requests among the messages")
+    parser.add_argument("--think", type=float, default=0, metavar="MS",
+                        help="mean pause of a client between messages")
+    parser.add_argument("--timeout", type=float, default=5, metavar="S",
+                        help="a reply later than this drops the connection")
+    parser.add_argument("--reconnect", type=float, default=0.5, metavar="S",
+                        help="pause before connecting again after a refusal")
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--launch", metavar="EXE",
+                        help="start this native_sim image and stop it afterwards")
+    parser.add_argument("--startup", type=float, default=30, metavar="S",
+                        help="how long the launched image may take to listen")
+    parser.add_argument("--firmware-log", metavar="FILE",
+                        help="console output of the launched image")
+    parser.add_argument("--label", help="version recorded in the results, "
+                                        "git describe by default")
+    parser.add_argument("--output", help="write the results as JSON")
+    args = parser.parse_args()
+
+    firmware = launch(args) if args.launch else None
+    try:
+        results = run(args)
+    finally:
+        if firmware is not None:
+            firmware.terminate()
+            firmware.wait()
+
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    print(text)
+
+    if results["requests"] is None:
+        print("error: no request was answered", file=sys.stderr)
+        return 1
+
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
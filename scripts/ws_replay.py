@@ -0,0 +1,262 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2025
+#
+# SPDX-License-Identifier: Apache-2.0
+
+"""Download a WebSocket capture from a device and replay it as a perf test.
+
+A device built with CONFIG_NET_SAMPLE_WS_CAPTURE records every message its
+echo handlers receive, with the time and the connection, see
+src/WsCapture.h. "fetch" downloads that capture, "show" lists its sessions
+and "replay" sends them again: every session on its own connection, every
+message at its original offset divided by --speed, 0 sending them back to
+back. The latency of each reply is collected into a histogram:
+
+    ws_replay.py fetch 192.0.2.1 site.wscap
+    ws_replay.py replay site.wscap --launch build/zephyr/zephyr.exe --speed 4 \\
+        --output replay.json
+
+Needs no packages beyond the standard library.
+"""
+
+import argparse
+import bisect
+import json
+import struct
+import sys
+import threading
+import time
+import urllib.request
+
+from ws_load_bench import OPCODE_TEXT, WebSocket, launch, summary
+
+FILE = struct.Struct("<6sHII")
+RECORD = struct.Struct("<QIHBB")
+
+MESSAGE = 0
+OPEN = 1
+CLOSE = 2
+TRUNCATED = 0x01
+
+# Upper bounds of the latency histogram buckets in milliseconds
+BUCKETS_MS = [0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 50, 100, 200, 500, 1000, 2000, 5000]
+
+
+class Session:
+    def __init__(self, connection):
+        self.connection = connection
+        self.opened = None
+        self.closed = None
+        self.messages = []
+        self.truncated = 0
+
+
+def load(path):
+    """Sessions of a capture in the order they were opened, and its header."""
+    with open(path, "rb") as f:
+        data = f.read()
+
+    magic, version, record_size, dropped = FILE.unpack_from(data)
+    if magic != b"WSCAP\0" or version != 1 or record_size != RECORD.size:
+        raise ValueError("%s is not a version 1 capture" % path)
+
+    sessions = {}
+    offset = FILE.size
+    while offset + RECORD.size <= len(data):
+        time_us, connection, length, event, flags = RECORD.unpack_from(data, offset)
+        offset += RECORD.size
+        payload = data[offset:offset + length]
+        offset += length
+
+        # The ring may have overwritten the start of the oldest sessions
+        session = sessions.setdefault(connection, Session(connection))
+        if event == OPEN:
+            session.opened = time_us
+        elif event == CLOSE:
+            session.closed = time_us
+        else:
+            session.messages.append((time_us, payload))
+            session.truncated += bool(flags & TRUNCATED)
+
+    for session in sessions.values():
+        if session.opened is None:
+            session.opened = session.messages[0][0] if session.messages else session.closed
+
+    return sorted(sessions.values(), key=lambda s: s.opened), dropped
+
+
+class Replay:
+    def __init__(self, args, start_us):
+        self.args = args
+        self.start_us = start_us
+        self.lock = threading.Lock()
+        self.latency = []
+        self.late = []
+        self.refused = 0
+        self.dropped = 0
+
+    def wait_until(self, time_us, begin):
+        if self.args.speed > 0:
+            delay = (time_us - self.start_us) / 1e6 / self.args.speed
+            remaining = begin + delay - time.monotonic()
+            if remaining > 0:
+                time.sleep(remaining)
+            return max(0.0, -remaining)
+        return 0.0
+
+    def session(self, session, begin):
+        self.wait_until(session.opened, begin)
+        try:
+            ws = WebSocket(self.args.host, self.args.port, self.args.path, self.args.timeout)
+        except (OSError, ConnectionError):
+            with self.lock:
+                self.refused += 1
+            return
+
+        try:
+            for time_us, payload in session.messages:
+                late = self.wait_until(time_us, begin)
+                start = time.perf_counter()
+                ws.send(OPCODE_TEXT, payload)
+                if ws.message() is None:
+                    raise ConnectionError("closed by the device")
+                elapsed = time.perf_counter() - start
+                with self.lock:
+                    self.latency.append(elapsed)
+                    self.late.append(late)
+            if session.closed is not None:
+                self.wait_until(session.closed, begin)
+        except (OSError, ConnectionError):
+            with self.lock:
+                self.dropped += 1
+        finally:
+            ws.close()
+
+
+def histogram(samples):
+    counts = [0] * (len(BUCKETS_MS) + 1)
+    for sample in samples:
+        counts[bisect.bisect_left(BUCKETS_MS, sample * 1000)] += 1
+    bounds = BUCKETS_MS + [None]
+    return [{"le_ms": bound, "count": count} for bound, count in zip(bounds, counts)]
+
+
+def replay(args):
+    sessions, dropped = load(args.capture)
+    if not sessions:
+        print("error: the capture holds no sessions", file=sys.stderr)
+        return 1
+
+    start_us = sessions[0].opened
+    run = Replay(args, start_us)
+    firmware = launch(args) if args.launch else None
+    try:
+        begin = time.monotonic()
+        threads = [threading.Thread(target=run.session, args=(session, begin))
+                   for session in sessions]
+        for thread in threads:
+            thread.start()
+        for thread in threads:
+            thread.join()
+        duration = time.monotonic() - begin
+    finally:
+        if firmware is not None:
+            firmware.terminate()
+            firmware.wait()
+
+    messages = sum(len(session.messages) for session in sessions)
+    results = {
+        "capture": {
+            "sessions": len(sessions),
+            "messages": messages,
+            "truncated": sum(session.truncated for session in sessions),
+            "overwritten": dropped,
+        },
+        "speed": args.speed,
+        "duration_s": duration,
+        "replied": summary(run.latency, duration),
+        "histogram": histogram(run.latency),
+        "max_late_ms": max(run.late, default=0) * 1000,
+        "refused": run.refused,
+        "dropped": run.dropped,
+    }
+
+    text = json.dumps(results, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(text + "\n")
+    print(text)
+
+    return 0 if len(run.latency) == messages else 1
+
+
+def fetch(args):
+    url = "http://%s:%d%s" % (args.host, args.port, args.resource)
+    with urllib.request.urlopen(url, timeout=args.timeout) as rsp:
+        data = rsp.read()
+    with open(args.capture, "wb") as f:
+        f.write(data)
+    print("%d bytes written to %s" % (len(data), args.capture))
+    if args.clear:
+        request = urllib.request.Request(url, method="DELETE")
+        urllib.request.urlopen(request, timeout=args.timeout).close()
+    return 0
+
+
+def show(args):
+    sessions, dropped = load(args.capture)
+    start_us = sessions[0].opened if sessions else 0
+
+    for session in sessions:
+        end = session.closed if session.closed is not None else (
+            session.messages[-1][0] if session.messages else session.opened)
+        print("#%-5d %10.3f s  %8.3f s  %4d messages%s" %
+              (session.connection, (session.opened - start_us) / 1e6,
+               (end - session.opened) / 1e6, len(session.messages),
+               " (%d truncated)" % session.truncated if session.truncated else ""))
+    if dropped:
+        print("%d older records were overwritten on the device" % dropped)
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    commands = parser.add_subparsers(dest="command", required=True)
+
+    get = commands.add_parser("fetch", help="download the capture of a device")
+    get.add_argument("host")
+    get.add_argument("capture", help="file to write")
+    get.add_argument("--port", type=int, default=80)
+    get.add_argument("--resource", default="/api/capture")
+    get.add_argument("--clear", action="store_true",
+                     help="clear the capture on the device afterwards")
+    get.add_argument("--timeout", type=float, default=10, metavar="S")
+
+    lst = commands.add_parser("show", help="list the sessions of a capture")
+    lst.add_argument("capture")
+
+    run = commands.add_parser("replay", help="send a capture again and time the replies")
+    run.add_argument("capture")
+    run.add_argument("host", nargs="?", default="127.0.0.1")
+    run.add_argument("--port", type=int, default=80)
+    run.add_argument("--path", default="/ws_echo")
+    run.add_argument("--speed", type=float, default=1,
+                     help="2 replays twice as fast, 0 without pauses")
+    run.add_argument("--timeout", type=float, default=5, metavar="S",
+                     help="a reply later than this drops the connection")
+    run.add_argument("--launch", metavar="EXE",
+                     help="start this native_sim image and stop it afterwards")
+    run.add_argument("--startup", type=float, default=30, metavar="S",
+                     help="how long the launched image may take to listen")
+    run.add_argument("--firmware-log", metavar="FILE",
+                     help="console output of the launched image")
+    run.add_argument("--output", help="write the results as JSON")
+
+    args = parser.parse_args()
+    return {"fetch": fetch, "show": show, "replay": replay}[args.command](args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
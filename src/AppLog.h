@@ -0,0 +1,34 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/iterable_sections.h>
+#include <zephyr/sys/util.h>
+
+/** A log module of the application, found by the perf log shell command */
+struct app_log_module {
+    const char *name;
+};
+
+/**
+ * @brief Register a log module of the application
+ *
+ * Like LOG_MODULE_REGISTER() at CONFIG_NET_SAMPLE_LOG_LEVEL, and also lists
+ * the module in the app_log_module section, so runtime tools can tell the
+ * application's log sources from those of the kernel and the stack.
+ *
+ * @param _name Module name, as for LOG_MODULE_REGISTER()
+ */
+#define APP_LOG_MODULE_REGISTER(_name)                                        \
+    static const STRUCT_SECTION_ITERABLE(app_log_module, _name##_app_log) = { \
+        .name = STRINGIFY(_name),                                             \
+    };                                                                        \
+    LOG_MODULE_REGISTER(_name, CONFIG_NET_SAMPLE_LOG_LEVEL)
+
+#endif /* APP_LOG_H */
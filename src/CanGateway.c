@@ -0,0 +1,656 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/can.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/websocket.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#include "CanGateway.h"
+#include "CanTrace.h"
+#include "HTTPWebsocket.h"
+#include "LogLimit.h"
+#include "TagDb.h"
+#include "WsBuffers.h"
+
+APP_LOG_MODULE_REGISTER(can_gateway);
+
+#define STACK_SIZE 2048
+
+#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
+#define THREAD_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
+#else
+#define THREAD_PRIORITY K_PRIO_PREEMPT(8)
+#endif
+
+#define MAX_CLIENTS    CONFIG_NET_SAMPLE_CAN_MAX_CLIENTS
+#define RING_FRAMES    CONFIG_NET_SAMPLE_CAN_RING_FRAMES
+#define FLUSH_INTERVAL CONFIG_NET_SAMPLE_CAN_FLUSH_INTERVAL
+
+BUILD_ASSERT(IS_POWER_OF_TWO(RING_FRAMES), "ring indexes wrap by masking");
+BUILD_ASSERT(sizeof(struct can_gateway_record) == 20, "records are sent as they are");
+BUILD_ASSERT(TAG_CAN_2_3 - TAG_CAN_1_0 + 1 == CAN_GATEWAY_CONTROLLERS * CAN_GATEWAY_CHANNELS);
+
+#define CAN_TAGS GENMASK(TAG_CAN_2_3, TAG_CAN_1_0)
+
+/*
+ * A channel is a quarter of the identifier space: the two most significant
+ * bits of a standard or extended identifier select it.
+ */
+#define STD_CHANNEL_SHIFT 9
+#define EXT_CHANNEL_SHIFT 27
+
+/* CAN 1 is the zephyr,canbus controller unless the induction-can1 alias says otherwise */
+#if DT_NODE_EXISTS(DT_ALIAS(induction_can1))
+#define CAN1_NODE DT_ALIAS(induction_can1)
+#else
+#define CAN1_NODE DT_CHOSEN(zephyr_canbus)
+#endif
+
+static const struct device *const controllers[CAN_GATEWAY_CONTROLLERS] = {
+    DEVICE_DT_GET_OR_NULL(CAN1_NODE),
+    DEVICE_DT_GET_OR_NULL(DT_ALIAS(induction_can2)),
+};
+
+/**
+ * @brief Frames received on one controller
+ *
+ * Single producer, single consumer: only the receive callbacks of the
+ * controller advance @head, only the gateway thread advances @tail. Both
+ * count records without wrapping, the slot is the count modulo RING_FRAMES.
+ */
+struct can_ring {
+    struct can_gateway_record records[RING_FRAMES];
+    atomic_t head;
+    atomic_t tail;
+    /** Frames lost since the last record, owned by the producer */
+    uint32_t dropped;
+};
+
+static struct can_ring rings[CAN_GATEWAY_CONTROLLERS];
+
+/* Standard and extended filter of each channel, negative if not installed */
+static int filters[CAN_GATEWAY_CONTROLLERS][CAN_GATEWAY_CHANNELS][2];
+static bool started[CAN_GATEWAY_CONTROLLERS];
+
+static struct tag_listener can_listener = {
+    .tags = CAN_TAGS,
+};
+
+struct can_client {
+    /** WebSocket, negative when the slot is free */
+    int sock;
+    /** Its receive buffer in can_ws_buffers */
+    int buffer;
+    struct can_trace trace;
+    /** Text message being received */
+    char command[CAN_TRACE_COMMAND_LEN];
+    size_t command_len;
+    bool command_truncated;
+};
+
+static struct can_client clients[MAX_CLIENTS];
+
+struct can_new_client {
+    int sock;
+    int buffer;
+};
+
+/* Upgraded by the HTTP server, picked up at the next flush */
+K_MSGQ_DEFINE(can_new_clients, sizeof(struct can_new_client), MAX_CLIENTS, 4);
+
+static int can_ws_setup(int ws_socket, struct http_request_ctx *request_ctx, void *user_data);
+
+/* The client only sends short commands */
+WS_BUFFER_POOL_DEFINE(can_ws_buffers, can_ws_setup, MAX_CLIENTS, CAN_TRACE_COMMAND_LEN);
+
+static void ring_put(struct can_ring *ring, uint8_t channel, const struct can_frame *frame)
+{
+    atomic_val_t head = atomic_get(&ring->head);
+    size_t free = RING_FRAMES - (size_t)(head - atomic_get(&ring->tail));
+    uint32_t now = (uint32_t)k_ticks_to_us_floor64(k_uptime_ticks());
+    struct can_gateway_record *record;
+    size_t len;
+
+    /* The overflow record goes first, so it takes a slot of its own */
+    if (free < (ring->dropped != 0 ? 2 : 1)) {
+        ring->dropped++;
+        return;
+    }
+
+    if (ring->dropped != 0) {
+        record = &ring->records[head & (RING_FRAMES - 1)];
+        memset(record, 0, sizeof(*record));
+        record->timestamp = sys_cpu_to_le32(now);
+        record->id = sys_cpu_to_le32(ring->dropped);
+        record->channel = channel;
+        record->flags = CAN_GATEWAY_OVERFLOW;
+        ring->dropped = 0;
+        head++;
+    }
+
+    record = &ring->records[head & (RING_FRAMES - 1)];
+    len = can_dlc_to_bytes(frame->dlc);
+
+    record->timestamp = sys_cpu_to_le32(now);
+    record->id = sys_cpu_to_le32(frame->id);
+    record->channel = channel;
+    record->flags = 0;
+    record->count = 1;
+    if (frame->flags & CAN_FRAME_IDE) {
+        record->flags |= CAN_GATEWAY_EXTENDED;
+    }
+    if (frame->flags & CAN_FRAME_RTR) {
+        record->flags |= CAN_GATEWAY_RTR;
+        len = 0;
+    }
+    if (frame->flags & CAN_FRAME_FDF) {
+        record->flags |= CAN_GATEWAY_FD;
+    }
+    if (len > sizeof(record->data)) {
+        record->flags |= CAN_GATEWAY_TRUNCATED;
+        len = sizeof(record->data);
+    }
+    record->len = len;
+    memcpy(record->data, frame->data, len);
+    memset(&record->data[len], 0, sizeof(record->data) - len);
+
+    /* Publishes the record to the consumer */
+    atomic_set(&ring->head, head + 1);
+}
+
+/* Called in the receive context of the driver, usually an ISR */
+static void frame_received(const struct device *dev, struct can_frame *frame, void *user_data)
+{
+    uint8_t channel = (uint8_t)POINTER_TO_UINT(user_data);
+
+    ARG_UNUSED(dev);
+
+    ring_put(&rings[channel / CAN_GATEWAY_CHANNELS], channel, frame);
+}
+
+static int channel_enable(int controller, int channel)
+{
+    const struct device *dev = controllers[controller];
+    uint8_t index = controller * CAN_GATEWAY_CHANNELS + channel;
+    const struct can_filter std = {
+        .id = channel << STD_CHANNEL_SHIFT,
+        .mask = 0x3 << STD_CHANNEL_SHIFT,
+    };
+    const struct can_filter ext = {
+        .id = (uint32_t)channel << EXT_CHANNEL_SHIFT,
+        .mask = 0x3U << EXT_CHANNEL_SHIFT,
+        .flags = CAN_FILTER_IDE,
+    };
+    int *ids = filters[controller][channel];
+
+    ids[0] = can_add_rx_filter(dev, frame_received, UINT_TO_POINTER(index), &std);
+    if (ids[0] < 0) {
+        return ids[0];
+    }
+
+    ids[1] = can_add_rx_filter(dev, frame_received, UINT_TO_POINTER(index), &ext);
+    if (ids[1] < 0) {
+        int ret = ids[1];
+
+        can_remove_rx_filter(dev, ids[0]);
+        ids[0] = -1;
+        return ret;
+    }
+
+    return 0;
+}
+
+static void channel_disable(int controller, int channel)
+{
+    int *ids = filters[controller][channel];
+
+    for (int i = 0; i < 2; i++) {
+        if (ids[i] >= 0) {
+            can_remove_rx_filter(controllers[controller], ids[i]);
+            ids[i] = -1;
+        }
+    }
+}
+
+static void controller_run(int controller, bool run)
+{
+    const struct device *dev = controllers[controller];
+    int ret;
+
+    if (run == started[controller]) {
+        return;
+    }
+
+    ret = run ? can_start(dev) : can_stop(dev);
+    if (ret < 0 && ret != -EALREADY) {
+        LOG_ERR("Failed to %s CAN %d (%d)", run ? "start" : "stop", controller + 1, ret);
+        return;
+    }
+
+    started[controller] = run;
+    LOG_INF("CAN %d %s", controller + 1, run ? "started" : "stopped");
+}
+
+/* Make the filters and controller states follow the isEnabled_CAN_* tags */
+static void channels_apply(uint32_t changed)
+{
+    struct tag_value values[CAN_GATEWAY_CONTROLLERS * CAN_GATEWAY_CHANNELS];
+
+    tag_db_read(TAG_CAN_1_0, ARRAY_SIZE(values), values);
+
+    for (int controller = 0; controller < CAN_GATEWAY_CONTROLLERS; controller++) {
+        bool any = false;
+
+        for (int channel = 0; channel < CAN_GATEWAY_CHANNELS; channel++) {
+            int index = controller * CAN_GATEWAY_CHANNELS + channel;
+            bool enabled = values[index].i32 != 0;
+            int ret;
+
+            any |= enabled;
+
+            if (!(changed & TAG_MASK(TAG_CAN_1_0 + index))) {
+                continue;
+            }
+
+            if (controllers[controller] == NULL || !device_is_ready(controllers[controller])) {
+                if (enabled) {
+                    LOG_WRN("CAN %d has no controller, CAN_%d_%d stays off", controller + 1,
+                            controller + 1, channel);
+                }
+                continue;
+            }
+
+            channel_disable(controller, channel);
+            if (!enabled) {
+                continue;
+            }
+
+            ret = channel_enable(controller, channel);
+            if (ret < 0) {
+                LOG_ERR("Failed to add filters for CAN_%d_%d (%d)", controller + 1, channel, ret);
+            }
+        }
+
+        if (controllers[controller] != NULL && device_is_ready(controllers[controller])) {
+            controller_run(controller, any);
+        }
+    }
+}
+
+static void controllers_init(void)
+{
+    for (int controller = 0; controller < CAN_GATEWAY_CONTROLLERS; controller++) {
+        const struct device *dev = controllers[controller];
+        int ret;
+
+        for (int channel = 0; channel < CAN_GATEWAY_CHANNELS; channel++) {
+            filters[controller][channel][0] = -1;
+            filters[controller][channel][1] = -1;
+        }
+
+        if (dev == NULL) {
+            continue;
+        }
+
+        if (!device_is_ready(dev)) {
+            LOG_ERR("CAN %d controller %s not ready", controller + 1, dev->name);
+            continue;
+        }
+
+        if (IS_ENABLED(CONFIG_NET_SAMPLE_CAN_LOOPBACK)) {
+            ret = can_set_mode(dev, CAN_MODE_LOOPBACK);
+            if (ret < 0) {
+                LOG_WRN("CAN %d does not support loopback mode (%d)", controller + 1, ret);
+            }
+        }
+
+        if (CONFIG_NET_SAMPLE_CAN_BITRATE > 0) {
+            ret = can_set_bitrate(dev, CONFIG_NET_SAMPLE_CAN_BITRATE);
+            if (ret < 0) {
+                LOG_WRN("CAN %d cannot use %d bit/s (%d)", controller + 1,
+                        CONFIG_NET_SAMPLE_CAN_BITRATE, ret);
+            }
+        }
+
+        LOG_INF("CAN %d is %s", controller + 1, dev->name);
+    }
+}
+
+static void client_close(struct can_client *client)
+{
+    (void)websocket_unregister(client->sock);
+    ws_buffer_give(&can_ws_buffers, client->buffer);
+    client->sock = -1;
+}
+
+static void clients_adopt(void)
+{
+    struct can_new_client new_client;
+
+    while (k_msgq_get(&can_new_clients, &new_client, K_NO_WAIT) == 0) {
+        int slot;
+
+        /* The pool accepts no more connections than there are slots, and a
+         * slot is free once its buffer was given back
+         */
+        for (slot = 0; slot < MAX_CLIENTS; slot++) {
+            if (clients[slot].sock < 0) {
+                break;
+            }
+        }
+
+        clients[slot].sock = new_client.sock;
+        clients[slot].buffer = new_client.buffer;
+        clients[slot].command_len = 0;
+        clients[slot].command_truncated = false;
+        can_trace_reset(&clients[slot].trace);
+        LOG_INF("[%d] CAN monitor client connected", slot);
+    }
+}
+
+static void client_command(struct can_client *client, int slot)
+{
+    int ret;
+
+    if (client->command_truncated) {
+        LOG_WRN_LIMITED("[%d] CAN trace command too long", slot);
+        return;
+    }
+
+    ret = can_trace_configure(&client->trace, client->command, client->command_len);
+    if (ret < 0) {
+        LOG_WRN_LIMITED("[%d] Invalid CAN trace command", slot);
+        return;
+    }
+
+    LOG_INF("[%d] Tracing %u filters, channels 0x%02x, %s every %u ms", slot,
+            client->trace.filter_count, client->trace.channels,
+            client->trace.latest ? "latest values" : "all frames", client->trace.requested);
+}
+
+/* Read what the client sent, text messages are trace commands */
+static void client_receive(struct can_client *client, int slot)
+{
+    while (true) {
+        size_t space = sizeof(client->command) - client->command_len;
+        uint64_t remaining;
+        uint32_t type;
+        int ret;
+
+        /* The end of an over-long command is read over itself */
+        if (space == 0) {
+            client->command_len = 0;
+            client->command_truncated = true;
+            space = sizeof(client->command);
+        }
+
+        ret = websocket_recv_msg(client->sock, (uint8_t *)&client->command[client->command_len],
+                                 space, &type, &remaining, 0);
+        if (ret == -EAGAIN) {
+            return;
+        }
+
+        if (ret < 0 || (type & WEBSOCKET_FLAG_CLOSE)) {
+            LOG_INF("[%d] CAN monitor client disconnected", slot);
+            client_close(client);
+            return;
+        }
+
+        client->command_len += ret;
+
+        if (remaining != 0 || !(type & WEBSOCKET_FLAG_FINAL)) {
+            continue;
+        }
+
+        if (type & WEBSOCKET_FLAG_TEXT) {
+            client_command(client, slot);
+        }
+
+        client->command_len = 0;
+        client->command_truncated = false;
+    }
+}
+
+static bool client_writable(struct can_client *client)
+{
+    struct pollfd fd = {
+        .fd = client->sock,
+        .events = POLLOUT,
+    };
+
+    return poll(&fd, 1, 0) == 1 && (fd.revents & POLLOUT);
+}
+
+static void client_send(struct can_client *client, int slot,
+                        const struct can_gateway_record *records, size_t count)
+{
+    int64_t start = k_uptime_get();
+    int ret;
+
+    /* A client that cannot take a batch within an interval is too slow */
+    ret = websocket_send_msg(client->sock, (const uint8_t *)records, count * sizeof(*records),
+                             WEBSOCKET_OPCODE_DATA_BINARY, false, true, FLUSH_INTERVAL);
+    if (ret < 0) {
+        LOG_INF("[%d] Couldn't send CAN frames (%d), closing connection", slot, ret);
+        client_close(client);
+        return;
+    }
+
+    can_trace_sent(&client->trace, k_uptime_get() - start);
+}
+
+/* Records straight from the ring to clients taking everything, the others trace them */
+static void batch_send(const struct can_gateway_record *records, size_t count)
+{
+    for (int slot = 0; slot < MAX_CLIENTS; slot++) {
+        struct can_client *client = &clients[slot];
+
+        if (client->sock < 0) {
+            continue;
+        }
+
+        if (can_trace_passthrough(&client->trace)) {
+            client_send(client, slot, records, count);
+        } else {
+            can_trace_feed(&client->trace, records, count);
+        }
+    }
+}
+
+/* Send everything received since the last flush, at most two batches per ring */
+static void rings_flush(int64_t now)
+{
+    for (int i = 0; i < CAN_GATEWAY_CONTROLLERS; i++) {
+        struct can_ring *ring = &rings[i];
+        atomic_val_t head = atomic_get(&ring->head);
+        atomic_val_t tail = atomic_get(&ring->tail);
+
+        while (tail != head) {
+            size_t slot = tail & (RING_FRAMES - 1);
+            size_t count = MIN((size_t)(head - tail), RING_FRAMES - slot);
+
+            batch_send(&ring->records[slot], count);
+            tail += count;
+            /* Hands the slots back to the producer */
+            atomic_set(&ring->tail, tail);
+        }
+    }
+
+    /* Then what the traces collected, to the clients that are due */
+    for (int slot = 0; slot < MAX_CLIENTS; slot++) {
+        struct can_client *client = &clients[slot];
+        const struct can_gateway_record *records;
+        size_t count;
+
+        if (client->sock < 0) {
+            continue;
+        }
+
+        /* Blocking on a full socket would hold up the other clients */
+        if (!client_writable(client) && can_trace_blocked(&client->trace, now)) {
+            continue;
+        }
+
+        count = can_trace_take(&client->trace, now, &records);
+        if (count != 0) {
+            client_send(client, slot, records, count);
+        }
+    }
+}
+
+#if CONFIG_NET_SAMPLE_CAN_TEST_RATE > 0
+static void test_sent(const struct device *dev, int error, void *user_data)
+{
+    ARG_UNUSED(dev);
+    ARG_UNUSED(error);
+    ARG_UNUSED(user_data);
+}
+
+/* Send the frames due since the last call on every running controller */
+static void test_traffic(int64_t now)
+{
+    static int64_t last;
+    static uint32_t seq;
+    struct can_frame frame = { .dlc = 8 };
+    int64_t due;
+
+    if (last == 0) {
+        last = now;
+    }
+
+    due = (now - last) * CONFIG_NET_SAMPLE_CAN_TEST_RATE / MSEC_PER_SEC;
+    if (due == 0) {
+        return;
+    }
+    last = now;
+
+    for (int64_t i = 0; i < due; i++, seq++) {
+        frame.id = ((seq % CAN_GATEWAY_CHANNELS) << STD_CHANNEL_SHIFT) | (seq & 0x1ff);
+        sys_put_le32(seq, frame.data);
+        sys_put_le32(~seq, &frame.data[4]);
+
+        for (int controller = 0; controller < CAN_GATEWAY_CONTROLLERS; controller++) {
+            if (started[controller]) {
+                (void)can_send(controllers[controller], &frame, K_NO_WAIT, test_sent, NULL);
+            }
+        }
+    }
+}
+#endif
+
+static void can_gateway_thread(void *p1, void *p2, void *p3)
+{
+    struct pollfd fds[MAX_CLIENTS];
+    int64_t next;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i].sock = -1;
+    }
+
+    controllers_init();
+    tag_db_listen(&can_listener);
+    /* Apply the current state in the first pass */
+    atomic_or(&can_listener.changed, CAN_TAGS);
+
+    next = k_uptime_get();
+
+    while (true) {
+        int64_t now = k_uptime_get();
+        int count = 0;
+
+        if (now >= next) {
+            uint32_t changed = tag_db_changes(&can_listener);
+
+            if (changed != 0) {
+                channels_apply(changed);
+            }
+
+#if CONFIG_NET_SAMPLE_CAN_TEST_RATE > 0
+            test_traffic(now);
+#endif
+            rings_flush(now);
+            clients_adopt();
+
+            next += FLUSH_INTERVAL;
+            if (next <= now) {
+                next = now + FLUSH_INTERVAL;
+            }
+        }
+
+        for (int i = 0; i < MAX_CLIENTS; i++) {
+            if (clients[i].sock >= 0) {
+                fds[count].fd = clients[i].sock;
+                fds[count].events = POLLIN;
+                fds[count].revents = 0;
+                count++;
+            }
+        }
+
+        if (count == 0) {
+            k_sleep(K_TIMEOUT_ABS_MS(next));
+            continue;
+        }
+
+        if (poll(fds, count, (int)MAX(next - k_uptime_get(), 0)) <= 0) {
+            continue;
+        }
+
+        for (int i = 0; i < count; i++) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+
+            for (int slot = 0; slot < MAX_CLIENTS; slot++) {
+                if (clients[slot].sock == fds[i].fd) {
+                    client_receive(&clients[slot], slot);
+                    break;
+                }
+            }
+        }
+    }
+}
+
+K_THREAD_DEFINE(can_gateway, STACK_SIZE, can_gateway_thread, NULL, NULL, NULL,
+                THREAD_PRIORITY, 0, 0);
+
+static int can_ws_setup(int ws_socket, struct http_request_ctx *request_ctx, void *user_data)
+{
+    struct can_new_client new_client = {
+        .sock = ws_socket,
+    };
+
+    ARG_UNUSED(request_ctx);
+
+    new_client.buffer = ws_buffer_take(user_data);
+    if (new_client.buffer < 0) {
+        LOG_WRN_LIMITED("Cannot accept more CAN monitor connections");
+        /* The caller closes the connection */
+        return new_client.buffer;
+    }
+
+    /* Holds every connection the pool accepts */
+    (void)k_msgq_put(&can_new_clients, &new_client, K_NO_WAIT);
+
+    return 0;
+}
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(can_ws_resource, CONFIG_NET_SAMPLE_CAN_GATEWAY_PATH,
+                              &can_ws_buffers.detail);
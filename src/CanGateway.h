@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CAN_GATEWAY_H
+#define CAN_GATEWAY_H
+
+#include <stdint.h>
+
+#include <zephyr/toolchain.h>
+
+/* Two controllers with four channels each, isEnabled_CAN_<controller>_<channel> */
+#define CAN_GATEWAY_CONTROLLERS 2
+#define CAN_GATEWAY_CHANNELS    4
+
+/* Record flags */
+#define CAN_GATEWAY_EXTENDED  0x01
+#define CAN_GATEWAY_RTR       0x02
+#define CAN_GATEWAY_FD        0x04
+/* CAN FD payload cut to the first 8 bytes */
+#define CAN_GATEWAY_TRUNCATED 0x08
+/* Not a frame: @id holds the number of frames dropped before this record */
+#define CAN_GATEWAY_OVERFLOW  0x80
+
+/**
+ * @brief A received frame as sent to WebSocket clients
+ *
+ * Each binary message holds a whole number of these records, fields are
+ * little-endian. Records are written to the receive rings in this form,
+ * so batches are sent straight from the ring. A compacted record is the
+ * latest frame of its identifier, @count says how many it replaces.
+ */
+struct can_gateway_record {
+    /** Reception time in microseconds since boot, wraps around */
+    uint32_t timestamp;
+    uint32_t id;
+    /** controller * CAN_GATEWAY_CHANNELS + channel */
+    uint8_t channel;
+    /** Number of valid bytes in @data */
+    uint8_t len;
+    uint8_t flags;
+    /** Frames of this identifier the record stands for, saturating */
+    uint8_t count;
+    uint8_t data[8];
+} __packed;
+
+#endif /* CAN_GATEWAY_H */
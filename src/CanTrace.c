@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/data/json.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "CanTrace.h"
+
+#define FLUSH_INTERVAL CONFIG_NET_SAMPLE_CAN_FLUSH_INTERVAL
+
+/* Slow clients are backed off up to this interval */
+#define MAX_INTERVAL 1000
+
+#define ALL_CHANNELS GENMASK(CAN_GATEWAY_CONTROLLERS * CAN_GATEWAY_CHANNELS - 1, 0)
+
+/* Marks a free slot, channels are numbered from 0 */
+#define SLOT_FREE UINT8_MAX
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CAN_TRACE_IDS), "slots are found by masking the hash");
+BUILD_ASSERT(CAN_TRACE_IDS < CAN_TRACE_FRAMES, "a snapshot is built in the queue");
+BUILD_ASSERT(CAN_GATEWAY_CONTROLLERS * CAN_GATEWAY_CHANNELS <= 8, "channels are a byte mask");
+
+struct filter_json {
+    int32_t id;
+    int32_t mask;
+    bool ext;
+};
+
+struct command_json {
+    struct filter_json filters[CAN_TRACE_FILTERS];
+    size_t filter_count;
+    int32_t channels;
+    bool latest;
+    int32_t interval;
+};
+
+static const struct json_obj_descr filter_descr[] = {
+    JSON_OBJ_DESCR_PRIM(struct filter_json, id, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct filter_json, mask, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct filter_json, ext, JSON_TOK_TRUE),
+};
+
+static const struct json_obj_descr command_descr[] = {
+    JSON_OBJ_DESCR_OBJ_ARRAY(struct command_json, filters, CAN_TRACE_FILTERS, filter_count,
+                             filter_descr, ARRAY_SIZE(filter_descr)),
+    JSON_OBJ_DESCR_PRIM(struct command_json, channels, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(struct command_json, latest, JSON_TOK_TRUE),
+    JSON_OBJ_DESCR_PRIM(struct command_json, interval, JSON_TOK_NUMBER),
+};
+
+/* Forget what was collected, for a new selection of frames */
+static void trace_clear(struct can_trace *trace)
+{
+    trace->queued = 0;
+    trace->overrun = false;
+    trace->untracked = 0;
+
+    for (size_t i = 0; i < CAN_TRACE_IDS; i++) {
+        trace->slots[i].channel = SLOT_FREE;
+    }
+}
+
+void can_trace_reset(struct can_trace *trace)
+{
+    trace->filter_count = 0;
+    trace->channels = ALL_CHANNELS;
+    trace->latest = false;
+    trace->requested = FLUSH_INTERVAL;
+    trace->interval = FLUSH_INTERVAL;
+    trace->next_send = 0;
+    trace->dropped = 0;
+    trace_clear(trace);
+}
+
+int can_trace_configure(struct can_trace *trace, char *command, size_t len)
+{
+    struct command_json parsed = {
+        .channels = trace->channels,
+        .latest = trace->latest,
+        .interval = trace->requested,
+    };
+    int64_t ret;
+
+    ret = json_obj_parse(command, len, command_descr, ARRAY_SIZE(command_descr), &parsed);
+    if (ret < 0) {
+        return -EINVAL;
+    }
+
+    if (parsed.channels < 0 || parsed.channels > ALL_CHANNELS || parsed.interval < 0) {
+        return -EINVAL;
+    }
+
+    if (ret & BIT(0)) {
+        for (size_t i = 0; i < parsed.filter_count; i++) {
+            if (parsed.filters[i].id < 0 || parsed.filters[i].mask < 0) {
+                return -EINVAL;
+            }
+        }
+
+        for (size_t i = 0; i < parsed.filter_count; i++) {
+            trace->filters[i].id = parsed.filters[i].id;
+            trace->filters[i].mask = parsed.filters[i].mask;
+            trace->filters[i].extended = parsed.filters[i].ext;
+        }
+        trace->filter_count = parsed.filter_count;
+    }
+
+    trace->channels = parsed.channels;
+    trace->latest = parsed.latest;
+    trace->requested = CLAMP(parsed.interval, FLUSH_INTERVAL, MAX_INTERVAL);
+    trace->interval = trace->requested;
+    trace_clear(trace);
+
+    return 0;
+}
+
+bool can_trace_passthrough(const struct can_trace *trace)
+{
+    return trace->filter_count == 0 && trace->channels == ALL_CHANNELS && !trace->latest &&
+           trace->interval == FLUSH_INTERVAL;
+}
+
+static bool trace_matches(const struct can_trace *trace, const struct can_gateway_record *record)
+{
+    bool extended = (record->flags & CAN_GATEWAY_EXTENDED) != 0;
+    uint32_t id = sys_le32_to_cpu(record->id);
+
+    if (!(trace->channels & BIT(record->channel))) {
+        return false;
+    }
+
+    if (trace->filter_count == 0) {
+        return true;
+    }
+
+    for (size_t i = 0; i < trace->filter_count; i++) {
+        const struct can_trace_filter *filter = &trace->filters[i];
+
+        if (filter->extended == extended && (id & filter->mask) == (filter->id & filter->mask)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* The slot of the identifier of @record, NULL if all slots are taken */
+static struct can_gateway_record *slot_find(struct can_trace *trace,
+                                            const struct can_gateway_record *record)
+{
+    uint32_t hash = (record->id ^ (record->id >> 11) ^ ((uint32_t)record->channel << 5)) *
+                    0x9e3779b1U;
+
+    for (size_t probe = 0; probe < CAN_TRACE_IDS; probe++) {
+        struct can_gateway_record *slot = &trace->slots[(hash + probe) & (CAN_TRACE_IDS - 1)];
+
+        if (slot->channel == SLOT_FREE) {
+            return slot;
+        }
+
+        if (slot->id == record->id && slot->channel == record->channel &&
+            ((slot->flags ^ record->flags) & CAN_GATEWAY_EXTENDED) == 0) {
+            return slot;
+        }
+    }
+
+    return NULL;
+}
+
+static bool trace_throttled(const struct can_trace *trace)
+{
+    return trace->interval > trace->requested;
+}
+
+void can_trace_feed(struct can_trace *trace, const struct can_gateway_record *records,
+                    size_t count)
+{
+    bool raw = !trace->latest && !trace->overrun && !trace_throttled(trace);
+
+    for (size_t i = 0; i < count; i++) {
+        const struct can_gateway_record *record = &records[i];
+        struct can_gateway_record *slot;
+
+        /* Frames lost by the ring may have been of interest */
+        if (record->flags & CAN_GATEWAY_OVERFLOW) {
+            trace->dropped += sys_le32_to_cpu(record->id);
+            continue;
+        }
+
+        if (!trace_matches(trace, record)) {
+            continue;
+        }
+
+        slot = slot_find(trace, record);
+        if (slot != NULL) {
+            uint8_t frames = slot->channel == SLOT_FREE ? 0 : slot->count;
+
+            *slot = *record;
+            slot->count = MIN(frames + 1, UINT8_MAX);
+        } else {
+            trace->untracked++;
+        }
+
+        if (!raw) {
+            continue;
+        }
+
+        if (trace->queued < CAN_TRACE_FRAMES) {
+            trace->queue[trace->queued++] = *record;
+        } else {
+            /* The backlog is dropped, the client gets a snapshot instead */
+            trace->overrun = true;
+            raw = false;
+        }
+    }
+}
+
+static void overflow_append(struct can_trace *trace, uint32_t frames)
+{
+    struct can_gateway_record *record = &trace->queue[trace->queued++];
+
+    memset(record, 0, sizeof(*record));
+    record->timestamp = sys_cpu_to_le32((uint32_t)k_ticks_to_us_floor64(k_uptime_ticks()));
+    record->id = sys_cpu_to_le32(frames);
+    record->flags = CAN_GATEWAY_OVERFLOW;
+}
+
+size_t can_trace_take(struct can_trace *trace, int64_t now,
+                      const struct can_gateway_record **records)
+{
+    bool snapshot = trace->latest || trace->overrun || trace_throttled(trace);
+    uint32_t lost = trace->dropped;
+
+    if (now < trace->next_send) {
+        return 0;
+    }
+
+    trace->next_send += trace->interval;
+    if (trace->next_send <= now) {
+        trace->next_send = now + trace->interval;
+    }
+
+    if (snapshot) {
+        trace->queued = 0;
+        lost += trace->untracked;
+    }
+
+    /* The slots start over every interval, so identifiers gone quiet give theirs up */
+    for (size_t i = 0; i < CAN_TRACE_IDS; i++) {
+        struct can_gateway_record *slot = &trace->slots[i];
+
+        if (slot->channel == SLOT_FREE) {
+            continue;
+        }
+
+        if (snapshot) {
+            trace->queue[trace->queued++] = *slot;
+        }
+        slot->channel = SLOT_FREE;
+    }
+
+    if (lost != 0 && trace->queued < CAN_TRACE_FRAMES) {
+        overflow_append(trace, lost);
+        trace->dropped = 0;
+    }
+
+    trace->untracked = 0;
+    trace->overrun = false;
+
+    *records = trace->queue;
+    return trace->queued;
+}
+
+static void trace_back_off(struct can_trace *trace)
+{
+    trace->interval = MIN(trace->interval * 2, MAX_INTERVAL);
+}
+
+void can_trace_sent(struct can_trace *trace, int64_t duration)
+{
+    /* Sending only takes long when the socket is full */
+    if (duration > FLUSH_INTERVAL / 2) {
+        trace_back_off(trace);
+    } else if (trace_throttled(trace)) {
+        trace->interval = MAX(trace->interval - MAX(trace->interval / 8, 1), trace->requested);
+    }
+
+    trace->queued = 0;
+}
+
+bool can_trace_blocked(struct can_trace *trace, int64_t now)
+{
+    if (now < trace->next_send) {
+        return false;
+    }
+
+    /* The queue is dropped, the next message is made from the slots */
+    trace_back_off(trace);
+    trace->next_send = now + trace->interval;
+    trace->queued = 0;
+    trace->overrun = true;
+
+    return true;
+}
@@ -0,0 +1,107 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CAN_TRACE_H
+#define CAN_TRACE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "CanGateway.h"
+
+#define CAN_TRACE_FILTERS CONFIG_NET_SAMPLE_CAN_TRACE_FILTERS
+#define CAN_TRACE_FRAMES  CONFIG_NET_SAMPLE_CAN_TRACE_FRAMES
+#define CAN_TRACE_IDS     CONFIG_NET_SAMPLE_CAN_TRACE_IDS
+
+/* Longest command a client may send */
+#define CAN_TRACE_COMMAND_LEN 256
+
+struct can_trace_filter {
+    uint32_t id;
+    uint32_t mask;
+    bool extended;
+};
+
+/**
+ * @brief What one subscriber sees of the received frames
+ *
+ * Frames pass the channel mask and, if there are any, one of the filters.
+ * In raw mode they are queued and sent every @interval milliseconds. In
+ * latest mode, and whenever the queue overflowed or the client fell
+ * behind, only the latest frame of each identifier is sent, with the
+ * number of frames it stands for. All memory is in this structure.
+ */
+struct can_trace {
+    /* Requested by the client */
+    struct can_trace_filter filters[CAN_TRACE_FILTERS];
+    uint8_t filter_count;
+    uint8_t channels;
+    bool latest;
+    uint32_t requested;
+
+    /* Current interval, longer than requested while the client is slow */
+    uint32_t interval;
+    int64_t next_send;
+
+    /* Frames since the last send, in raw mode */
+    struct can_gateway_record queue[CAN_TRACE_FRAMES];
+    size_t queued;
+    bool overrun;
+
+    /* Latest frame per identifier this interval, open addressing by identifier hash */
+    struct can_gateway_record slots[CAN_TRACE_IDS];
+    uint32_t untracked;
+    uint32_t dropped;
+};
+
+/** Raw mode, all channels, no filters, sent every flush */
+void can_trace_reset(struct can_trace *trace);
+
+/**
+ * @brief Apply a command of the client
+ *
+ * A JSON object like {"filters":[{"id":256,"mask":1792,"ext":false}],
+ * "channels":255,"latest":true,"interval":100}. Members left out keep
+ * their value, "filters":[] receives everything.
+ *
+ * @return 0, or -EINVAL if the command is not understood
+ */
+int can_trace_configure(struct can_trace *trace, char *command, size_t len);
+
+/** True if the client takes every record as received */
+bool can_trace_passthrough(const struct can_trace *trace);
+
+/** Account records received on the bus, or overflow records of the ring */
+void can_trace_feed(struct can_trace *trace, const struct can_gateway_record *records,
+                    size_t count);
+
+/**
+ * @brief Take the next message for the client, if one is due
+ *
+ * @return Number of records at @p records, 0 if nothing is to be sent
+ */
+size_t can_trace_take(struct can_trace *trace, int64_t now,
+                      const struct can_gateway_record **records);
+
+/**
+ * @brief Adapt the interval to how long sending a message took
+ *
+ * A client whose socket blocks gets messages less often, and compacted,
+ * until it keeps up again.
+ */
+void can_trace_sent(struct can_trace *trace, int64_t duration);
+
+/**
+ * @brief Skip a message the client has no room for
+ *
+ * What was collected is kept and compacted into a later message.
+ *
+ * @return true if a message was due
+ */
+bool can_trace_blocked(struct can_trace *trace, int64_t now);
+
+#endif /* CAN_TRACE_H */
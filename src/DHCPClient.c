@@ -8,7 +8,8 @@
  */
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_REGISTER(net_dhcpv4_client_sample, LOG_LEVEL_DBG);
+#include "AppLog.h"
+APP_LOG_MODULE_REGISTER(net_dhcpv4_client_sample);
 
 #include <zephyr/kernel.h>
 #include <zephyr/linker/sections.h>
@@ -53,10 +54,9 @@ static void handler(struct net_mgmt_event_callback *cb,
                     uint32_t mgmt_event,
                     struct net_if *iface) {
     int i = 0;
-    printk("DHCPHandler called\n");
 
     if (mgmt_event != NET_EVENT_IPV4_ADDR_ADD) {
-        printk("No IPV4 found\n");
+        LOG_DBG("Event 0x%08x is no IPv4 address", mgmt_event);
         return;
     }
 
@@ -65,23 +65,24 @@ static void handler(struct net_mgmt_event_callback *cb,
 
         //struct net_if_addr *unicast = (net_if_addr*)&iface->config.ip.ipv4->unicast[i];
         if (iface->config.ip.ipv4->unicast[i].ipv4.addr_type != NET_ADDR_DHCP) {
-            printk("Net adress not DHCP\n");
+            LOG_DBG("Address %d not from DHCP", i);
             continue;
         }
 
-        printk("\n    Address[%d]: %s\n", net_if_get_by_iface(iface),
+        /* Deferred logging copies the strings, so buf can be reused */
+        LOG_INF("Address[%d]: %s", net_if_get_by_iface(iface),
                 net_addr_ntop(AF_INET,
                     &iface->config.ip.ipv4->unicast[i].ipv4.address.in_addr,
                     buf, sizeof(buf)));
-        printk("    Subnet[%d]: %s\n", net_if_get_by_iface(iface),
+        LOG_INF("Subnet[%d]: %s", net_if_get_by_iface(iface),
                 net_addr_ntop(AF_INET,
                     &iface->config.ip.ipv4->unicast[i].netmask,
                     buf, sizeof(buf)));
-        printk("    Router[%d]: %s\n", net_if_get_by_iface(iface),
+        LOG_INF("Router[%d]: %s", net_if_get_by_iface(iface),
                 net_addr_ntop(AF_INET,
                     &iface->config.ip.ipv4->gw,
                     buf, sizeof(buf)));
-        printk("Lease time[%d]: %u seconds\n", net_if_get_by_iface(iface),
+        LOG_INF("Lease time[%d]: %u seconds", net_if_get_by_iface(iface),
                 iface->config.dhcpv4.lease_time);
 
         /* Store network information in tcpInfo structure */
@@ -91,7 +92,6 @@ static void handler(struct net_mgmt_event_callback *cb,
         TCPInfoDHCP.tcpInfo.lease_time = iface->config.dhcpv4.lease_time;
         TCPInfoDHCP.isValide = true;
 
-        printk("Scan finished\n");
         net_dhcpv4_stop(iface);
     }
 }
@@ -1,44 +1,317 @@
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
 #include <zephyr/settings/settings.h>
 #include <zephyr/storage/flash_map.h>
-#include <zephyr/fs/nvs.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/fs/zms.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
 #include "Flash.h"
+#include "LogLimit.h"
+#include "TagDb.h"
 
-#define DHCP_CONFIG_ID 1
+APP_LOG_MODULE_REGISTER(flash);
+
+/* Entry 1 held a DHCP_t, whose string pointers are meaningless after a reboot */
+#define INDUCTION_CONFIG_ID 2
 
 #if !DT_NODE_EXISTS(DT_NODELABEL(storage_partition))
 #error "storage_partition node not found in devicetree!"
 #endif
 
-static struct nvs_fs nvs;
+BUILD_ASSERT(sizeof(InductionConfig_t) <= CONFIG_NET_SAMPLE_FLASH_RECORD_SIZE,
+             "NET_SAMPLE_FLASH_RECORD_SIZE too small for the configuration");
+
+enum record_state {
+    RECORD_FREE,
+    RECORD_QUEUED,
+    RECORD_WRITING,
+};
+
+/* A save waiting for the flash queue, later saves of its id replace the data */
+struct record {
+    sys_snode_t node;
+    enum record_state state;
+    uint16_t id;
+    size_t len;
+    sys_slist_t waiters;
+    uint8_t data[CONFIG_NET_SAMPLE_FLASH_RECORD_SIZE];
+};
+
+/* Not NVS, whose sectors cannot hold the 128 KB erase pages of the STM32H7 */
+static struct zms_fs zms;
+
+static struct record records[CONFIG_NET_SAMPLE_FLASH_SAVE_RECORDS];
+static sys_slist_t queued = SYS_SLIST_STATIC_INIT(&queued);
+static struct k_spinlock records_lock;
+
+static K_THREAD_STACK_DEFINE(flash_stack, CONFIG_NET_SAMPLE_FLASH_STACK_SIZE);
+static struct k_work_q flash_queue;
+
+static void save_handler(struct k_work *work);
+
+static K_WORK_DEFINE(save_work, save_handler);
+
+static struct record *queued_record(uint16_t id)
+{
+    struct record *record;
+
+    SYS_SLIST_FOR_EACH_CONTAINER(&queued, record, node) {
+        if (record->id == id) {
+            return record;
+        }
+    }
+
+    return NULL;
+}
+
+static struct record *free_record(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(records); i++) {
+        if (records[i].state == RECORD_FREE) {
+            return &records[i];
+        }
+    }
+
+    return NULL;
+}
 
-int Flash_SaveNVS(const DHCP_t *cfg)
+/* Write the queued records oldest first, erases happen here and nowhere else */
+static void save_handler(struct k_work *work)
 {
-    return nvs_write(&nvs, DHCP_CONFIG_ID, cfg, sizeof(*cfg));
+    struct flash_save *save;
+    struct record *record;
+    sys_snode_t *node;
+    k_spinlock_key_t key;
+    ssize_t rc;
+
+    ARG_UNUSED(work);
+
+    while (true) {
+        key = k_spin_lock(&records_lock);
+        node = sys_slist_get(&queued);
+        if (node == NULL) {
+            k_spin_unlock(&records_lock, key);
+            break;
+        }
+        record = CONTAINER_OF(node, struct record, node);
+        /* Saves arriving from now on queue a new record */
+        record->state = RECORD_WRITING;
+        k_spin_unlock(&records_lock, key);
+
+        rc = zms_write(&zms, record->id, record->data, record->len);
+        if (rc < 0) {
+            LOG_ERR_LIMITED("Write of entry %u failed: %d", record->id, (int)rc);
+        }
+
+        while ((node = sys_slist_get(&record->waiters)) != NULL) {
+            save = CONTAINER_OF(node, struct flash_save, node);
+            save->done(save, rc < 0 ? (int)rc : 0);
+        }
+
+        key = k_spin_lock(&records_lock);
+        record->state = RECORD_FREE;
+        k_spin_unlock(&records_lock, key);
+    }
 }
 
-int Flash_LoadNVS(DHCP_t *cfg)
+int Flash_Save(uint16_t id, const void *data, size_t len, struct flash_save *save)
 {
-    int rc = nvs_read(&nvs, DHCP_CONFIG_ID, cfg, sizeof(*cfg));
-    if (rc == sizeof(*cfg)) {
-        return 0;
+    struct record *record;
+    k_spinlock_key_t key;
+
+    if (len > CONFIG_NET_SAMPLE_FLASH_RECORD_SIZE) {
+        return -EMSGSIZE;
+    }
+
+    key = k_spin_lock(&records_lock);
+
+    record = queued_record(id);
+    if (record == NULL) {
+        record = free_record();
+        if (record == NULL) {
+            k_spin_unlock(&records_lock, key);
+            return -ENOMEM;
+        }
+        record->state = RECORD_QUEUED;
+        record->id = id;
+        sys_slist_init(&record->waiters);
+        sys_slist_append(&queued, &record->node);
+    }
+
+    /* Not written yet, so only the latest data reaches the flash */
+    memcpy(record->data, data, len);
+    record->len = len;
+    if (save != NULL) {
+        sys_slist_append(&record->waiters, &save->node);
     }
-    return -ENOENT;
+
+    k_spin_unlock(&records_lock, key);
+
+    k_work_submit_to_queue(&flash_queue, &save_work);
+
+    return 0;
+}
+
+/* The string storage is saved too, the pointers are rebound on load */
+int Flash_SaveNVS(const InductionConfig_t *config)
+{
+    return Flash_Save(INDUCTION_CONFIG_ID, config, sizeof(*config), NULL);
+}
+
+struct flush {
+    struct flash_save save;
+    struct k_sem written;
+    int result;
+};
+
+static void flush_done(struct flash_save *save, int result)
+{
+    struct flush *flush = CONTAINER_OF(save, struct flush, save);
+
+    flush->result = result;
+    k_sem_give(&flush->written);
+}
+
+int Flash_FlushNVS(void)
+{
+    /* One flush at a time, its save stays queued until written */
+    static K_MUTEX_DEFINE(flush_lock);
+    static struct flush flush = {
+        .save.done = flush_done,
+    };
+    const InductionConfig_t *config;
+    int rc;
+
+    k_mutex_lock(&flush_lock, K_FOREVER);
+    k_sem_init(&flush.written, 0, 1);
+
+    config = InductionConfig_acquire();
+    rc = Flash_Save(INDUCTION_CONFIG_ID, config, sizeof(*config), &flush.save);
+    InductionConfig_release(config);
+
+    if (rc == 0) {
+        k_sem_take(&flush.written, K_FOREVER);
+        rc = flush.result;
+    }
+
+    k_mutex_unlock(&flush_lock);
+
+    return rc;
+}
+
+int Flash_LoadNVS(InductionConfig_t *config)
+{
+    InductionConfig_t stored;
+    ssize_t rc = zms_read(&zms, INDUCTION_CONFIG_ID, &stored, sizeof(stored));
+    if (rc != (ssize_t)sizeof(stored)) {
+        return -ENOENT;
+    }
+
+    /* Never trust the terminators of data read back from flash */
+    stored.dhcp[sizeof(stored.dhcp) - 1] = '\0';
+    stored.ip4_address[sizeof(stored.ip4_address) - 1] = '\0';
+    stored.netmask[sizeof(stored.netmask) - 1] = '\0';
+    InductionConfig_copy(config, &stored);
+    return 0;
 }
 
 int Flash_Init(void)
 {
+    struct flash_pages_info page;
     int rc;
 
     /* Use the *node label* from DTS: storage_partition */
-    nvs.offset       = FIXED_PARTITION_OFFSET(storage_partition);
-    nvs.sector_size  = FIXED_PARTITION_SIZE(storage_partition);
-    nvs.sector_count = 1;   // whole partition as one NVS area
+    zms.flash_device = FIXED_PARTITION_DEVICE(storage_partition);
+    if (!device_is_ready(zms.flash_device)) {
+        LOG_ERR("Storage flash device not ready");
+        return -ENODEV;
+    }
 
-    rc = nvs_mount(&nvs);
+    /* ZMS needs at least two erase pages to move data between */
+    zms.offset = FIXED_PARTITION_OFFSET(storage_partition);
+    rc = flash_get_page_info_by_offs(zms.flash_device, zms.offset, &page);
     if (rc) {
-        printk("NVS mount failed: %d\n", rc);
+        LOG_ERR("Storage page info failed: %d", rc);
+        return rc;
+    }
+    zms.sector_size  = page.size;
+    zms.sector_count = FIXED_PARTITION_SIZE(storage_partition) / page.size;
+    if (zms.sector_count < 2) {
+        LOG_ERR("storage_partition holds %u erase pages of %u bytes, needs two",
+                zms.sector_count, zms.sector_size);
+        return -EINVAL;
+    }
+
+    rc = zms_mount(&zms);
+    if (rc) {
+        LOG_ERR("ZMS mount failed: %d", rc);
         return rc;
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+static void config_save(struct tag_listener *listener, uint32_t tags)
+{
+    const InductionConfig_t *config;
+    int rc;
+
+    ARG_UNUSED(tags);
+
+    (void)tag_db_changes(listener);
+
+    /* Only copied here, the queue writes it once the change is complete */
+    config = InductionConfig_acquire();
+    rc = Flash_SaveNVS(config);
+    InductionConfig_release(config);
+
+    /* Every change triggers a save, so a full queue may log at any rate */
+    if (rc < 0) {
+        LOG_ERR_LIMITED("Configuration not saved: %d", rc);
+    }
+}
+
+static struct tag_listener config_save_listener = {
+    .tags = TAG_MASK_CONFIG,
+    .notify = config_save,
+};
+
+/* Restore the saved configuration over the defaults and save every change */
+static int flash_config_init(void)
+{
+    InductionConfig_t config;
+    int rc;
+
+    rc = Flash_Init();
+    if (rc < 0) {
+        LOG_ERR("Configuration neither restored nor saved, storage unavailable");
+        return rc;
+    }
+
+    if (Flash_LoadNVS(&config) == 0) {
+        InductionConfig_set(&config);
+    }
+
+    tag_db_listen(&config_save_listener);
+
+    return 0;
+}
+
+static int flash_queue_init(void)
+{
+    const struct k_work_queue_config cfg = {
+        .name = "flash",
+    };
+
+    k_work_queue_start(&flash_queue, flash_stack, K_THREAD_STACK_SIZEOF(flash_stack),
+                       CONFIG_NET_SAMPLE_FLASH_PRIORITY, &cfg);
+
+    return 0;
+}
+
+SYS_INIT(flash_queue_init, APPLICATION, 0);
+/* After InductionConfig_init() has set the defaults */
+SYS_INIT(flash_config_init, APPLICATION, 1);
@@ -1,12 +1,38 @@
 #ifndef FLASH_H_
 #define FLASH_H_
 
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/sys/slist.h>
 #include "InductionConfig.h"
 
-int Flash_SaveNVS(const DHCP_t *cfg);
+/* Completion of a queued save, owned by the caller until done() is called */
+struct flash_save
+{
+    sys_snode_t node;
+    /* Called on the flash work queue with 0 or the negative errno of the write */
+    void (*done)(struct flash_save *save, int result);
+};
 
-int Flash_LoadNVS(DHCP_t *cfg);
+/* Queue a write of @data to storage entry @id and return without touching the
+ * flash. Saves of the same id that are still queued are merged, only the
+ * latest data is written and every @save given is completed by that write.
+ * @save may be NULL. Returns 0, -EMSGSIZE or -ENOMEM if too many ids are queued.
+ */
+int Flash_Save(uint16_t id, const void *data, size_t len, struct flash_save *save);
+
+/* Queue a save of the configuration, see Flash_Save() */
+int Flash_SaveNVS(const InductionConfig_t *config);
+
+/* Save the current configuration now, merged with a save still queued, and
+ * wait until it was written. Returns 0 or the negative errno of the write.
+ * Must not be called on the flash work queue.
+ */
+int Flash_FlushNVS(void);
+
+/* Read the saved configuration, returns 0 or -ENOENT if there is none */
+int Flash_LoadNVS(InductionConfig_t *config);
 
 int Flash_Init(void);
 
-#endif // FLASH_H_
\ No newline at end of file
+#endif // FLASH_H_
@@ -18,7 +18,8 @@
 #include <zephyr/net/socket.h>
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_REGISTER(http_server_module, LOG_LEVEL_DBG);
+#include "AppLog.h"
+APP_LOG_MODULE_REGISTER(http_server_module);
 
 /* Include certificates if HTTPS is enabled */
 #if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
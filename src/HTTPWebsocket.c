@@ -8,60 +8,41 @@
 #include "HTTPWebsocket.h"
 #include "DHCPClient.h"
 #include "ws.h"
+#include "WebAssets.h"
+#include "WsBuffers.h"
+#if defined(CONFIG_NET_SAMPLE_WEB_FS)
+#include "WebFS.h"
+#endif
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+#include "certificate.h"
+#endif
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+#include "TLSSessionCache.h"
+#endif
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+#include "cmdline.h"
+#include "soc.h"
+#endif
 
 #include <stdio.h>
 #include <zephyr/net/net_ip.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/dhcpv4.h>
+#include <zephyr/net/tls_credentials.h>
 #include <zephyr/logging/log.h>
+#include "AppLog.h"
 
-LOG_MODULE_REGISTER(httpwebsocket, LOG_LEVEL_DBG);
+APP_LOG_MODULE_REGISTER(httpwebsocket);
 
-// Static web resources
-static uint8_t index_html_gz[] = {
-#include "index.html.gz.inc"
-};
-
-static uint8_t main_js_gz[] = {
-#include "main.js.gz.inc"
-};
+// HTTP resource definitions. Every /ws_echo connection gets a WebSocket
+// receive buffer of its own, handed back by its handler thread. It only
+// has to hold a frame header, the WebSocket layer copies the payload on to
+// the handler's buffer in pieces of this size.
+#define WS_ECHO_FRAME_BUFFER_SIZE 256
 
-static uint8_t WebsocketBuffer[1024];
-
-// HTTP resource definitions
-static struct http_resource_detail_static HTMLResource = {
-    .common = {
-        .type = HTTP_RESOURCE_TYPE_STATIC,
-        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
-        .content_encoding = "gzip",
-        .content_type = "text/html",
-    },
-    .static_data = index_html_gz,
-    .static_data_len = sizeof(index_html_gz),
-};
-
-static struct http_resource_detail_static MainJSResource = {
-    .common = {
-        .type = HTTP_RESOURCE_TYPE_STATIC,
-        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
-        .content_encoding = "gzip",
-        .content_type = "text/javascript",
-    },
-    .static_data = main_js_gz,
-    .static_data_len = sizeof(main_js_gz),
-};
-
-struct http_resource_detail_websocket WSEcho = {
-    .common = {
-        .type = HTTP_RESOURCE_TYPE_WEBSOCKET,
-        // We need HTTP/1.1 Get method for upgrading
-        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
-    },
-    .cb = ws_echo_setup,
-    .data_buffer = WebsocketBuffer,
-    .data_buffer_len = sizeof(WebsocketBuffer),
-    .user_data = NULL, // Fill this for any user specific data
-};
+WS_BUFFER_POOL_DEFINE(ws_echo_buffers, ws_echo_setup,
+                      CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS,
+                      WS_ECHO_FRAME_BUFFER_SIZE);
 
 // HTTP service configuration
 static uint16_t test_http_service_port = CONFIG_NET_SAMPLE_HTTP_SERVER_SERVICE_PORT;
@@ -69,13 +50,138 @@ static uint16_t test_http_service_port = CONFIG_NET_SAMPLE_HTTP_SERVER_SERVICE_P
 HTTP_SERVICE_DEFINE(test_http_service, NULL, &test_http_service_port, 1,
                     10, NULL, NULL);
 
-HTTP_RESOURCE_DEFINE(index_html_gz_resource, test_http_service, "/",
-                     &HTMLResource);
+#if defined(CONFIG_BOARD_NATIVE_SIM)
+// With offloaded sockets all instances on a host share its ports, so each
+// one of a simulated fleet is given its own: zephyr.exe --http-port=8081
+static uint32_t http_port_option;
 
-HTTP_RESOURCE_DEFINE(main_js_gz_resource, test_http_service, "/main.js",
-                     &MainJSResource);
+static void http_port_found(char *argv, int offset)
+{
+    ARG_UNUSED(argv);
+    ARG_UNUSED(offset);
+
+    if (http_port_option == 0 || http_port_option > UINT16_MAX) {
+        printk("Ignoring --http-port=%u\n", http_port_option);
+        return;
+    }
+
+    test_http_service_port = http_port_option;
+}
+
+static void http_port_options(void)
+{
+    static struct args_struct_t options[] = {
+        {
+            .option = "http-port",
+            .name = "port",
+            .type = 'u',
+            .dest = &http_port_option,
+            .call_when_found = http_port_found,
+            .descript = "TCP port of the HTTP service instead of "
+                        STRINGIFY(CONFIG_NET_SAMPLE_HTTP_SERVER_SERVICE_PORT),
+        },
+        ARG_TABLE_ENDMARKER
+    };
+
+    native_add_command_line_opts(options);
+}
+
+NATIVE_TASK(http_port_options, PRE_BOOT_1, 1);
+#endif /* CONFIG_BOARD_NATIVE_SIM */
+
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+static const sec_tag_t sec_tag_list_verify_none[] = {
+    HTTP_SERVER_CERTIFICATE_TAG,
+#if defined(CONFIG_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
+    PSK_TAG,
+#endif
+};
 
-HTTP_RESOURCE_DEFINE(WSEchoResource, test_http_service, "/ws_echo", &WSEcho);
+static uint16_t test_https_service_port = CONFIG_NET_SAMPLE_HTTPS_SERVER_SERVICE_PORT;
+
+HTTPS_SERVICE_DEFINE(test_https_service, NULL, &test_https_service_port, 1,
+                     10, NULL, NULL, sec_tag_list_verify_none,
+                     sizeof(sec_tag_list_verify_none));
+#endif /* CONFIG_NET_SAMPLE_HTTPS_SERVICE */
+
+// Static web resources. The payloads are generated from
+// src/static_web_resources by scripts/gen_web_resources.py and kept const so
+// they are served straight from flash. The resource details stay writable:
+// the server records the matched path length in them on every request.
+#if defined(CONFIG_NET_SAMPLE_WEB_FS)
+// Files on the web partition take precedence, the built-in copy is the
+// fallback.
+#define WEB_ASSET_DYNAMIC(_name, _path, _file, _type, _encoding, _data,        \
+                          _brotli, _brotli_len)                               \
+    static const struct web_asset _name##_asset = {                           \
+        .file = _file,                                                        \
+        .encoding = _encoding,                                                \
+        .data = _data,                                                        \
+        .len = sizeof(_data),                                                 \
+        .brotli = _brotli,                                                    \
+        .brotli_len = _brotli_len,                                            \
+    };                                                                        \
+    static struct web_fs_stream _name##_stream = {                            \
+        .asset = &_name##_asset,                                              \
+    };                                                                        \
+    static struct http_resource_detail_dynamic _name##_detail = {             \
+        .common = {                                                           \
+            .type = HTTP_RESOURCE_TYPE_DYNAMIC,                               \
+            .bitmask_of_supported_http_methods = BIT(HTTP_GET),               \
+            .content_type = _type,                                            \
+        },                                                                    \
+        .cb = web_fs_asset_cb,                                                \
+        .user_data = &_name##_stream,                                         \
+    };                                                                        \
+    HTTPWEBSOCKET_RESOURCE_DEFINE(_name##_resource, _path, &_name##_detail)
+
+#define WEB_ASSET_STATIC(_name, _path, _file, _type, _encoding, _data)         \
+    WEB_ASSET_DYNAMIC(_name, _path, _file, _type, _encoding, _data, NULL, 0)
+
+#define WEB_ASSET_NEGOTIATED(_name, _path, _file, _type, _encoding, _data,     \
+                             _brotli)                                          \
+    WEB_ASSET_DYNAMIC(_name, _path, _file, _type, _encoding, _data, _brotli,   \
+                      sizeof(_brotli))
+#else
+#define WEB_ASSET_STATIC(_name, _path, _file, _type, _encoding, _data)         \
+    static struct http_resource_detail_static _name##_detail = {              \
+        .common = {                                                           \
+            .type = HTTP_RESOURCE_TYPE_STATIC,                                \
+            .bitmask_of_supported_http_methods = BIT(HTTP_GET),               \
+            .content_encoding = _encoding,                                    \
+            .content_type = _type,                                            \
+        },                                                                    \
+        .static_data = _data,                                                 \
+        .static_data_len = sizeof(_data),                                     \
+    };                                                                        \
+    HTTPWEBSOCKET_RESOURCE_DEFINE(_name##_resource, _path, &_name##_detail)
+
+// Assets with a Brotli variant pick their encoding per request
+#define WEB_ASSET_NEGOTIATED(_name, _path, _file, _type, _encoding, _data,     \
+                             _brotli)                                          \
+    static const struct web_asset _name##_asset = {                           \
+        .file = _file,                                                        \
+        .encoding = _encoding,                                                \
+        .data = _data,                                                        \
+        .len = sizeof(_data),                                                 \
+        .brotli = _brotli,                                                    \
+        .brotli_len = sizeof(_brotli),                                        \
+    };                                                                        \
+    static struct http_resource_detail_dynamic _name##_detail = {             \
+        .common = {                                                           \
+            .type = HTTP_RESOURCE_TYPE_DYNAMIC,                               \
+            .bitmask_of_supported_http_methods = BIT(HTTP_GET),               \
+            .content_type = _type,                                            \
+        },                                                                    \
+        .cb = web_asset_cb,                                                   \
+        .user_data = (void *)&_name##_asset,                                  \
+    };                                                                        \
+    HTTPWEBSOCKET_RESOURCE_DEFINE(_name##_resource, _path, &_name##_detail)
+#endif /* CONFIG_NET_SAMPLE_WEB_FS */
+
+#include "web_resources.inc"
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(WSEchoResource, "/ws_echo", &ws_echo_buffers.detail);
 
 // Network interface management
 static struct net_if *Interface = NULL;
@@ -94,7 +200,7 @@ void httpwebsocket_start_dhcp(void)
 
 void httpwebsocket_set_static_ip(void)
 {
-    printk("Use Static IP\n");
+    LOG_INF("Use Static IP");
 
     if (!Interface) {
         LOG_ERR("Network interface not initialized");
@@ -123,9 +229,52 @@ void httpwebsocket_static_ip_mode(void)
     httpwebsocket_set_static_ip();
 }
 
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+static int httpwebsocket_setup_tls(void)
+{
+    int err;
+
+    err = tls_credential_add(HTTP_SERVER_CERTIFICATE_TAG,
+                             TLS_CREDENTIAL_SERVER_CERTIFICATE,
+                             server_certificate, sizeof(server_certificate));
+    if (err < 0) {
+        LOG_ERR("Failed to register public certificate: %d", err);
+        return err;
+    }
+
+    err = tls_credential_add(HTTP_SERVER_CERTIFICATE_TAG,
+                             TLS_CREDENTIAL_PRIVATE_KEY,
+                             private_key, sizeof(private_key));
+    if (err < 0) {
+        LOG_ERR("Failed to register private key: %d", err);
+        return err;
+    }
+
+#if defined(CONFIG_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED)
+    err = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK, psk, sizeof(psk));
+    if (err < 0) {
+        LOG_ERR("Failed to register PSK: %d", err);
+        return err;
+    }
+
+    err = tls_credential_add(PSK_TAG, TLS_CREDENTIAL_PSK_ID, psk_id,
+                             sizeof(psk_id) - 1);
+    if (err < 0) {
+        LOG_ERR("Failed to register PSK ID: %d", err);
+        return err;
+    }
+#endif /* CONFIG_MBEDTLS_KEY_EXCHANGE_PSK_ENABLED */
+
+    return 0;
+}
+#endif /* CONFIG_NET_SAMPLE_HTTPS_SERVICE */
+
 void httpwebsocket_init(void)
 {
     httpwebsocket_interface_init();
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+    (void)httpwebsocket_setup_tls();
+#endif
     LOG_INF("HTTP WebSocket server initialized");
 }
 
@@ -138,6 +287,12 @@ int httpwebsocket_start(void)
     }
 
     LOG_INF("HTTP WebSocket server started on port %d", test_http_service_port);
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+    LOG_INF("HTTPS WebSocket server started on port %d", test_https_service_port);
+#endif
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+    tls_session_cache_enable(&test_https_service);
+#endif
     return 0;
 }
 
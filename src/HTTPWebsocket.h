@@ -13,6 +13,21 @@
 #include <zephyr/net/http/service.h>
 #include <zephyr/net/net_if.h>
 
+/**
+ * @brief Register a resource on every HTTP(S) service of the application
+ *
+ * Resources are always served on test_http_service, and additionally on
+ * test_https_service when CONFIG_NET_SAMPLE_HTTPS_SERVICE is enabled.
+ */
+#if defined(CONFIG_NET_SAMPLE_HTTPS_SERVICE)
+#define HTTPWEBSOCKET_RESOURCE_DEFINE(_name, _path, _detail)                 \
+    HTTP_RESOURCE_DEFINE(_name, test_http_service, _path, _detail);         \
+    HTTP_RESOURCE_DEFINE(_name##_https, test_https_service, _path, _detail)
+#else
+#define HTTPWEBSOCKET_RESOURCE_DEFINE(_name, _path, _detail)                 \
+    HTTP_RESOURCE_DEFINE(_name, test_http_service, _path, _detail)
+#endif
+
 /**
  * @brief Initialize the HTTP/WebSocket server
  *
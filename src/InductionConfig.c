@@ -1,46 +1,615 @@
-
+#include <stdlib.h>
+#include <string.h>
 #include <zephyr/kernel.h>
 #include <zephyr/data/json.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
 #include "InductionConfig.h"
+#include "LogLimit.h"
+#include "TagDb.h"
 
+APP_LOG_MODULE_REGISTER(induction_config);
 
+enum
+{
+  PARSE_OBJECT_START,
+  PARSE_KEY_OR_END,
+  PARSE_KEY_START,
+  PARSE_KEY,
+  PARSE_COLON,
+  PARSE_VALUE,
+  PARSE_STRING,
+  PARSE_SCALAR,
+  PARSE_COMMA_OR_END,
+  PARSE_DONE,
+};
 
-bool InductionConfig_json_parser(char *data, uint32_t size)
+static const struct json_obj_descr DHCPDescriptor[] = {
+    JSON_OBJ_DESCR_PRIM(DHCP_t, DHCP, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, IP4Address, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, NetMask, JSON_TOK_STRING),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_0, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_1, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_2, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_3, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_0, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_1, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_2, JSON_TOK_NUMBER),
+    JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_3, JSON_TOK_NUMBER),
+};
+
+/* Field n of the descriptor is tag TAG_CONFIG_FIRST + n */
+BUILD_ASSERT(ARRAY_SIZE(DHCPDescriptor) == TAG_CONFIG_COUNT);
+
+static InductionConfig_t defaults = {
+    .cfg = {
+        .DHCP = defaults.dhcp,
+        .IP4Address = defaults.ip4_address,
+        .NetMask = defaults.netmask,
+    },
+    .dhcp = "on",
+    .ip4_address = "192.0.2.1",
+    .netmask = "255.255.255.0",
+};
+
+/* Published copies of the configuration tags. Readers hold the current one
+ * while they use it, the writer fills one that is neither current nor held
+ * and publishes it with a single pointer store. While readers hold all the
+ * others the publication is left pending, the last of them to let go
+ * retries it from the system work queue.
+ */
+#define SNAPSHOTS 3
+
+struct snapshot
+{
+  InductionConfig_t config;
+  atomic_t readers;
+};
+
+#define SNAPSHOT_INIT(n)                                                     \
+  {                                                                          \
+    .config = {                                                              \
+      .cfg = {                                                               \
+        .DHCP = snapshots[n].config.dhcp,                                    \
+        .IP4Address = snapshots[n].config.ip4_address,                       \
+        .NetMask = snapshots[n].config.netmask,                              \
+      },                                                                     \
+    },                                                                       \
+  }
+
+static struct snapshot snapshots[SNAPSHOTS] = {
+    SNAPSHOT_INIT(0),
+    SNAPSHOT_INIT(1),
+    SNAPSHOT_INIT(2),
+};
+
+static atomic_ptr_t current = ATOMIC_PTR_INIT(&snapshots[0]);
+
+/* The tags changed since current was filled */
+static atomic_t publish_pending;
+
+static void config_changed(struct tag_listener *listener, uint32_t tags);
+static void publish_retry(struct k_work *work);
+
+static K_WORK_DEFINE(publish_work, publish_retry);
+
+static struct tag_listener config_listener = {
+    .tags = TAG_MASK_CONFIG,
+    .notify = config_changed,
+};
+
+static char *string_buffer(InductionConfig_t *config, size_t offset)
+{
+  switch (offset)
+  {
+  case offsetof(DHCP_t, DHCP):
+    return config->dhcp;
+  case offsetof(DHCP_t, IP4Address):
+    return config->ip4_address;
+  case offsetof(DHCP_t, NetMask):
+    return config->netmask;
+  default:
+    return NULL;
+  }
+}
+
+static void bind_strings(InductionConfig_t *config)
+{
+  config->cfg.DHCP = config->dhcp;
+  config->cfg.IP4Address = config->ip4_address;
+  config->cfg.NetMask = config->netmask;
+}
+
+/* Strings of the fields in @fields fit the tags, bit n is field n */
+static bool wire_valid(const DHCP_t *wire, uint32_t fields)
+{
+  for (size_t i = 0; i < ARRAY_SIZE(DHCPDescriptor); i++)
+  {
+    const char *value;
+
+    if (!(fields & BIT(i)) || DHCPDescriptor[i].type != JSON_TOK_STRING)
+    {
+      continue;
+    }
+
+    value = *(const char *const *)((const uint8_t *)wire + DHCPDescriptor[i].offset);
+    if (value == NULL || strnlen(value, INDUCTION_CONFIG_STR_LEN) >= INDUCTION_CONFIG_STR_LEN)
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+void InductionConfig_copy(InductionConfig_t *dst, const InductionConfig_t *src)
+{
+  memcpy(dst, src, sizeof(*dst));
+  bind_strings(dst);
+}
+
+/* Decode the configuration tags */
+static void config_from_tags(InductionConfig_t *out)
+{
+  struct tag_value values[TAG_CONFIG_COUNT];
+
+  tag_db_read(TAG_CONFIG_FIRST, TAG_CONFIG_COUNT, values);
+
+  for (size_t i = 0; i < ARRAY_SIZE(DHCPDescriptor); i++)
+  {
+    size_t offset = DHCPDescriptor[i].offset;
+
+    if (DHCPDescriptor[i].type == JSON_TOK_STRING)
+    {
+      strcpy(string_buffer(out, offset), values[i].str);
+    }
+    else
+    {
+      *(int32_t *)((uint8_t *)&out->cfg + offset) = values[i].i32;
+    }
+  }
+
+  bind_strings(out);
+}
+
+/* Fill a free snapshot and make it current. Only called with the tag write
+ * lock held, so publishers are serialized.
+ */
+static void publish(void)
+{
+  struct snapshot *old = atomic_ptr_get(&current);
+
+  for (size_t i = 0; i < SNAPSHOTS; i++)
+  {
+    if (&snapshots[i] != old && atomic_get(&snapshots[i].readers) == 0)
+    {
+      atomic_clear(&publish_pending);
+      config_from_tags(&snapshots[i].config);
+      atomic_ptr_set(&current, &snapshots[i]);
+      return;
+    }
+  }
+
+  /* Readers hold all other snapshots, each for one copy. Still pending, so
+   * the last of them to let go of one submits publish_work.
+   */
+}
+
+/* Called by the tag writer, never waits for readers */
+static void config_changed(struct tag_listener *listener, uint32_t tags)
+{
+  ARG_UNUSED(tags);
+
+  /* Dirty bits left set would silence the next notification */
+  (void)tag_db_changes(listener);
+
+  /* Set before the scan, so a release after it sees the flag */
+  atomic_set(&publish_pending, 1);
+  publish();
+}
+
+static void publish_retry(struct k_work *work)
+{
+  ARG_UNUSED(work);
+
+  /* The write lock orders this after any config_changed() in progress */
+  tag_db_write_begin();
+  if (atomic_get(&publish_pending))
+  {
+    publish();
+  }
+  (void)tag_db_write_end();
+}
+
+static void snapshot_put(struct snapshot *snap)
+{
+  /* atomic_dec() returns the count before, so this was the last reader */
+  if (atomic_dec(&snap->readers) == 1 && atomic_get(&publish_pending))
+  {
+    (void)k_work_submit(&publish_work);
+  }
+}
+
+const InductionConfig_t *InductionConfig_acquire(void)
+{
+  struct snapshot *snap;
+
+  while (true)
+  {
+    snap = atomic_ptr_get(&current);
+    atomic_inc(&snap->readers);
+
+    /* Still current, so the writer will not reuse it until released */
+    if (atomic_ptr_get(&current) == snap)
+    {
+      return &snap->config;
+    }
+
+    snapshot_put(snap);
+  }
+}
+
+void InductionConfig_release(const InductionConfig_t *config)
+{
+  snapshot_put(CONTAINER_OF(config, struct snapshot, config));
+}
+
+void InductionConfig_get(InductionConfig_t *out)
+{
+  const InductionConfig_t *config = InductionConfig_acquire();
+
+  InductionConfig_copy(out, config);
+  InductionConfig_release(config);
+}
+
+/* Write the fields in @fields to the tags, bit n is field n. The tag
+ * database copies the strings, so they may point anywhere.
+ */
+static void config_write(const DHCP_t *cfg, uint32_t fields)
+{
+  tag_db_write_begin();
+
+  for (size_t i = 0; i < ARRAY_SIZE(DHCPDescriptor); i++)
+  {
+    size_t offset = DHCPDescriptor[i].offset;
+
+    if (!(fields & BIT(i)))
+    {
+      continue;
+    }
+
+    if (DHCPDescriptor[i].type == JSON_TOK_STRING)
+    {
+      tag_db_set_str(TAG_CONFIG_FIRST + i,
+                     *(const char *const *)((const uint8_t *)cfg + offset));
+    }
+    else
+    {
+      tag_db_set_i32(TAG_CONFIG_FIRST + i,
+                     *(const int32_t *)((const uint8_t *)cfg + offset));
+    }
+  }
+
+  tag_db_write_end();
+}
+
+void InductionConfig_set(const InductionConfig_t *in)
+{
+  config_write(&in->cfg, BIT_MASK(ARRAY_SIZE(DHCPDescriptor)));
+}
+
+static int InductionConfig_init(void)
 {
+  tag_db_listen(&config_listener);
+  InductionConfig_set(&defaults);
+  return 0;
+}
 
+SYS_INIT(InductionConfig_init, APPLICATION, 0);
+
+int InductionConfig_json_encode(const InductionConfig_t *config, char *buf, size_t len)
+{
+  int ret = json_obj_encode_buf(DHCPDescriptor, ARRAY_SIZE(DHCPDescriptor),
+                                &config->cfg, buf, len);
+  if (ret < 0)
+  {
+    return ret;
+  }
+
+  return strlen(buf);
+}
+
+/* Parsed in place: json_obj_parse() terminates the strings inside @data
+ * and points the fields at them, only the tag database copies them. Fields
+ * missing from the message are not written, so they keep their value.
+ */
+bool InductionConfig_json_parser(char *data, uint32_t size)
+{
   DHCP_t dhcp;
-  uint8_t json_msg[] = "{\"DHCP\":\"on\",\"IP4Address\":\"192.0.2.1\",\"NetMask\":\"255.255.255.0\",\"isEnabled_CAN_1_0\":1,\"isEnabled_CAN_1_1\":0,\"isEnabled_CAN_1_2\":0,\"isEnabled_CAN_1_3\":0,\"isEnabled_CAN_2_0\":0,\"isEnabled_CAN_2_1\":0,\"isEnabled_CAN_2_2\":0,\"isEnabled_CAN_2_3\":0}";
-
-  static const struct json_obj_descr DHCPDescriptor[] = {
-      JSON_OBJ_DESCR_PRIM(DHCP_t, DHCP, JSON_TOK_STRING),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, IP4Address, JSON_TOK_STRING),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, NetMask, JSON_TOK_STRING),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_0, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_1, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_2, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_1_3, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_0, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_1, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_2, JSON_TOK_NUMBER),
-      JSON_OBJ_DESCR_PRIM(DHCP_t, isEnabled_CAN_2_3, JSON_TOK_NUMBER),
-  };
 
   int64_t ret = json_obj_parse(data, size, DHCPDescriptor, ARRAY_SIZE(DHCPDescriptor), &dhcp);
   if (ret < 0)
   {
-    printk("JSON Parse Error: %d\n", ret);
+    LOG_WRN_LIMITED("JSON parse error %d", (int)ret);
     return false;
   }
-  else
+
+  if (!wire_valid(&dhcp, (uint32_t)ret))
   {
-    printk("json_obj_parse return code: %d\n", ret);
-    printk("DHCP:                       %s\n", dhcp.DHCP);
-    printk("IP4Address                  %s\n", dhcp.IP4Address);
-    printk("NetMask:                    %s\n", dhcp.NetMask);
-    printk("isEnabled_CAN_1_0           %i\n", dhcp.isEnabled_CAN_1_0);
-    printk("isEnabled_CAN_2_3           %i\n", dhcp.isEnabled_CAN_2_3);
+    LOG_WRN_LIMITED("JSON value too long");
+    return false;
   }
 
-  printk("Exit\n");
+  LOG_DBG("Fields 0x%x", (uint32_t)ret);
+
+  config_write(&dhcp, (uint32_t)ret);
+
   return true;
-}
\ No newline at end of file
+}
+
+void InductionConfigParser_init(InductionConfigParser_t *parser)
+{
+  memset(&parser->config, 0, sizeof(parser->config));
+  bind_strings(&parser->config);
+  parser->fields = 0;
+  parser->state = PARSE_OBJECT_START;
+  parser->field = -1;
+  parser->escape = false;
+  parser->error = 0;
+  parser->len = 0;
+}
+
+static int find_field(const char *key)
+{
+  for (size_t i = 0; i < ARRAY_SIZE(DHCPDescriptor); i++)
+  {
+    if (strcmp(DHCPDescriptor[i].field_name, key) == 0)
+    {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+static int store_string(InductionConfigParser_t *parser)
+{
+  const struct json_obj_descr *descr;
+
+  if (parser->field < 0)
+  {
+    return 0;
+  }
+
+  descr = &DHCPDescriptor[parser->field];
+  if (descr->type != JSON_TOK_STRING)
+  {
+    return -EINVAL;
+  }
+
+  strcpy(string_buffer(&parser->config, descr->offset), parser->token);
+  parser->fields |= BIT(parser->field);
+  return 0;
+}
+
+static int store_scalar(InductionConfigParser_t *parser)
+{
+  const struct json_obj_descr *descr;
+  char *end;
+  long value;
+
+  if (parser->field < 0)
+  {
+    return 0;
+  }
+
+  descr = &DHCPDescriptor[parser->field];
+  if (descr->type != JSON_TOK_NUMBER)
+  {
+    return -EINVAL;
+  }
+
+  if (strcmp(parser->token, "true") == 0)
+  {
+    value = 1;
+  }
+  else if (strcmp(parser->token, "false") == 0)
+  {
+    value = 0;
+  }
+  else
+  {
+    errno = 0;
+    value = strtol(parser->token, &end, 10);
+    if (*end != '\0' || end == parser->token || errno != 0 ||
+        value < INT32_MIN || value > INT32_MAX)
+    {
+      return -EINVAL;
+    }
+  }
+
+  *(int32_t *)((uint8_t *)&parser->config.cfg + descr->offset) = value;
+  parser->fields |= BIT(parser->field);
+  return 0;
+}
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+/* Append to the current token, values of unknown keys are only skipped */
+static int append_token(InductionConfigParser_t *parser, char c)
+{
+  if (parser->field < 0)
+  {
+    return 0;
+  }
+
+  if (parser->len >= sizeof(parser->token) - 1)
+  {
+    return -E2BIG;
+  }
+
+  parser->token[parser->len++] = c;
+  parser->token[parser->len] = '\0';
+  return 0;
+}
+
+static int parser_step(InductionConfigParser_t *parser, char c)
+{
+  int ret;
+
+  switch (parser->state)
+  {
+  case PARSE_OBJECT_START:
+    if (c == '{')
+    {
+      parser->state = PARSE_KEY_OR_END;
+      return 0;
+    }
+    return is_space(c) ? 0 : -EINVAL;
+
+  case PARSE_KEY_OR_END:
+  case PARSE_KEY_START:
+    if (c == '"')
+    {
+      parser->state = PARSE_KEY;
+      parser->len = 0;
+      return 0;
+    }
+    if (c == '}' && parser->state == PARSE_KEY_OR_END)
+    {
+      parser->state = PARSE_DONE;
+      return 0;
+    }
+    return is_space(c) ? 0 : -EINVAL;
+
+  case PARSE_KEY:
+    if (!parser->escape && c == '\\')
+    {
+      parser->escape = true;
+      return 0;
+    }
+    if (!parser->escape && c == '"')
+    {
+      /* Keys too long to be ours never match */
+      parser->key[MIN(parser->len, sizeof(parser->key) - 1)] = '\0';
+      parser->field = parser->len < sizeof(parser->key) ? find_field(parser->key) : -1;
+      parser->state = PARSE_COLON;
+      return 0;
+    }
+    parser->escape = false;
+    if (parser->len < sizeof(parser->key))
+    {
+      parser->key[parser->len++] = c;
+    }
+    return 0;
+
+  case PARSE_COLON:
+    if (c == ':')
+    {
+      parser->state = PARSE_VALUE;
+      return 0;
+    }
+    return is_space(c) ? 0 : -EINVAL;
+
+  case PARSE_VALUE:
+    if (is_space(c))
+    {
+      return 0;
+    }
+    parser->len = 0;
+    parser->token[0] = '\0';
+    if (c == '"')
+    {
+      parser->state = PARSE_STRING;
+      return 0;
+    }
+    if (c == '{' || c == '[')
+    {
+      /* The configuration is a flat object */
+      return -ENOTSUP;
+    }
+    parser->state = PARSE_SCALAR;
+    return append_token(parser, c);
+
+  case PARSE_STRING:
+    if (!parser->escape && c == '\\')
+    {
+      parser->escape = true;
+      return 0;
+    }
+    if (!parser->escape && c == '"')
+    {
+      parser->state = PARSE_COMMA_OR_END;
+      return store_string(parser);
+    }
+    /* None of our values needs a control or \u escape, only the ones
+     * that stand for themselves are decoded
+     */
+    if (parser->escape && c != '"' && c != '\\' && c != '/' && parser->field >= 0)
+    {
+      return -EINVAL;
+    }
+    parser->escape = false;
+    return append_token(parser, c);
+
+  case PARSE_SCALAR:
+    if (!is_space(c) && c != ',' && c != '}')
+    {
+      return append_token(parser, c);
+    }
+    parser->state = PARSE_COMMA_OR_END;
+    ret = store_scalar(parser);
+    if (ret < 0)
+    {
+      return ret;
+    }
+    return parser_step(parser, c);
+
+  case PARSE_COMMA_OR_END:
+    if (c == ',')
+    {
+      parser->state = PARSE_KEY_START;
+      return 0;
+    }
+    if (c == '}')
+    {
+      parser->state = PARSE_DONE;
+      return 0;
+    }
+    return is_space(c) ? 0 : -EINVAL;
+
+  case PARSE_DONE:
+  default:
+    return is_space(c) || c == '\0' ? 0 : -EINVAL;
+  }
+}
+
+int InductionConfigParser_feed(InductionConfigParser_t *parser, const char *data, size_t len)
+{
+  for (size_t i = 0; i < len && parser->error == 0; i++)
+  {
+    parser->error = parser_step(parser, data[i]);
+  }
+
+  return parser->error;
+}
+
+int InductionConfigParser_finish(InductionConfigParser_t *parser)
+{
+  if (parser->error != 0)
+  {
+    return parser->error;
+  }
+
+  return parser->state == PARSE_DONE ? 0 : -EINVAL;
+}
+
+void InductionConfigParser_apply(const InductionConfigParser_t *parser)
+{
+  config_write(&parser->config.cfg, parser->fields);
+}
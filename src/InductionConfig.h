@@ -2,23 +2,92 @@
 #define INDUCTION_CONFIG_H_
 
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Longest string value: "255.255.255.255" plus terminator */
+#define INDUCTION_CONFIG_STR_LEN 16
+
+/* Longest key accepted by the incremental parser */
+#define INDUCTION_CONFIG_KEY_LEN 24
 
 typedef struct
 {
     const char *DHCP;
     const char *IP4Address;
     const char *NetMask;
-    const int *isEnabled_CAN_1_0;
-    const int *isEnabled_CAN_1_1;
-    const int *isEnabled_CAN_1_2;
-    const int *isEnabled_CAN_1_3;
-    const int *isEnabled_CAN_2_0;
-    const int *isEnabled_CAN_2_1;
-    const int *isEnabled_CAN_2_2;
-    const int *isEnabled_CAN_2_3;
+    int32_t isEnabled_CAN_1_0;
+    int32_t isEnabled_CAN_1_1;
+    int32_t isEnabled_CAN_1_2;
+    int32_t isEnabled_CAN_1_3;
+    int32_t isEnabled_CAN_2_0;
+    int32_t isEnabled_CAN_2_1;
+    int32_t isEnabled_CAN_2_2;
+    int32_t isEnabled_CAN_2_3;
 } DHCP_t;
 
+/* A DHCP_t together with the storage its strings point to */
+typedef struct
+{
+    DHCP_t cfg;
+    char dhcp[INDUCTION_CONFIG_STR_LEN];
+    char ip4_address[INDUCTION_CONFIG_STR_LEN];
+    char netmask[INDUCTION_CONFIG_STR_LEN];
+} InductionConfig_t;
+
+/* Incremental parser for a configuration object received in chunks */
+typedef struct
+{
+    /* Only the fields in @fields were parsed, bit n is field n */
+    InductionConfig_t config;
+    uint32_t fields;
+    uint8_t state;
+    int8_t field;
+    bool escape;
+    int error;
+    size_t len;
+    char key[INDUCTION_CONFIG_KEY_LEN];
+    char token[INDUCTION_CONFIG_STR_LEN];
+} InductionConfigParser_t;
+
 bool InductionConfig_json_parser(char *data, uint32_t size);
 
+/* Copy the current configuration, never blocks */
+void InductionConfig_get(InductionConfig_t *out);
+
+/* Hold the current configuration without copying it, never blocks. A later
+ * change publishes a new one, this one stays valid until released.
+ */
+const InductionConfig_t *InductionConfig_acquire(void);
+
+/* Give back a configuration from InductionConfig_acquire() */
+void InductionConfig_release(const InductionConfig_t *config);
+
+/* Replace the current configuration, tag listeners are told which fields
+ * changed. Never waits for readers: while they hold every spare snapshot,
+ * acquire returns the previous one until one of them is released.
+ */
+void InductionConfig_set(const InductionConfig_t *in);
+
+/* Copy a configuration, rebinding the string pointers to @dst's storage */
+void InductionConfig_copy(InductionConfig_t *dst, const InductionConfig_t *src);
+
+/* Encode a configuration as JSON, returns the length or a negative errno */
+int InductionConfig_json_encode(const InductionConfig_t *config, char *buf, size_t len);
+
+/* Start parsing */
+void InductionConfigParser_init(InductionConfigParser_t *parser);
+
+/* Feed the next chunk of input, returns 0 or the first error seen */
+int InductionConfigParser_feed(InductionConfigParser_t *parser, const char *data, size_t len);
+
+/* End of input, returns 0 if a complete object was parsed */
+int InductionConfigParser_finish(InductionConfigParser_t *parser);
+
+/* Write the parsed fields, fields missing from the input keep their current
+ * value even if it changed while the input was parsed
+ */
+void InductionConfigParser_apply(const InductionConfigParser_t *parser);
+
 
-#endif // INDUCITON_CONFIG_H_
\ No newline at end of file
+#endif // INDUCITON_CONFIG_H_
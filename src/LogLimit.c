@@ -0,0 +1,38 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "LogLimit.h"
+
+static struct k_spinlock lock;
+
+bool log_limit_pass(struct log_limit *limit, uint32_t *suppressed)
+{
+    int64_t now = k_uptime_get();
+    k_spinlock_key_t key = k_spin_lock(&lock);
+    bool pass = false;
+
+    *suppressed = 0;
+
+    if (now - limit->window >= CONFIG_NET_SAMPLE_LOG_LIMIT_INTERVAL) {
+        limit->window = now;
+        limit->count = 0;
+    }
+
+    if (limit->count < CONFIG_NET_SAMPLE_LOG_LIMIT_BURST) {
+        limit->count++;
+        *suppressed = limit->suppressed;
+        limit->suppressed = 0;
+        pass = true;
+    } else {
+        limit->suppressed++;
+    }
+
+    k_spin_unlock(&lock, key);
+
+    return pass;
+}
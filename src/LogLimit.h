@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef LOG_LIMIT_H
+#define LOG_LIMIT_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/logging/log.h>
+
+/** State of one rate limited call site */
+struct log_limit {
+    int64_t window;
+    uint32_t count;
+    uint32_t suppressed;
+};
+
+/**
+ * @brief Whether a call site may log now
+ *
+ * At most CONFIG_NET_SAMPLE_LOG_LIMIT_BURST messages pass per
+ * CONFIG_NET_SAMPLE_LOG_LIMIT_INTERVAL milliseconds, the others are counted.
+ *
+ * @param limit State of the call site
+ * @param suppressed Set to the messages dropped since the last one passed
+ *
+ * @return true if the message should be logged
+ */
+bool log_limit_pass(struct log_limit *limit, uint32_t *suppressed);
+
+#define LOG_LIMITED(_log, _fmt, ...)                                          \
+    do {                                                                      \
+        static struct log_limit _limit;                                       \
+        uint32_t _suppressed;                                                 \
+                                                                              \
+        if (log_limit_pass(&_limit, &_suppressed)) {                          \
+            if (_suppressed != 0) {                                           \
+                _log(_fmt " (%u more suppressed)", ##__VA_ARGS__,             \
+                     _suppressed);                                            \
+            } else {                                                          \
+                _log(_fmt, ##__VA_ARGS__);                                    \
+            }                                                                 \
+        }                                                                     \
+    } while (false)
+
+/* Rate limited per call site, for messages a client or the network can
+ * trigger at any rate
+ */
+#define LOG_ERR_LIMITED(...) LOG_LIMITED(LOG_ERR, __VA_ARGS__)
+#define LOG_WRN_LIMITED(...) LOG_LIMITED(LOG_WRN, __VA_ARGS__)
+#define LOG_INF_LIMITED(...) LOG_LIMITED(LOG_INF, __VA_ARGS__)
+#define LOG_DBG_LIMITED(...) LOG_LIMITED(LOG_DBG, __VA_ARGS__)
+
+#endif /* LOG_LIMIT_H */
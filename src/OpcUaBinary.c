@@ -0,0 +1,535 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <time.h>
+
+#include <zephyr/sys/byteorder.h>
+
+#include "OpcUaBinary.h"
+
+/* Seconds between 1601-01-01, the DateTime epoch, and 1970-01-01 */
+#define DATETIME_UNIX_EPOCH 11644473600LL
+#define DATETIME_PER_SEC 10000000LL
+
+/* NodeId encoding bytes */
+#define NODEID_TWO_BYTE   0x00
+#define NODEID_FOUR_BYTE  0x01
+#define NODEID_NUMERIC    0x02
+#define NODEID_STRING     0x03
+#define NODEID_GUID       0x04
+#define NODEID_BYTESTRING 0x05
+#define NODEID_FLAGS      0xC0
+
+void opcua_buf_init(struct opcua_buf *buf, uint8_t *data, size_t len)
+{
+    buf->data = data;
+    buf->len = len;
+    buf->pos = 0;
+    buf->error = false;
+}
+
+/* Returns the next @p len bytes, or NULL and sets the error flag */
+static uint8_t *take(struct opcua_buf *buf, size_t len)
+{
+    uint8_t *ptr;
+
+    if (buf->error || len > buf->len - buf->pos) {
+        buf->error = true;
+        return NULL;
+    }
+
+    ptr = &buf->data[buf->pos];
+    buf->pos += len;
+
+    return ptr;
+}
+
+uint8_t opcua_read_u8(struct opcua_buf *buf)
+{
+    uint8_t *ptr = take(buf, 1);
+
+    return ptr != NULL ? *ptr : 0;
+}
+
+uint16_t opcua_read_u16(struct opcua_buf *buf)
+{
+    uint8_t *ptr = take(buf, 2);
+
+    return ptr != NULL ? sys_get_le16(ptr) : 0;
+}
+
+uint32_t opcua_read_u32(struct opcua_buf *buf)
+{
+    uint8_t *ptr = take(buf, 4);
+
+    return ptr != NULL ? sys_get_le32(ptr) : 0;
+}
+
+int32_t opcua_read_i32(struct opcua_buf *buf)
+{
+    return (int32_t)opcua_read_u32(buf);
+}
+
+int64_t opcua_read_i64(struct opcua_buf *buf)
+{
+    uint8_t *ptr = take(buf, 8);
+
+    return ptr != NULL ? (int64_t)sys_get_le64(ptr) : 0;
+}
+
+double opcua_read_double(struct opcua_buf *buf)
+{
+    uint64_t raw = (uint64_t)opcua_read_i64(buf);
+    double val;
+
+    memcpy(&val, &raw, sizeof(val));
+
+    return val;
+}
+
+void opcua_read_string(struct opcua_buf *buf, struct opcua_string *str)
+{
+    str->len = opcua_read_i32(buf);
+    str->data = NULL;
+
+    if (str->len < -1) {
+        buf->error = true;
+    }
+
+    if (str->len <= 0) {
+        return;
+    }
+
+    str->data = take(buf, str->len);
+    if (str->data == NULL) {
+        str->len = -1;
+    }
+}
+
+void opcua_read_nodeid(struct opcua_buf *buf, struct opcua_nodeid *id)
+{
+    uint8_t encoding = opcua_read_u8(buf);
+    uint8_t *guid;
+
+    memset(id, 0, sizeof(*id));
+
+    switch (encoding & ~NODEID_FLAGS) {
+    case NODEID_TWO_BYTE:
+        id->numeric = opcua_read_u8(buf);
+        break;
+    case NODEID_FOUR_BYTE:
+        id->ns = opcua_read_u8(buf);
+        id->numeric = opcua_read_u16(buf);
+        break;
+    case NODEID_NUMERIC:
+        id->ns = opcua_read_u16(buf);
+        id->numeric = opcua_read_u32(buf);
+        break;
+    case NODEID_STRING:
+        id->ns = opcua_read_u16(buf);
+        id->type = OPCUA_NODEID_STRING;
+        opcua_read_string(buf, &id->string);
+        break;
+    case NODEID_GUID:
+        id->ns = opcua_read_u16(buf);
+        id->type = OPCUA_NODEID_GUID;
+        guid = take(buf, sizeof(id->guid));
+        if (guid != NULL) {
+            memcpy(id->guid, guid, sizeof(id->guid));
+        }
+        break;
+    case NODEID_BYTESTRING:
+        id->ns = opcua_read_u16(buf);
+        id->type = OPCUA_NODEID_BYTESTRING;
+        opcua_read_string(buf, &id->string);
+        break;
+    default:
+        buf->error = true;
+        break;
+    }
+
+    /* ExpandedNodeId: namespace URI and server index are not used */
+    if (encoding & 0x80) {
+        opcua_skip_string(buf);
+    }
+    if (encoding & 0x40) {
+        opcua_skip(buf, 4);
+    }
+}
+
+void opcua_skip(struct opcua_buf *buf, size_t len)
+{
+    (void)take(buf, len);
+}
+
+void opcua_skip_string(struct opcua_buf *buf)
+{
+    struct opcua_string str;
+
+    opcua_read_string(buf, &str);
+}
+
+int32_t opcua_read_array_len(struct opcua_buf *buf)
+{
+    int32_t len = opcua_read_i32(buf);
+
+    if (len < -1 || (len > 0 && (size_t)len > buf->len - buf->pos)) {
+        /* Every element takes at least one byte */
+        buf->error = true;
+        return 0;
+    }
+
+    return len < 0 ? 0 : len;
+}
+
+void opcua_skip_string_array(struct opcua_buf *buf)
+{
+    int32_t count = opcua_read_array_len(buf);
+
+    for (int32_t i = 0; i < count && !buf->error; i++) {
+        opcua_skip_string(buf);
+    }
+}
+
+void opcua_skip_localized_text(struct opcua_buf *buf)
+{
+    uint8_t mask = opcua_read_u8(buf);
+
+    if (mask & 0x01) {
+        opcua_skip_string(buf);
+    }
+    if (mask & 0x02) {
+        opcua_skip_string(buf);
+    }
+}
+
+void opcua_skip_qualified_name(struct opcua_buf *buf)
+{
+    opcua_skip(buf, 2);
+    opcua_skip_string(buf);
+}
+
+void opcua_skip_extension_object(struct opcua_buf *buf)
+{
+    struct opcua_nodeid type_id;
+    uint8_t encoding;
+
+    opcua_read_nodeid(buf, &type_id);
+    encoding = opcua_read_u8(buf);
+    if (encoding != 0) {
+        opcua_skip_string(buf);
+    }
+}
+
+void opcua_skip_application_description(struct opcua_buf *buf)
+{
+    opcua_skip_string(buf); /* ApplicationUri */
+    opcua_skip_string(buf); /* ProductUri */
+    opcua_skip_localized_text(buf);
+    opcua_skip(buf, 4); /* ApplicationType */
+    opcua_skip_string(buf); /* GatewayServerUri */
+    opcua_skip_string(buf); /* DiscoveryProfileUri */
+    opcua_skip_string_array(buf);
+}
+
+void opcua_read_request_header(struct opcua_buf *buf, struct opcua_request_header *hdr)
+{
+    opcua_read_nodeid(buf, &hdr->auth_token);
+    opcua_skip(buf, 8); /* Timestamp */
+    hdr->handle = opcua_read_u32(buf);
+    opcua_skip(buf, 4); /* ReturnDiagnostics */
+    opcua_skip_string(buf); /* AuditEntryId */
+    hdr->timeout_hint = opcua_read_u32(buf);
+    opcua_skip_extension_object(buf); /* AdditionalHeader */
+}
+
+void opcua_write_u8(struct opcua_buf *buf, uint8_t val)
+{
+    uint8_t *ptr = take(buf, 1);
+
+    if (ptr != NULL) {
+        *ptr = val;
+    }
+}
+
+void opcua_write_u16(struct opcua_buf *buf, uint16_t val)
+{
+    uint8_t *ptr = take(buf, 2);
+
+    if (ptr != NULL) {
+        sys_put_le16(val, ptr);
+    }
+}
+
+void opcua_write_u32(struct opcua_buf *buf, uint32_t val)
+{
+    uint8_t *ptr = take(buf, 4);
+
+    if (ptr != NULL) {
+        sys_put_le32(val, ptr);
+    }
+}
+
+void opcua_write_i32(struct opcua_buf *buf, int32_t val)
+{
+    opcua_write_u32(buf, (uint32_t)val);
+}
+
+void opcua_write_i64(struct opcua_buf *buf, int64_t val)
+{
+    uint8_t *ptr = take(buf, 8);
+
+    if (ptr != NULL) {
+        sys_put_le64((uint64_t)val, ptr);
+    }
+}
+
+void opcua_write_double(struct opcua_buf *buf, double val)
+{
+    uint64_t raw;
+
+    memcpy(&raw, &val, sizeof(raw));
+    opcua_write_i64(buf, (int64_t)raw);
+}
+
+void opcua_write_raw(struct opcua_buf *buf, const void *data, size_t len)
+{
+    uint8_t *ptr = take(buf, len);
+
+    if (ptr != NULL && len > 0) {
+        memcpy(ptr, data, len);
+    }
+}
+
+void opcua_write_bytestring(struct opcua_buf *buf, const void *data, int32_t len)
+{
+    if (data == NULL) {
+        opcua_write_i32(buf, -1);
+        return;
+    }
+
+    opcua_write_i32(buf, len);
+    opcua_write_raw(buf, data, len);
+}
+
+void opcua_write_string(struct opcua_buf *buf, const char *str)
+{
+    opcua_write_bytestring(buf, str, str != NULL ? strlen(str) : 0);
+}
+
+void opcua_write_numeric_nodeid(struct opcua_buf *buf, uint16_t ns, uint32_t id)
+{
+    if (ns == 0 && id <= UINT8_MAX) {
+        opcua_write_u8(buf, NODEID_TWO_BYTE);
+        opcua_write_u8(buf, id);
+    } else if (ns <= UINT8_MAX && id <= UINT16_MAX) {
+        opcua_write_u8(buf, NODEID_FOUR_BYTE);
+        opcua_write_u8(buf, ns);
+        opcua_write_u16(buf, id);
+    } else {
+        opcua_write_u8(buf, NODEID_NUMERIC);
+        opcua_write_u16(buf, ns);
+        opcua_write_u32(buf, id);
+    }
+}
+
+void opcua_write_nodeid(struct opcua_buf *buf, const struct opcua_nodeid *id)
+{
+    switch (id->type) {
+    case OPCUA_NODEID_NUMERIC:
+        opcua_write_numeric_nodeid(buf, id->ns, id->numeric);
+        break;
+    case OPCUA_NODEID_GUID:
+        opcua_write_u8(buf, NODEID_GUID);
+        opcua_write_u16(buf, id->ns);
+        opcua_write_raw(buf, id->guid, sizeof(id->guid));
+        break;
+    default:
+        opcua_write_u8(buf, id->type == OPCUA_NODEID_STRING ? NODEID_STRING
+                                                           : NODEID_BYTESTRING);
+        opcua_write_u16(buf, id->ns);
+        opcua_write_bytestring(buf, id->string.data, id->string.len);
+        break;
+    }
+}
+
+void opcua_write_qualified_name(struct opcua_buf *buf, uint16_t ns, const char *name)
+{
+    opcua_write_u16(buf, ns);
+    opcua_write_string(buf, name);
+}
+
+void opcua_write_localized_text(struct opcua_buf *buf, const char *text)
+{
+    if (text == NULL) {
+        opcua_write_u8(buf, 0);
+        return;
+    }
+
+    opcua_write_u8(buf, 0x02);
+    opcua_write_string(buf, text);
+}
+
+static void write_variant_value(struct opcua_buf *buf, const struct opcua_variant *val)
+{
+    size_t len_pos;
+
+    switch (val->type) {
+    case OPCUA_TYPE_BOOLEAN:
+        opcua_write_u8(buf, val->boolean ? 1 : 0);
+        break;
+    case OPCUA_TYPE_BYTE:
+        opcua_write_u8(buf, val->byte);
+        break;
+    case OPCUA_TYPE_INT32:
+        opcua_write_i32(buf, val->int32);
+        break;
+    case OPCUA_TYPE_UINT32:
+    case OPCUA_TYPE_STATUS_CODE:
+        opcua_write_u32(buf, val->uint32);
+        break;
+    case OPCUA_TYPE_DOUBLE:
+        opcua_write_double(buf, val->dbl);
+        break;
+    case OPCUA_TYPE_STRING:
+        opcua_write_string(buf, val->string);
+        break;
+    case OPCUA_TYPE_DATETIME:
+        opcua_write_i64(buf, val->datetime);
+        break;
+    case OPCUA_TYPE_NODEID:
+        opcua_write_nodeid(buf, &val->nodeid);
+        break;
+    case OPCUA_TYPE_QUALIFIED_NAME:
+        opcua_write_qualified_name(buf, val->name.ns, val->name.text);
+        break;
+    case OPCUA_TYPE_LOCALIZED_TEXT:
+        opcua_write_localized_text(buf, val->name.text);
+        break;
+    case OPCUA_TYPE_EXTENSION_OBJECT:
+        opcua_write_numeric_nodeid(buf, 0, val->object.type_id);
+        opcua_write_u8(buf, 0x01);
+        len_pos = buf->pos;
+        opcua_write_i32(buf, 0);
+        val->object.encode(buf, val->object.arg);
+        if (!buf->error) {
+            opcua_patch_u32(buf, len_pos, buf->pos - len_pos - 4);
+        }
+        break;
+    default:
+        buf->error = true;
+        break;
+    }
+}
+
+void opcua_write_variant(struct opcua_buf *buf, const struct opcua_variant *val)
+{
+    if (val->type == OPCUA_TYPE_NULL) {
+        opcua_write_u8(buf, 0);
+        return;
+    }
+
+    if (!val->array) {
+        opcua_write_u8(buf, val->type);
+        write_variant_value(buf, val);
+        return;
+    }
+
+    /* Only arrays of strings and of empty dimensions are produced */
+    opcua_write_u8(buf, val->type | 0x80);
+    opcua_write_i32(buf, val->count);
+    for (uint16_t i = 0; i < val->count; i++) {
+        if (val->type == OPCUA_TYPE_STRING) {
+            opcua_write_string(buf, val->strings[i]);
+        } else {
+            opcua_write_u32(buf, 0);
+        }
+    }
+}
+
+void opcua_write_data_value(struct opcua_buf *buf, uint32_t status,
+                            const struct opcua_variant *val, uint32_t timestamps,
+                            bool source, int64_t time)
+{
+    uint8_t mask = status == OPCUA_GOOD ? 0x01 : 0x02;
+
+    if (source && (timestamps == OPCUA_TIMESTAMPS_SOURCE ||
+                   timestamps == OPCUA_TIMESTAMPS_BOTH)) {
+        mask |= 0x04;
+    }
+    if (timestamps == OPCUA_TIMESTAMPS_SERVER || timestamps == OPCUA_TIMESTAMPS_BOTH) {
+        mask |= 0x08;
+    }
+
+    opcua_write_u8(buf, mask);
+    if (mask & 0x01) {
+        opcua_write_variant(buf, val);
+    } else {
+        opcua_write_u32(buf, status);
+    }
+    if (mask & 0x04) {
+        opcua_write_i64(buf, time);
+    }
+    if (mask & 0x08) {
+        opcua_write_i64(buf, time);
+    }
+}
+
+void opcua_write_response_header(struct opcua_buf *buf, uint32_t handle, uint32_t status)
+{
+    opcua_write_i64(buf, opcua_datetime_now());
+    opcua_write_u32(buf, handle);
+    opcua_write_u32(buf, status);
+    opcua_write_u8(buf, 0);                  /* ServiceDiagnostics */
+    opcua_write_i32(buf, -1);                /* StringTable */
+    opcua_write_numeric_nodeid(buf, 0, 0);   /* AdditionalHeader */
+    opcua_write_u8(buf, 0);
+}
+
+void opcua_patch_u32(struct opcua_buf *buf, size_t pos, uint32_t val)
+{
+    if (pos + 4 <= buf->len) {
+        sys_put_le32(val, &buf->data[pos]);
+    }
+}
+
+bool opcua_nodeid_equal(const struct opcua_nodeid *a, const struct opcua_nodeid *b)
+{
+    if (a->ns != b->ns || a->type != b->type) {
+        return false;
+    }
+
+    switch (a->type) {
+    case OPCUA_NODEID_NUMERIC:
+        return a->numeric == b->numeric;
+    case OPCUA_NODEID_GUID:
+        return memcmp(a->guid, b->guid, sizeof(a->guid)) == 0;
+    default:
+        return a->string.len == b->string.len &&
+               (a->string.len <= 0 ||
+                memcmp(a->string.data, b->string.data, a->string.len) == 0);
+    }
+}
+
+bool opcua_string_equal(const struct opcua_string *str, const char *cstr)
+{
+    size_t len = strlen(cstr);
+
+    return str->len >= 0 && (size_t)str->len == len && memcmp(str->data, cstr, len) == 0;
+}
+
+int64_t opcua_datetime_now(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_REALTIME, &ts) < 0) {
+        return 0;
+    }
+
+    return ((int64_t)ts.tv_sec + DATETIME_UNIX_EPOCH) * DATETIME_PER_SEC +
+           ts.tv_nsec / 100;
+}
@@ -0,0 +1,256 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OPCUA_BINARY_H
+#define OPCUA_BINARY_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/* Status codes */
+#define OPCUA_GOOD                           0x00000000U
+#define OPCUA_BAD_UNEXPECTED_ERROR           0x80010000U
+#define OPCUA_BAD_INTERNAL_ERROR             0x80020000U
+#define OPCUA_BAD_OUT_OF_MEMORY              0x80030000U
+#define OPCUA_BAD_DECODING_ERROR             0x80070000U
+#define OPCUA_BAD_SERVICE_UNSUPPORTED        0x800B0000U
+#define OPCUA_BAD_TIMEOUT                    0x800A0000U
+#define OPCUA_BAD_NOTHING_TO_DO              0x800F0000U
+#define OPCUA_BAD_TOO_MANY_OPERATIONS        0x80100000U
+#define OPCUA_BAD_IDENTITY_TOKEN_INVALID     0x80200000U
+#define OPCUA_BAD_SESSION_ID_INVALID         0x80250000U
+#define OPCUA_BAD_SESSION_NOT_ACTIVATED      0x80270000U
+#define OPCUA_BAD_SUBSCRIPTION_ID_INVALID    0x80280000U
+#define OPCUA_BAD_TIMESTAMPS_TO_RETURN_INVALID 0x802B0000U
+#define OPCUA_BAD_NODE_ID_UNKNOWN            0x80340000U
+#define OPCUA_BAD_ATTRIBUTE_ID_INVALID       0x80350000U
+#define OPCUA_BAD_INDEX_RANGE_INVALID        0x80360000U
+#define OPCUA_BAD_MONITORING_MODE_INVALID    0x80410000U
+#define OPCUA_BAD_MONITORED_ITEM_ID_INVALID  0x80420000U
+#define OPCUA_BAD_MONITORED_ITEM_FILTER_UNSUPPORTED 0x80440000U
+#define OPCUA_BAD_CONTINUATION_POINT_INVALID 0x804A0000U
+#define OPCUA_BAD_REFERENCE_TYPE_ID_INVALID  0x804C0000U
+#define OPCUA_BAD_BROWSE_DIRECTION_INVALID   0x804D0000U
+#define OPCUA_BAD_SECURITY_MODE_REJECTED     0x80540000U
+#define OPCUA_BAD_SECURITY_POLICY_REJECTED   0x80550000U
+#define OPCUA_BAD_TOO_MANY_SESSIONS          0x80560000U
+#define OPCUA_BAD_TOO_MANY_SUBSCRIPTIONS     0x80770000U
+#define OPCUA_BAD_TOO_MANY_PUBLISH_REQUESTS  0x80780000U
+#define OPCUA_BAD_NO_SUBSCRIPTION            0x80790000U
+#define OPCUA_BAD_SEQUENCE_NUMBER_UNKNOWN    0x807A0000U
+#define OPCUA_BAD_MESSAGE_NOT_AVAILABLE      0x807B0000U
+#define OPCUA_BAD_TCP_MESSAGE_TYPE_INVALID   0x807E0000U
+#define OPCUA_BAD_TCP_SECURE_CHANNEL_UNKNOWN 0x807F0000U
+#define OPCUA_BAD_TCP_MESSAGE_TOO_LARGE      0x80800000U
+#define OPCUA_BAD_TCP_NOT_ENOUGH_RESOURCES   0x80810000U
+#define OPCUA_BAD_TCP_INTERNAL_ERROR         0x80820000U
+#define OPCUA_BAD_REQUEST_TOO_LARGE          0x80B80000U
+#define OPCUA_BAD_RESPONSE_TOO_LARGE         0x80B90000U
+#define OPCUA_BAD_PROTOCOL_VERSION_UNSUPPORTED 0x80BE0000U
+#define OPCUA_BAD_TOO_MANY_MONITORED_ITEMS   0x80DB0000U
+
+/* Binary encoding ids of the supported service messages */
+#define OPCUA_ID_SERVICE_FAULT                397
+#define OPCUA_ID_FIND_SERVERS_REQUEST         422
+#define OPCUA_ID_FIND_SERVERS_RESPONSE        425
+#define OPCUA_ID_GET_ENDPOINTS_REQUEST        428
+#define OPCUA_ID_GET_ENDPOINTS_RESPONSE       431
+#define OPCUA_ID_OPEN_SECURE_CHANNEL_REQUEST  446
+#define OPCUA_ID_OPEN_SECURE_CHANNEL_RESPONSE 449
+#define OPCUA_ID_CLOSE_SECURE_CHANNEL_REQUEST 452
+#define OPCUA_ID_CREATE_SESSION_REQUEST       461
+#define OPCUA_ID_CREATE_SESSION_RESPONSE      464
+#define OPCUA_ID_ACTIVATE_SESSION_REQUEST     467
+#define OPCUA_ID_ACTIVATE_SESSION_RESPONSE    470
+#define OPCUA_ID_CLOSE_SESSION_REQUEST        473
+#define OPCUA_ID_CLOSE_SESSION_RESPONSE       476
+#define OPCUA_ID_BROWSE_REQUEST               527
+#define OPCUA_ID_BROWSE_RESPONSE              530
+#define OPCUA_ID_BROWSE_NEXT_REQUEST          533
+#define OPCUA_ID_BROWSE_NEXT_RESPONSE         536
+#define OPCUA_ID_READ_REQUEST                 631
+#define OPCUA_ID_READ_RESPONSE                634
+#define OPCUA_ID_CREATE_MONITORED_ITEMS_REQUEST  751
+#define OPCUA_ID_CREATE_MONITORED_ITEMS_RESPONSE 754
+#define OPCUA_ID_MODIFY_MONITORED_ITEMS_REQUEST  763
+#define OPCUA_ID_MODIFY_MONITORED_ITEMS_RESPONSE 766
+#define OPCUA_ID_SET_MONITORING_MODE_REQUEST     769
+#define OPCUA_ID_SET_MONITORING_MODE_RESPONSE    772
+#define OPCUA_ID_DELETE_MONITORED_ITEMS_REQUEST  781
+#define OPCUA_ID_DELETE_MONITORED_ITEMS_RESPONSE 784
+#define OPCUA_ID_CREATE_SUBSCRIPTION_REQUEST     787
+#define OPCUA_ID_CREATE_SUBSCRIPTION_RESPONSE    790
+#define OPCUA_ID_MODIFY_SUBSCRIPTION_REQUEST     793
+#define OPCUA_ID_MODIFY_SUBSCRIPTION_RESPONSE    796
+#define OPCUA_ID_SET_PUBLISHING_MODE_REQUEST     799
+#define OPCUA_ID_SET_PUBLISHING_MODE_RESPONSE    802
+#define OPCUA_ID_PUBLISH_REQUEST                 826
+#define OPCUA_ID_PUBLISH_RESPONSE                829
+#define OPCUA_ID_REPUBLISH_REQUEST               832
+#define OPCUA_ID_DELETE_SUBSCRIPTIONS_REQUEST    847
+#define OPCUA_ID_DELETE_SUBSCRIPTIONS_RESPONSE   850
+
+/* Other binary encoding ids */
+#define OPCUA_ID_ANONYMOUS_IDENTITY_TOKEN     321
+#define OPCUA_ID_SERVER_STATUS_DATA_TYPE      864
+#define OPCUA_ID_DATA_CHANGE_FILTER           724
+#define OPCUA_ID_DATA_CHANGE_NOTIFICATION     811
+
+enum opcua_timestamps_to_return {
+    OPCUA_TIMESTAMPS_SOURCE,
+    OPCUA_TIMESTAMPS_SERVER,
+    OPCUA_TIMESTAMPS_BOTH,
+    OPCUA_TIMESTAMPS_NEITHER,
+};
+
+/* Built-in type ids, as used in a Variant */
+enum opcua_type {
+    OPCUA_TYPE_NULL = 0,
+    OPCUA_TYPE_BOOLEAN = 1,
+    OPCUA_TYPE_BYTE = 3,
+    OPCUA_TYPE_INT32 = 6,
+    OPCUA_TYPE_UINT32 = 7,
+    OPCUA_TYPE_DOUBLE = 11,
+    OPCUA_TYPE_STRING = 12,
+    OPCUA_TYPE_DATETIME = 13,
+    OPCUA_TYPE_NODEID = 17,
+    OPCUA_TYPE_STATUS_CODE = 19,
+    OPCUA_TYPE_QUALIFIED_NAME = 20,
+    OPCUA_TYPE_LOCALIZED_TEXT = 21,
+    OPCUA_TYPE_EXTENSION_OBJECT = 22,
+};
+
+enum opcua_nodeid_type {
+    OPCUA_NODEID_NUMERIC,
+    OPCUA_NODEID_STRING,
+    OPCUA_NODEID_GUID,
+    OPCUA_NODEID_BYTESTRING,
+};
+
+/** A String or ByteString pointing into a received message, len -1 is null */
+struct opcua_string {
+    const uint8_t *data;
+    int32_t len;
+};
+
+struct opcua_nodeid {
+    uint16_t ns;
+    uint8_t type;
+    union {
+        uint32_t numeric;
+        uint8_t guid[16];
+        struct opcua_string string;
+    };
+};
+
+struct opcua_request_header {
+    struct opcua_nodeid auth_token;
+    uint32_t handle;
+    uint32_t timeout_hint;
+};
+
+/**
+ * @brief Cursor over an encoded message
+ *
+ * Reads past the end return zeroes and writes past the end are dropped.
+ * Both set @ref error, which stays set, so a whole message can be decoded
+ * or encoded before checking it once.
+ */
+struct opcua_buf {
+    uint8_t *data;
+    size_t len;
+    size_t pos;
+    bool error;
+};
+
+/** Scalar value, or a borrowed array of strings */
+struct opcua_variant {
+    uint8_t type;
+    uint16_t count;
+    bool array;
+    union {
+        bool boolean;
+        uint8_t byte;
+        int32_t int32;
+        uint32_t uint32;
+        uint32_t status;
+        double dbl;
+        int64_t datetime;
+        const char *string;
+        const char *const *strings;
+        struct opcua_nodeid nodeid;
+        /* QualifiedName and LocalizedText, the latter without namespace */
+        struct {
+            const char *text;
+            uint16_t ns;
+        } name;
+        /* ExtensionObject, @ref encode writes the body */
+        struct {
+            uint32_t type_id;
+            void (*encode)(struct opcua_buf *buf, const void *arg);
+            const void *arg;
+        } object;
+    };
+};
+
+void opcua_buf_init(struct opcua_buf *buf, uint8_t *data, size_t len);
+
+uint8_t opcua_read_u8(struct opcua_buf *buf);
+uint16_t opcua_read_u16(struct opcua_buf *buf);
+uint32_t opcua_read_u32(struct opcua_buf *buf);
+int32_t opcua_read_i32(struct opcua_buf *buf);
+int64_t opcua_read_i64(struct opcua_buf *buf);
+double opcua_read_double(struct opcua_buf *buf);
+void opcua_read_string(struct opcua_buf *buf, struct opcua_string *str);
+void opcua_read_nodeid(struct opcua_buf *buf, struct opcua_nodeid *id);
+void opcua_skip(struct opcua_buf *buf, size_t len);
+void opcua_skip_string(struct opcua_buf *buf);
+void opcua_skip_string_array(struct opcua_buf *buf);
+void opcua_skip_localized_text(struct opcua_buf *buf);
+void opcua_skip_qualified_name(struct opcua_buf *buf);
+void opcua_skip_extension_object(struct opcua_buf *buf);
+void opcua_skip_application_description(struct opcua_buf *buf);
+void opcua_read_request_header(struct opcua_buf *buf, struct opcua_request_header *hdr);
+
+/* Array length, -1 (null) is returned as 0 */
+int32_t opcua_read_array_len(struct opcua_buf *buf);
+
+void opcua_write_u8(struct opcua_buf *buf, uint8_t val);
+void opcua_write_u16(struct opcua_buf *buf, uint16_t val);
+void opcua_write_u32(struct opcua_buf *buf, uint32_t val);
+void opcua_write_i32(struct opcua_buf *buf, int32_t val);
+void opcua_write_i64(struct opcua_buf *buf, int64_t val);
+void opcua_write_double(struct opcua_buf *buf, double val);
+void opcua_write_raw(struct opcua_buf *buf, const void *data, size_t len);
+void opcua_write_bytestring(struct opcua_buf *buf, const void *data, int32_t len);
+/* A NULL @p str is encoded as the null string */
+void opcua_write_string(struct opcua_buf *buf, const char *str);
+void opcua_write_nodeid(struct opcua_buf *buf, const struct opcua_nodeid *id);
+void opcua_write_numeric_nodeid(struct opcua_buf *buf, uint16_t ns, uint32_t id);
+void opcua_write_qualified_name(struct opcua_buf *buf, uint16_t ns, const char *name);
+void opcua_write_localized_text(struct opcua_buf *buf, const char *text);
+void opcua_write_variant(struct opcua_buf *buf, const struct opcua_variant *val);
+/**
+ * @brief Write a DataValue
+ *
+ * @param timestamps enum opcua_timestamps_to_return
+ * @param source Include the source timestamp, only for Value attributes
+ * @param time Both timestamps, when the value was read
+ */
+void opcua_write_data_value(struct opcua_buf *buf, uint32_t status,
+                            const struct opcua_variant *val, uint32_t timestamps,
+                            bool source, int64_t time);
+void opcua_write_response_header(struct opcua_buf *buf, uint32_t handle, uint32_t status);
+void opcua_patch_u32(struct opcua_buf *buf, size_t pos, uint32_t val);
+
+bool opcua_nodeid_equal(const struct opcua_nodeid *a, const struct opcua_nodeid *b);
+bool opcua_string_equal(const struct opcua_string *str, const char *cstr);
+
+/** Current time as an OPC UA DateTime */
+int64_t opcua_datetime_now(void);
+
+#endif /* OPCUA_BINARY_H */
@@ -0,0 +1,500 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/version.h>
+
+#include "OpcUaNodes.h"
+
+/* Namespace 0 types */
+#define BASE_OBJECT_TYPE          58
+#define FOLDER_TYPE               61
+#define BASE_DATA_VARIABLE_TYPE   63
+#define PROPERTY_TYPE             68
+#define SERVER_TYPE               2004
+#define SERVER_STATUS_TYPE        2138
+
+/* Namespace 0 data types */
+#define DT_BOOLEAN       1
+#define DT_INT32         6
+#define DT_UINT32        7
+#define DT_STRING        12
+#define DT_DATETIME      13
+#define DT_SERVER_STATE  852
+#define DT_SERVER_STATUS 862
+
+/* Server object */
+#define SERVER               2253
+#define SERVER_ARRAY         2254
+#define NAMESPACE_ARRAY      2255
+#define SERVER_STATUS        2256
+#define SERVER_START_TIME    2257
+#define SERVER_CURRENT_TIME  2258
+#define SERVER_STATE         2259
+
+#define ACCESS_LEVEL_CURRENT_READ 0x01
+
+#define OBJECT(_ns, _id, _name, _parent_ns, _parent, _ref, _type)             \
+    {                                                                         \
+        .id = _id, .parent = _parent, .reference = _ref,                      \
+        .type_definition = _type, .name = _name, .ns = _ns,                   \
+        .parent_ns = _parent_ns, .node_class = OPCUA_NODECLASS_OBJECT,        \
+    }
+
+#define VARIABLE(_ns, _id, _name, _parent, _ref, _type, _data_type, _rank,    \
+                 _source, _offset, _changes)                                  \
+    {                                                                         \
+        .id = _id, .parent = _parent, .reference = _ref,                      \
+        .type_definition = _type, .data_type = _data_type, .name = _name,     \
+        .changes = _changes, .offset = _offset, .ns = _ns, .parent_ns = _ns,  \
+        .node_class = OPCUA_NODECLASS_VARIABLE, .source = _source,            \
+        .value_rank = _rank,                                                  \
+    }
+
+#define TYPE(_id, _name, _node_class)                                         \
+    { .id = _id, .name = _name, .node_class = _node_class }
+
+#define CONFIG_VARIABLE(_id, _name, _data_type, _field, _index)               \
+    VARIABLE(1, _id, _name, OPCUA_ID_CONFIG, OPCUA_ID_HAS_COMPONENT,           \
+             BASE_DATA_VARIABLE_TYPE, _data_type, -1, OPCUA_SOURCE_SNAPSHOT,  \
+             offsetof(struct opcua_snapshot, config._field),                  \
+             OPCUA_CHANGE_CONFIG(_index))
+
+#define STATS_VARIABLE(_id, _name, _field)                                    \
+    VARIABLE(1, _id, _name, OPCUA_ID_NETSTATS, OPCUA_ID_HAS_COMPONENT,         \
+             BASE_DATA_VARIABLE_TYPE, DT_UINT32, -1, OPCUA_SOURCE_SNAPSHOT,   \
+             offsetof(struct opcua_snapshot, stats._field),                   \
+             OPCUA_CHANGE_STATS(offsetof(struct netstats, _field) / sizeof(uint32_t)))
+
+/* The address space is fixed at compile time and lives in flash. Browse
+ * names of the configuration and statistics variables are the keys of the
+ * JSON documents served on /ws_echo and /api.
+ */
+static const struct opcua_node nodes[] = {
+    OBJECT(0, OPCUA_ID_ROOT_FOLDER, "Root", 0, 0, 0, FOLDER_TYPE),
+    OBJECT(0, OPCUA_ID_OBJECTS_FOLDER, "Objects", 0, OPCUA_ID_ROOT_FOLDER,
+           OPCUA_ID_ORGANIZES, FOLDER_TYPE),
+    OBJECT(0, 86, "Types", 0, OPCUA_ID_ROOT_FOLDER, OPCUA_ID_ORGANIZES, FOLDER_TYPE),
+    OBJECT(0, 87, "Views", 0, OPCUA_ID_ROOT_FOLDER, OPCUA_ID_ORGANIZES, FOLDER_TYPE),
+
+    OBJECT(0, SERVER, "Server", 0, OPCUA_ID_OBJECTS_FOLDER, OPCUA_ID_ORGANIZES,
+           SERVER_TYPE),
+    VARIABLE(0, SERVER_ARRAY, "ServerArray", SERVER, OPCUA_ID_HAS_PROPERTY,
+             PROPERTY_TYPE, DT_STRING, 1, OPCUA_SOURCE_SERVER_ARRAY, 0, 0),
+    VARIABLE(0, NAMESPACE_ARRAY, "NamespaceArray", SERVER, OPCUA_ID_HAS_PROPERTY,
+             PROPERTY_TYPE, DT_STRING, 1, OPCUA_SOURCE_NAMESPACE_ARRAY, 0, 0),
+    VARIABLE(0, SERVER_STATUS, "ServerStatus", SERVER, OPCUA_ID_HAS_COMPONENT,
+             SERVER_STATUS_TYPE, DT_SERVER_STATUS, -1, OPCUA_SOURCE_SERVER_STATUS, 0,
+             OPCUA_CHANGE_CLOCK),
+    VARIABLE(0, SERVER_START_TIME, "StartTime", SERVER_STATUS, OPCUA_ID_HAS_COMPONENT,
+             BASE_DATA_VARIABLE_TYPE, DT_DATETIME, -1, OPCUA_SOURCE_START_TIME, 0, 0),
+    VARIABLE(0, SERVER_CURRENT_TIME, "CurrentTime", SERVER_STATUS,
+             OPCUA_ID_HAS_COMPONENT, BASE_DATA_VARIABLE_TYPE, DT_DATETIME, -1,
+             OPCUA_SOURCE_CURRENT_TIME, 0, OPCUA_CHANGE_CLOCK),
+    VARIABLE(0, SERVER_STATE, "State", SERVER_STATUS, OPCUA_ID_HAS_COMPONENT,
+             BASE_DATA_VARIABLE_TYPE, DT_SERVER_STATE, -1, OPCUA_SOURCE_STATE, 0, 0),
+
+    OBJECT(1, OPCUA_ID_INDUCTION, "Induction", 0, OPCUA_ID_OBJECTS_FOLDER,
+           OPCUA_ID_ORGANIZES, FOLDER_TYPE),
+
+    OBJECT(1, OPCUA_ID_CONFIG, "Config", 1, OPCUA_ID_INDUCTION, OPCUA_ID_ORGANIZES,
+           BASE_OBJECT_TYPE),
+    CONFIG_VARIABLE(1002, "DHCP", DT_STRING, dhcp, 0),
+    CONFIG_VARIABLE(1003, "IP4Address", DT_STRING, ip4_address, 1),
+    CONFIG_VARIABLE(1004, "NetMask", DT_STRING, netmask, 2),
+    CONFIG_VARIABLE(1005, "isEnabled_CAN_1_0", DT_BOOLEAN, cfg.isEnabled_CAN_1_0, 3),
+    CONFIG_VARIABLE(1006, "isEnabled_CAN_1_1", DT_BOOLEAN, cfg.isEnabled_CAN_1_1, 4),
+    CONFIG_VARIABLE(1007, "isEnabled_CAN_1_2", DT_BOOLEAN, cfg.isEnabled_CAN_1_2, 5),
+    CONFIG_VARIABLE(1008, "isEnabled_CAN_1_3", DT_BOOLEAN, cfg.isEnabled_CAN_1_3, 6),
+    CONFIG_VARIABLE(1009, "isEnabled_CAN_2_0", DT_BOOLEAN, cfg.isEnabled_CAN_2_0, 7),
+    CONFIG_VARIABLE(1010, "isEnabled_CAN_2_1", DT_BOOLEAN, cfg.isEnabled_CAN_2_1, 8),
+    CONFIG_VARIABLE(1011, "isEnabled_CAN_2_2", DT_BOOLEAN, cfg.isEnabled_CAN_2_2, 9),
+    CONFIG_VARIABLE(1012, "isEnabled_CAN_2_3", DT_BOOLEAN, cfg.isEnabled_CAN_2_3, 10),
+
+    OBJECT(1, OPCUA_ID_NETSTATS, "NetStats", 1, OPCUA_ID_INDUCTION, OPCUA_ID_ORGANIZES,
+           BASE_OBJECT_TYPE),
+    STATS_VARIABLE(1101, "bytes_recv", bytes_recv),
+    STATS_VARIABLE(1102, "bytes_sent", bytes_sent),
+    STATS_VARIABLE(1103, "ipv6_pkt_recv", ipv6_recv),
+    STATS_VARIABLE(1104, "ipv6_pkt_sent", ipv6_sent),
+    STATS_VARIABLE(1105, "ipv4_pkt_recv", ipv4_recv),
+    STATS_VARIABLE(1106, "ipv4_pkt_sent", ipv4_sent),
+    STATS_VARIABLE(1107, "tcp_bytes_recv", tcp_recv),
+    STATS_VARIABLE(1108, "tcp_bytes_sent", tcp_sent),
+
+    /* Type definitions, only there to be browsed to */
+    TYPE(BASE_OBJECT_TYPE, "BaseObjectType", OPCUA_NODECLASS_OBJECT_TYPE),
+    TYPE(FOLDER_TYPE, "FolderType", OPCUA_NODECLASS_OBJECT_TYPE),
+    TYPE(SERVER_TYPE, "ServerType", OPCUA_NODECLASS_OBJECT_TYPE),
+    TYPE(BASE_DATA_VARIABLE_TYPE, "BaseDataVariableType", OPCUA_NODECLASS_VARIABLE_TYPE),
+    TYPE(PROPERTY_TYPE, "PropertyType", OPCUA_NODECLASS_VARIABLE_TYPE),
+    TYPE(SERVER_STATUS_TYPE, "ServerStatusType", OPCUA_NODECLASS_VARIABLE_TYPE),
+};
+
+/* Supertypes of the reference types in use */
+static const struct {
+    uint32_t type;
+    uint32_t super;
+} reference_types[] = {
+    { OPCUA_ID_NON_HIERARCHICAL, OPCUA_ID_REFERENCES },
+    { OPCUA_ID_HIERARCHICAL, OPCUA_ID_REFERENCES },
+    { OPCUA_ID_HAS_CHILD, OPCUA_ID_HIERARCHICAL },
+    { OPCUA_ID_ORGANIZES, OPCUA_ID_HIERARCHICAL },
+    { OPCUA_ID_HAS_TYPE_DEFINITION, OPCUA_ID_NON_HIERARCHICAL },
+    { OPCUA_ID_AGGREGATES, OPCUA_ID_HAS_CHILD },
+    { OPCUA_ID_HAS_PROPERTY, OPCUA_ID_AGGREGATES },
+    { OPCUA_ID_HAS_COMPONENT, OPCUA_ID_AGGREGATES },
+};
+
+static const char *const server_array[] = {
+    OPCUA_APPLICATION_URI,
+};
+
+static const char *const namespace_array[] = {
+    "http://opcfoundation.org/UA/",
+    OPCUA_NAMESPACE_URI,
+};
+
+static int64_t start_time;
+
+void opcua_nodes_init(void)
+{
+    start_time = opcua_datetime_now();
+}
+
+void opcua_snapshot_take(struct opcua_snapshot *snap)
+{
+    InductionConfig_get(&snap->config);
+    netstats_get(&snap->stats);
+    snap->now = opcua_datetime_now();
+}
+
+void opcua_snapshot_update(struct opcua_snapshot *snap, uint32_t changes)
+{
+    if (changes & OPCUA_CHANGE_CONFIG_ALL) {
+        InductionConfig_get(&snap->config);
+    }
+    if (changes & OPCUA_CHANGE_STATS_ALL) {
+        netstats_get(&snap->stats);
+    }
+    snap->now = opcua_datetime_now();
+}
+
+static const struct opcua_node *find(uint8_t ns, uint32_t id)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(nodes); i++) {
+        if (nodes[i].id == id && nodes[i].ns == ns) {
+            return &nodes[i];
+        }
+    }
+
+    return NULL;
+}
+
+const struct opcua_node *opcua_node_find(const struct opcua_nodeid *id)
+{
+    if (id->type != OPCUA_NODEID_NUMERIC || id->ns > 1) {
+        return NULL;
+    }
+
+    return find(id->ns, id->numeric);
+}
+
+/* ServerStatusDataType body, @p arg points to the current time */
+static void encode_server_status(struct opcua_buf *buf, const void *arg)
+{
+    const int64_t *now = arg;
+
+    opcua_write_i64(buf, start_time);
+    opcua_write_i64(buf, *now);
+    opcua_write_i32(buf, 0); /* Running */
+    opcua_write_string(buf, OPCUA_PRODUCT_URI);
+    opcua_write_string(buf, "Zephyr Project");
+    opcua_write_string(buf, "Induction OPC UA Server");
+    opcua_write_string(buf, KERNEL_VERSION_STRING);
+    opcua_write_string(buf, NULL);
+    opcua_write_i64(buf, start_time);
+    opcua_write_u32(buf, 0);
+    opcua_write_localized_text(buf, NULL);
+}
+
+static void read_snapshot(const struct opcua_node *node, const struct opcua_snapshot *snap,
+                          struct opcua_variant *val)
+{
+    const uint8_t *field = (const uint8_t *)snap + node->offset;
+    int32_t flag;
+
+    switch (node->data_type) {
+    case DT_BOOLEAN:
+        memcpy(&flag, field, sizeof(flag));
+        val->type = OPCUA_TYPE_BOOLEAN;
+        val->boolean = flag != 0;
+        break;
+    case DT_UINT32:
+        val->type = OPCUA_TYPE_UINT32;
+        memcpy(&val->uint32, field, sizeof(val->uint32));
+        break;
+    case DT_STRING:
+        val->type = OPCUA_TYPE_STRING;
+        val->string = (const char *)field;
+        break;
+    default:
+        break;
+    }
+}
+
+static uint32_t read_value(const struct opcua_node *node, const struct opcua_snapshot *snap,
+                           struct opcua_variant *val)
+{
+    switch (node->source) {
+    case OPCUA_SOURCE_SNAPSHOT:
+        read_snapshot(node, snap, val);
+        break;
+    case OPCUA_SOURCE_SERVER_ARRAY:
+        val->type = OPCUA_TYPE_STRING;
+        val->array = true;
+        val->strings = server_array;
+        val->count = ARRAY_SIZE(server_array);
+        break;
+    case OPCUA_SOURCE_NAMESPACE_ARRAY:
+        val->type = OPCUA_TYPE_STRING;
+        val->array = true;
+        val->strings = namespace_array;
+        val->count = ARRAY_SIZE(namespace_array);
+        break;
+    case OPCUA_SOURCE_SERVER_STATUS:
+        val->type = OPCUA_TYPE_EXTENSION_OBJECT;
+        val->object.type_id = OPCUA_ID_SERVER_STATUS_DATA_TYPE;
+        val->object.encode = encode_server_status;
+        val->object.arg = &snap->now;
+        break;
+    case OPCUA_SOURCE_START_TIME:
+        val->type = OPCUA_TYPE_DATETIME;
+        val->datetime = start_time;
+        break;
+    case OPCUA_SOURCE_CURRENT_TIME:
+        val->type = OPCUA_TYPE_DATETIME;
+        val->datetime = snap->now;
+        break;
+    case OPCUA_SOURCE_STATE:
+        val->type = OPCUA_TYPE_INT32;
+        val->int32 = 0;
+        break;
+    default:
+        return OPCUA_BAD_ATTRIBUTE_ID_INVALID;
+    }
+
+    return OPCUA_GOOD;
+}
+
+static uint32_t read_variable(const struct opcua_node *node, uint32_t attribute,
+                              const struct opcua_snapshot *snap, struct opcua_variant *val)
+{
+    switch (attribute) {
+    case OPCUA_ATTR_VALUE:
+        return read_value(node, snap, val);
+    case OPCUA_ATTR_DATA_TYPE:
+        val->type = OPCUA_TYPE_NODEID;
+        val->nodeid.numeric = node->data_type;
+        break;
+    case OPCUA_ATTR_VALUE_RANK:
+        val->type = OPCUA_TYPE_INT32;
+        val->int32 = node->value_rank;
+        break;
+    case OPCUA_ATTR_ARRAY_DIMENSIONS:
+        if (node->value_rank < 1) {
+            return OPCUA_BAD_ATTRIBUTE_ID_INVALID;
+        }
+        /* One dimension of unknown length */
+        val->type = OPCUA_TYPE_UINT32;
+        val->array = true;
+        val->count = 1;
+        break;
+    case OPCUA_ATTR_ACCESS_LEVEL:
+    case OPCUA_ATTR_USER_ACCESS_LEVEL:
+        val->type = OPCUA_TYPE_BYTE;
+        val->byte = ACCESS_LEVEL_CURRENT_READ;
+        break;
+    case OPCUA_ATTR_MINIMUM_SAMPLING_INTERVAL:
+        val->type = OPCUA_TYPE_DOUBLE;
+        val->dbl = 0.0;
+        break;
+    case OPCUA_ATTR_HISTORIZING:
+        val->type = OPCUA_TYPE_BOOLEAN;
+        val->boolean = false;
+        break;
+    default:
+        return OPCUA_BAD_ATTRIBUTE_ID_INVALID;
+    }
+
+    return OPCUA_GOOD;
+}
+
+uint32_t opcua_node_read(const struct opcua_node *node, uint32_t attribute,
+                         const struct opcua_snapshot *snap, struct opcua_variant *val)
+{
+    memset(val, 0, sizeof(*val));
+
+    switch (attribute) {
+    case OPCUA_ATTR_NODE_ID:
+        val->type = OPCUA_TYPE_NODEID;
+        val->nodeid.ns = node->ns;
+        val->nodeid.numeric = node->id;
+        return OPCUA_GOOD;
+    case OPCUA_ATTR_NODE_CLASS:
+        val->type = OPCUA_TYPE_INT32;
+        val->int32 = node->node_class;
+        return OPCUA_GOOD;
+    case OPCUA_ATTR_BROWSE_NAME:
+        val->type = OPCUA_TYPE_QUALIFIED_NAME;
+        val->name.ns = node->ns;
+        val->name.text = node->name;
+        return OPCUA_GOOD;
+    case OPCUA_ATTR_DISPLAY_NAME:
+        val->type = OPCUA_TYPE_LOCALIZED_TEXT;
+        val->name.text = node->name;
+        return OPCUA_GOOD;
+    case OPCUA_ATTR_DESCRIPTION:
+        val->type = OPCUA_TYPE_LOCALIZED_TEXT;
+        return OPCUA_GOOD;
+    case OPCUA_ATTR_WRITE_MASK:
+    case OPCUA_ATTR_USER_WRITE_MASK:
+        val->type = OPCUA_TYPE_UINT32;
+        return OPCUA_GOOD;
+    default:
+        break;
+    }
+
+    switch (node->node_class) {
+    case OPCUA_NODECLASS_OBJECT:
+        if (attribute != OPCUA_ATTR_EVENT_NOTIFIER) {
+            return OPCUA_BAD_ATTRIBUTE_ID_INVALID;
+        }
+        val->type = OPCUA_TYPE_BYTE;
+        return OPCUA_GOOD;
+    case OPCUA_NODECLASS_VARIABLE:
+        return read_variable(node, attribute, snap, val);
+    default:
+        if (attribute != OPCUA_ATTR_IS_ABSTRACT) {
+            return OPCUA_BAD_ATTRIBUTE_ID_INVALID;
+        }
+        val->type = OPCUA_TYPE_BOOLEAN;
+        return OPCUA_GOOD;
+    }
+}
+
+void opcua_node_sample(const struct opcua_node *node, uint32_t attribute,
+                       const struct opcua_snapshot *snap, struct opcua_sample *sample)
+{
+    struct opcua_variant *val = &sample->value;
+
+    sample->status = opcua_node_read(node, attribute, snap, val);
+    sample->time = snap->now;
+
+    /* Only configuration strings and the server status point into snap */
+    if (val->type == OPCUA_TYPE_STRING && !val->array && val->string != NULL &&
+        node->source == OPCUA_SOURCE_SNAPSHOT) {
+        strncpy(sample->text, val->string, sizeof(sample->text) - 1);
+        sample->text[sizeof(sample->text) - 1] = '\0';
+        val->string = sample->text;
+    } else if (val->type == OPCUA_TYPE_EXTENSION_OBJECT) {
+        val->object.arg = &sample->time;
+    }
+}
+
+/*
+ * Cursor 0 is the inverse reference to the parent, 1 the type definition
+ * and 2 + i the i-th entry of the node table, if it is a child.
+ */
+bool opcua_node_next_reference(const struct opcua_node *node, uint32_t *cursor,
+                               struct opcua_reference *ref)
+{
+    if (*cursor == 0) {
+        *cursor = 1;
+        if (node->reference != 0) {
+            ref->type = node->reference;
+            ref->forward = false;
+            ref->target = find(node->parent_ns, node->parent);
+            if (ref->target != NULL) {
+                return true;
+            }
+        }
+    }
+
+    if (*cursor == 1) {
+        *cursor = 2;
+        if (node->type_definition != 0) {
+            ref->type = OPCUA_ID_HAS_TYPE_DEFINITION;
+            ref->forward = true;
+            ref->target = find(0, node->type_definition);
+            if (ref->target != NULL) {
+                return true;
+            }
+        }
+    }
+
+    while (*cursor - 2 < ARRAY_SIZE(nodes)) {
+        const struct opcua_node *child = &nodes[*cursor - 2];
+
+        (*cursor)++;
+
+        if (child->reference != 0 && child->parent == node->id &&
+            child->parent_ns == node->ns) {
+            ref->type = child->reference;
+            ref->forward = true;
+            ref->target = child;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool opcua_reference_matches(uint32_t requested, uint32_t type, bool subtypes)
+{
+    if (requested == 0 || requested == type) {
+        return true;
+    }
+
+    while (subtypes) {
+        size_t i;
+
+        for (i = 0; i < ARRAY_SIZE(reference_types); i++) {
+            if (reference_types[i].type == type) {
+                break;
+            }
+        }
+
+        if (i == ARRAY_SIZE(reference_types)) {
+            return false;
+        }
+
+        type = reference_types[i].super;
+        if (type == requested) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool opcua_reference_known(uint32_t id)
+{
+    if (id == 0 || id == OPCUA_ID_REFERENCES) {
+        return true;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(reference_types); i++) {
+        if (reference_types[i].type == id) {
+            return true;
+        }
+    }
+
+    return false;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OPCUA_NODES_H
+#define OPCUA_NODES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/util.h>
+
+#include "InductionConfig.h"
+#include "netstats.h"
+#include "TagDb.h"
+#include "OpcUaBinary.h"
+
+#define OPCUA_APPLICATION_URI "urn:zephyr:induction:server"
+#define OPCUA_PRODUCT_URI     "urn:zephyr:induction"
+#define OPCUA_NAMESPACE_URI   "urn:zephyr:induction"
+
+/* Namespace 0 nodes and types used by the address space */
+#define OPCUA_ID_ROOT_FOLDER         84
+#define OPCUA_ID_OBJECTS_FOLDER      85
+#define OPCUA_ID_REFERENCES          31
+#define OPCUA_ID_NON_HIERARCHICAL    32
+#define OPCUA_ID_HIERARCHICAL        33
+#define OPCUA_ID_HAS_CHILD           34
+#define OPCUA_ID_ORGANIZES           35
+#define OPCUA_ID_HAS_TYPE_DEFINITION 40
+#define OPCUA_ID_AGGREGATES          44
+#define OPCUA_ID_HAS_PROPERTY        46
+#define OPCUA_ID_HAS_COMPONENT       47
+
+/* Namespace 1 nodes */
+#define OPCUA_ID_INDUCTION 1000
+#define OPCUA_ID_CONFIG    1001
+#define OPCUA_ID_NETSTATS  1100
+
+enum opcua_node_class {
+    OPCUA_NODECLASS_OBJECT = 1,
+    OPCUA_NODECLASS_VARIABLE = 2,
+    OPCUA_NODECLASS_OBJECT_TYPE = 8,
+    OPCUA_NODECLASS_VARIABLE_TYPE = 16,
+};
+
+enum opcua_attribute {
+    OPCUA_ATTR_NODE_ID = 1,
+    OPCUA_ATTR_NODE_CLASS = 2,
+    OPCUA_ATTR_BROWSE_NAME = 3,
+    OPCUA_ATTR_DISPLAY_NAME = 4,
+    OPCUA_ATTR_DESCRIPTION = 5,
+    OPCUA_ATTR_WRITE_MASK = 6,
+    OPCUA_ATTR_USER_WRITE_MASK = 7,
+    OPCUA_ATTR_IS_ABSTRACT = 8,
+    OPCUA_ATTR_EVENT_NOTIFIER = 12,
+    OPCUA_ATTR_VALUE = 13,
+    OPCUA_ATTR_DATA_TYPE = 14,
+    OPCUA_ATTR_VALUE_RANK = 15,
+    OPCUA_ATTR_ARRAY_DIMENSIONS = 16,
+    OPCUA_ATTR_ACCESS_LEVEL = 17,
+    OPCUA_ATTR_USER_ACCESS_LEVEL = 18,
+    OPCUA_ATTR_MINIMUM_SAMPLING_INTERVAL = 19,
+    OPCUA_ATTR_HISTORIZING = 20,
+};
+
+/* Where the value of a variable comes from */
+enum opcua_source {
+    OPCUA_SOURCE_NONE,
+    /* Field of struct opcua_snapshot at opcua_node::offset */
+    OPCUA_SOURCE_SNAPSHOT,
+    OPCUA_SOURCE_SERVER_ARRAY,
+    OPCUA_SOURCE_NAMESPACE_ARRAY,
+    OPCUA_SOURCE_SERVER_STATUS,
+    OPCUA_SOURCE_START_TIME,
+    OPCUA_SOURCE_CURRENT_TIME,
+    OPCUA_SOURCE_STATE,
+};
+
+/*
+ * Bits of a change mask, telling which sources of variable values changed.
+ * They are the tag database bits: configuration fields are numbered in
+ * DHCP_t order, counters in struct netstats order.
+ */
+#define OPCUA_CHANGE_CONFIG(field)   TAG_MASK(TAG_CONFIG_FIRST + (field))
+#define OPCUA_CHANGE_STATS(counter)  TAG_MASK(TAG_STATS_FIRST + (counter))
+#define OPCUA_CHANGE_CONFIG_ALL      TAG_MASK_CONFIG
+#define OPCUA_CHANGE_STATS_ALL       TAG_MASK_STATS
+/* Values that change all the time, like the current time */
+#define OPCUA_CHANGE_CLOCK           BIT(31)
+
+/**
+ * @brief Node of the static address space
+ *
+ * Hierarchical references are only stored once, as the parent of the
+ * child node. The forward references of a node are found by scanning the
+ * table for its children.
+ */
+struct opcua_node {
+    uint32_t id;
+    uint32_t parent;
+    /** Reference type from the parent to this node */
+    uint32_t reference;
+    uint32_t type_definition;
+    uint32_t data_type;
+    const char *name;
+    /** Change mask bit of the value, 0 if it never changes */
+    uint32_t changes;
+    uint16_t offset;
+    uint8_t ns;
+    uint8_t parent_ns;
+    uint8_t node_class;
+    uint8_t source;
+    int8_t value_rank;
+};
+
+/**
+ * @brief Values the variables are read from
+ *
+ * Taken once per request, so all values returned together are consistent
+ * and each source is only read once.
+ */
+struct opcua_snapshot {
+    InductionConfig_t config;
+    struct netstats stats;
+    int64_t now;
+};
+
+/**
+ * @brief A value that outlives the snapshot it was read from
+ */
+struct opcua_sample {
+    struct opcua_variant value;
+    uint32_t status;
+    int64_t time;
+    char text[INDUCTION_CONFIG_STR_LEN];
+};
+
+struct opcua_reference {
+    uint32_t type;
+    bool forward;
+    const struct opcua_node *target;
+};
+
+void opcua_nodes_init(void);
+
+void opcua_snapshot_take(struct opcua_snapshot *snap);
+
+/** Refresh the parts of @p snap named in the change mask @p changes */
+void opcua_snapshot_update(struct opcua_snapshot *snap, uint32_t changes);
+
+const struct opcua_node *opcua_node_find(const struct opcua_nodeid *id);
+
+/**
+ * @brief Read an attribute of a node
+ *
+ * String values point into @p snap, which must outlive @p val.
+ *
+ * @return OPCUA_GOOD or the status code of the operation
+ */
+uint32_t opcua_node_read(const struct opcua_node *node, uint32_t attribute,
+                         const struct opcua_snapshot *snap, struct opcua_variant *val);
+
+/**
+ * @brief Read an attribute of a node into @p sample
+ *
+ * Like opcua_node_read(), but whatever the value points to in @p snap is
+ * copied into @p sample.
+ */
+void opcua_node_sample(const struct opcua_node *node, uint32_t attribute,
+                       const struct opcua_snapshot *snap, struct opcua_sample *sample);
+
+/**
+ * @brief Iterate over the references of a node
+ *
+ * @param cursor Start at 0, advanced past the returned reference
+ *
+ * @return false once there are no more references
+ */
+bool opcua_node_next_reference(const struct opcua_node *node, uint32_t *cursor,
+                               struct opcua_reference *ref);
+
+/** True if @p type is @p requested, or a subtype of it with @p subtypes */
+bool opcua_reference_matches(uint32_t requested, uint32_t type, bool subtypes);
+
+/** True if @p id is a reference type known to the address space */
+bool opcua_reference_known(uint32_t id);
+
+#endif /* OPCUA_NODES_H */
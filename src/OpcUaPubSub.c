@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stddef.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#include "InductionConfig.h"
+#include "netstats.h"
+#include "OpcUaBinary.h"
+
+APP_LOG_MODULE_REGISTER(opcua_pubsub);
+
+#define STACK_SIZE 2048
+
+#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
+#define THREAD_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
+#else
+#define THREAD_PRIORITY K_PRIO_PREEMPT(8)
+#endif
+
+/* NetworkMessage header, OPC 10000-14 7.2.4.4.2 */
+#define UADP_VERSION             1
+#define UADP_PUBLISHER_ID        0x10
+#define UADP_GROUP_HEADER        0x20
+#define UADP_PAYLOAD_HEADER      0x40
+#define UADP_EXTENDED_FLAGS1     0x80
+#define UADP_PUBLISHER_ID_UINT16 0x01
+
+#define GROUP_WRITER_GROUP_ID    0x01
+#define GROUP_SEQUENCE_NUMBER    0x08
+
+/* DataSetMessage header, OPC 10000-14 7.2.4.5.4 */
+#define DATASET_VALID            0x01
+#define DATASET_SEQUENCE_NUMBER  0x08
+#define DATASET_FLAGS2           0x80
+#define DATASET_TIMESTAMP        0x10
+
+#define STATS_FIELDS (sizeof(struct netstats) / sizeof(uint32_t))
+
+/* The CAN channel states, in the order they are published */
+static const uint16_t can_fields[] = {
+    offsetof(DHCP_t, isEnabled_CAN_1_0),
+    offsetof(DHCP_t, isEnabled_CAN_1_1),
+    offsetof(DHCP_t, isEnabled_CAN_1_2),
+    offsetof(DHCP_t, isEnabled_CAN_1_3),
+    offsetof(DHCP_t, isEnabled_CAN_2_0),
+    offsetof(DHCP_t, isEnabled_CAN_2_1),
+    offsetof(DHCP_t, isEnabled_CAN_2_2),
+    offsetof(DHCP_t, isEnabled_CAN_2_3),
+};
+
+#define FIELDS (STATS_FIELDS + ARRAY_SIZE(can_fields))
+
+/* Header lengths of the NetworkMessage and of its DataSetMessage */
+#define NETWORK_HEADER_LEN 12
+#define DATASET_HEADER_LEN 14
+
+/* A Variant per field: stats counters as UInt32, CAN channel states as Boolean */
+#define MESSAGE_LEN (NETWORK_HEADER_LEN + DATASET_HEADER_LEN + \
+                     STATS_FIELDS * 5 + ARRAY_SIZE(can_fields) * 2)
+
+/**
+ * @brief The NetworkMessage sent every cycle
+ *
+ * The layout never changes, so it is encoded once and only the sequence
+ * numbers, the timestamp and the values are patched in before sending.
+ */
+static struct {
+    uint8_t data[MESSAGE_LEN];
+    size_t len;
+    size_t group_seq;
+    size_t dataset_seq;
+    size_t timestamp;
+    size_t values[FIELDS];
+} message;
+
+static void message_init(void)
+{
+    struct opcua_buf buf;
+
+    opcua_buf_init(&buf, message.data, sizeof(message.data));
+
+    opcua_write_u8(&buf, UADP_VERSION | UADP_PUBLISHER_ID | UADP_GROUP_HEADER |
+                         UADP_PAYLOAD_HEADER | UADP_EXTENDED_FLAGS1);
+    opcua_write_u8(&buf, UADP_PUBLISHER_ID_UINT16);
+    opcua_write_u16(&buf, CONFIG_NET_SAMPLE_OPCUA_PUBSUB_PUBLISHER_ID);
+
+    opcua_write_u8(&buf, GROUP_WRITER_GROUP_ID | GROUP_SEQUENCE_NUMBER);
+    opcua_write_u16(&buf, CONFIG_NET_SAMPLE_OPCUA_PUBSUB_WRITER_GROUP_ID);
+    message.group_seq = buf.pos;
+    opcua_write_u16(&buf, 0);
+
+    /* One DataSetMessage, so no sizes follow the DataSetWriterIds */
+    opcua_write_u8(&buf, 1);
+    opcua_write_u16(&buf, CONFIG_NET_SAMPLE_OPCUA_PUBSUB_DATASET_WRITER_ID);
+
+    /* Key frame with Variant field encoding */
+    opcua_write_u8(&buf, DATASET_VALID | DATASET_SEQUENCE_NUMBER | DATASET_FLAGS2);
+    opcua_write_u8(&buf, DATASET_TIMESTAMP);
+    message.dataset_seq = buf.pos;
+    opcua_write_u16(&buf, 0);
+    message.timestamp = buf.pos;
+    opcua_write_i64(&buf, 0);
+    opcua_write_u16(&buf, FIELDS);
+
+    for (size_t i = 0; i < STATS_FIELDS; i++) {
+        opcua_write_u8(&buf, OPCUA_TYPE_UINT32);
+        message.values[i] = buf.pos;
+        opcua_write_u32(&buf, 0);
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(can_fields); i++) {
+        opcua_write_u8(&buf, OPCUA_TYPE_BOOLEAN);
+        message.values[STATS_FIELDS + i] = buf.pos;
+        opcua_write_u8(&buf, 0);
+    }
+
+    __ASSERT_NO_MSG(!buf.error && buf.pos == sizeof(message.data));
+    message.len = buf.pos;
+}
+
+static void message_update(uint16_t seq)
+{
+    const uint32_t *counters;
+    const InductionConfig_t *config;
+    struct netstats stats;
+
+    netstats_get(&stats);
+
+    sys_put_le16(seq, &message.data[message.group_seq]);
+    sys_put_le16(seq, &message.data[message.dataset_seq]);
+    sys_put_le64(opcua_datetime_now(), &message.data[message.timestamp]);
+
+    counters = (const uint32_t *)&stats;
+    for (size_t i = 0; i < STATS_FIELDS; i++) {
+        sys_put_le32(counters[i], &message.data[message.values[i]]);
+    }
+
+    config = InductionConfig_acquire();
+    for (size_t i = 0; i < ARRAY_SIZE(can_fields); i++) {
+        const int32_t *enabled = (const int32_t *)((const uint8_t *)&config->cfg +
+                                                   can_fields[i]);
+
+        message.data[message.values[STATS_FIELDS + i]] = *enabled != 0;
+    }
+    InductionConfig_release(config);
+}
+
+static int open_socket(struct sockaddr_in *group)
+{
+    int sock;
+
+    memset(group, 0, sizeof(*group));
+    group->sin_family = AF_INET;
+    group->sin_port = htons(CONFIG_NET_SAMPLE_OPCUA_PUBSUB_PORT);
+
+    if (inet_pton(AF_INET, CONFIG_NET_SAMPLE_OPCUA_PUBSUB_ADDRESS, &group->sin_addr) != 1) {
+        LOG_ERR("Invalid PubSub address %s", CONFIG_NET_SAMPLE_OPCUA_PUBSUB_ADDRESS);
+        return -EINVAL;
+    }
+
+    sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (sock < 0) {
+        LOG_ERR("Failed to create PubSub socket (%d)", -errno);
+        return -errno;
+    }
+
+    return sock;
+}
+
+static void opcua_pubsub_thread(void *p1, void *p2, void *p3)
+{
+    struct sockaddr_in group;
+    int64_t next;
+    int last_error = 0;
+    uint16_t seq = 0;
+    int sock;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    message_init();
+
+    sock = open_socket(&group);
+    if (sock < 0) {
+        return;
+    }
+
+    LOG_INF("Publishing UADP to %s:%d every %d ms", CONFIG_NET_SAMPLE_OPCUA_PUBSUB_ADDRESS,
+            CONFIG_NET_SAMPLE_OPCUA_PUBSUB_PORT, CONFIG_NET_SAMPLE_OPCUA_PUBSUB_INTERVAL);
+
+    next = k_uptime_get();
+
+    while (true) {
+        int error = 0;
+
+        message_update(++seq);
+
+        if (sendto(sock, message.data, message.len, 0, (struct sockaddr *)&group,
+                   sizeof(group)) < 0) {
+            error = errno;
+        }
+
+        /* Only report changes, the network may be down for a long time */
+        if (error != last_error) {
+            if (error != 0) {
+                LOG_WRN("PubSub send failed (%d)", -error);
+            } else {
+                LOG_INF("PubSub sending again");
+            }
+            last_error = error;
+        }
+
+        /* Keep the cycle fixed, however long sending took */
+        next += CONFIG_NET_SAMPLE_OPCUA_PUBSUB_INTERVAL;
+        if (next <= k_uptime_get()) {
+            next = k_uptime_get() + CONFIG_NET_SAMPLE_OPCUA_PUBSUB_INTERVAL;
+        }
+        k_sleep(K_TIMEOUT_ABS_MS(next));
+    }
+}
+
+K_THREAD_DEFINE(opcua_pubsub, STACK_SIZE, opcua_pubsub_thread, NULL, NULL, NULL,
+                THREAD_PRIORITY, 0, 0);
@@ -0,0 +1,674 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/net_ip.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WAKEUP)
+#include <zephyr/zvfs/eventfd.h>
+#endif
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+#include <zephyr/net/websocket.h>
+#endif
+
+#include "OpcUaNodes.h"
+#include "OpcUaServer.h"
+
+APP_LOG_MODULE_REGISTER(opcua);
+
+#define STACK_SIZE 4096
+
+#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
+#define THREAD_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
+#else
+#define THREAD_PRIORITY K_PRIO_PREEMPT(8)
+#endif
+
+#define MAX_CONNECTIONS CONFIG_NET_SAMPLE_OPCUA_MAX_CONNECTIONS
+#define BUFFER_SIZE CONFIG_NET_SAMPLE_OPCUA_BUFFER_SIZE
+
+/* Message header: type, chunk type and size */
+#define HEADER_LEN 8
+
+/* Smallest buffer a peer may announce, see OPC 10000-6 7.1.2.3 */
+#define MIN_BUFFER_SIZE 8192
+
+/* Milliseconds a WebSocket client may take to accept a message. The server
+ * thread serves every connection, so a stalled one must not hold it longer.
+ */
+#define SEND_TIMEOUT 1000
+
+#define LISTENERS (IS_ENABLED(CONFIG_NET_IPV4) + IS_ENABLED(CONFIG_NET_IPV6))
+#define WAKEUP_FDS IS_ENABLED(CONFIG_NET_SAMPLE_OPCUA_WAKEUP)
+
+static struct opcua_conn conns[MAX_CONNECTIONS];
+static uint8_t tx[BUFFER_SIZE];
+static uint32_t next_channel_id = 1;
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+/* WebSocket connections upgraded by the HTTP server, not yet served */
+K_MSGQ_DEFINE(adopted_socks, sizeof(int), MAX_CONNECTIONS, 4);
+#endif
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WAKEUP)
+/* Signalled by other threads when there is something for the server to do */
+static int wakeup_fd = -1;
+
+void opcua_server_wakeup(void)
+{
+    if (wakeup_fd >= 0) {
+        (void)zvfs_eventfd_write(wakeup_fd, 1);
+    }
+}
+
+static void wakeup_init(struct pollfd *pfd)
+{
+    wakeup_fd = zvfs_eventfd(0, ZVFS_EFD_NONBLOCK);
+    if (wakeup_fd < 0) {
+        LOG_ERR("Failed to create eventfd (%d)", -errno);
+    }
+
+    pfd->fd = wakeup_fd;
+}
+
+static void wakeup_clear(const struct pollfd *pfd)
+{
+    zvfs_eventfd_t val;
+
+    if (pfd->revents & POLLIN) {
+        (void)zvfs_eventfd_read(wakeup_fd, &val);
+    }
+}
+#endif
+
+static int sendall(int sock, const uint8_t *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t out_len = send(sock, buf, len, 0);
+
+        if (out_len < 0) {
+            return -errno;
+        }
+
+        buf += out_len;
+        len -= out_len;
+    }
+
+    return 0;
+}
+
+static void begin_message(struct opcua_buf *buf, const char *type, size_t limit)
+{
+    opcua_buf_init(buf, tx, MIN(limit, sizeof(tx)));
+    opcua_write_raw(buf, type, 4);
+    opcua_write_u32(buf, 0);
+}
+
+static int send_chunk(struct opcua_conn *conn, const struct opcua_buf *buf)
+{
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+    /* Every chunk is sent as one binary WebSocket message */
+    if (conn->websocket) {
+        int ret = websocket_send_msg(conn->sock, buf->data, buf->pos,
+                                     WEBSOCKET_OPCODE_DATA_BINARY, false, true,
+                                     SEND_TIMEOUT);
+
+        return ret < 0 ? ret : 0;
+    }
+#endif
+
+    return sendall(conn->sock, buf->data, buf->pos);
+}
+
+static int send_message(struct opcua_conn *conn, struct opcua_buf *buf)
+{
+    int ret;
+
+    if (buf->error) {
+        return -EMSGSIZE;
+    }
+
+    /* Nothing more is sent once a message could not be */
+    if (conn->send_failed) {
+        return -ENOTCONN;
+    }
+
+    opcua_patch_u32(buf, 4, buf->pos);
+
+    ret = send_chunk(conn, buf);
+    if (ret < 0) {
+        /* Closed by the server thread, the caller may still use conn */
+        conn->send_failed = true;
+    }
+
+    return ret;
+}
+
+static void send_error(struct opcua_conn *conn, uint32_t status, const char *reason)
+{
+    struct opcua_buf buf;
+
+    begin_message(&buf, "ERRF", sizeof(tx));
+    opcua_write_u32(&buf, status);
+    opcua_write_string(&buf, reason);
+
+    (void)send_message(conn, &buf);
+}
+
+void opcua_conn_response_begin(struct opcua_conn *conn, struct opcua_buf *buf)
+{
+    begin_message(buf, "MSGF", conn->send_size);
+    buf->pos = OPCUA_MSG_HEADER_LEN;
+}
+
+int opcua_conn_response_send(struct opcua_conn *conn, uint32_t request_id,
+                             struct opcua_buf *buf)
+{
+    size_t pos = buf->pos;
+
+    if (buf->error) {
+        return -EMSGSIZE;
+    }
+
+    buf->pos = HEADER_LEN;
+    opcua_write_u32(buf, conn->channel_id);
+    opcua_write_u32(buf, conn->token_id);
+    opcua_write_u32(buf, conn->send_seq++);
+    opcua_write_u32(buf, request_id);
+    buf->pos = pos;
+
+    return send_message(conn, buf);
+}
+
+static int handle_hello(struct opcua_conn *conn, struct opcua_buf *msg)
+{
+    struct opcua_string url;
+    struct opcua_buf buf;
+    uint32_t recv_size;
+    uint32_t send_size;
+
+    (void)opcua_read_u32(msg); /* ProtocolVersion */
+    recv_size = opcua_read_u32(msg);
+    send_size = opcua_read_u32(msg);
+    (void)opcua_read_u32(msg); /* MaxMessageSize */
+    (void)opcua_read_u32(msg); /* MaxChunkCount */
+    opcua_read_string(msg, &url);
+
+    if (msg->error || conn->hello) {
+        send_error(conn, OPCUA_BAD_TCP_MESSAGE_TYPE_INVALID, "Unexpected Hello");
+        return -EINVAL;
+    }
+
+    if (recv_size < MIN_BUFFER_SIZE || send_size < MIN_BUFFER_SIZE) {
+        send_error(conn, OPCUA_BAD_TCP_NOT_ENOUGH_RESOURCES, "Buffers too small");
+        return -EINVAL;
+    }
+
+    conn->hello = true;
+    conn->send_size = MIN(recv_size, BUFFER_SIZE);
+
+    memset(conn->endpoint_url, 0, sizeof(conn->endpoint_url));
+    if (url.len > 0) {
+        memcpy(conn->endpoint_url, url.data,
+               MIN((size_t)url.len, sizeof(conn->endpoint_url) - 1));
+    }
+
+    begin_message(&buf, "ACKF", sizeof(tx));
+    opcua_write_u32(&buf, 0);
+    opcua_write_u32(&buf, MIN(send_size, BUFFER_SIZE));
+    opcua_write_u32(&buf, conn->send_size);
+    /* Messages are never split into chunks */
+    opcua_write_u32(&buf, BUFFER_SIZE);
+    opcua_write_u32(&buf, 1);
+
+    return send_message(conn, &buf);
+}
+
+static int handle_open(struct opcua_conn *conn, struct opcua_buf *msg)
+{
+    struct opcua_request_header hdr;
+    struct opcua_nodeid type_id;
+    struct opcua_string policy;
+    struct opcua_buf buf;
+    uint32_t channel_id;
+    uint32_t request_id;
+    uint32_t request_type;
+    uint32_t security_mode;
+    uint32_t lifetime;
+
+    channel_id = opcua_read_u32(msg);
+    opcua_read_string(msg, &policy);
+    opcua_skip_string(msg); /* SenderCertificate */
+    opcua_skip_string(msg); /* ReceiverCertificateThumbprint */
+    (void)opcua_read_u32(msg); /* SequenceNumber */
+    request_id = opcua_read_u32(msg);
+
+    opcua_read_nodeid(msg, &type_id);
+    opcua_read_request_header(msg, &hdr);
+    (void)opcua_read_u32(msg); /* ClientProtocolVersion */
+    request_type = opcua_read_u32(msg);
+    security_mode = opcua_read_u32(msg);
+    opcua_skip_string(msg); /* ClientNonce */
+    lifetime = opcua_read_u32(msg);
+
+    if (msg->error || !conn->hello ||
+        type_id.numeric != OPCUA_ID_OPEN_SECURE_CHANNEL_REQUEST) {
+        send_error(conn, OPCUA_BAD_DECODING_ERROR, "Invalid OpenSecureChannel");
+        return -EINVAL;
+    }
+
+    if (!opcua_string_equal(&policy, OPCUA_SECURITY_POLICY_NONE)) {
+        send_error(conn, OPCUA_BAD_SECURITY_POLICY_REJECTED, "Only None is supported");
+        return -EINVAL;
+    }
+
+    if (security_mode != 1) {
+        send_error(conn, OPCUA_BAD_SECURITY_MODE_REJECTED, "Only None is supported");
+        return -EINVAL;
+    }
+
+    if (request_type == 0 && conn->channel_id == 0) {
+        conn->channel_id = next_channel_id++;
+        conn->send_seq = 1;
+    } else if (request_type != 1 || channel_id != conn->channel_id) {
+        send_error(conn, OPCUA_BAD_TCP_SECURE_CHANNEL_UNKNOWN, "Unknown channel");
+        return -EINVAL;
+    }
+
+    conn->token_id++;
+
+    begin_message(&buf, "OPNF", conn->send_size);
+    opcua_write_u32(&buf, conn->channel_id);
+    opcua_write_string(&buf, OPCUA_SECURITY_POLICY_NONE);
+    opcua_write_bytestring(&buf, NULL, 0);
+    opcua_write_bytestring(&buf, NULL, 0);
+    opcua_write_u32(&buf, conn->send_seq++);
+    opcua_write_u32(&buf, request_id);
+
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_OPEN_SECURE_CHANNEL_RESPONSE);
+    opcua_write_response_header(&buf, hdr.handle, OPCUA_GOOD);
+    opcua_write_u32(&buf, 0); /* ServerProtocolVersion */
+    opcua_write_u32(&buf, conn->channel_id);
+    opcua_write_u32(&buf, conn->token_id);
+    opcua_write_i64(&buf, opcua_datetime_now());
+    opcua_write_u32(&buf, lifetime);
+    opcua_write_bytestring(&buf, "", 0);
+
+    LOG_DBG("Secure channel %u token %u", conn->channel_id, conn->token_id);
+
+    return send_message(conn, &buf);
+}
+
+static int handle_msg(struct opcua_conn *conn, struct opcua_buf *msg)
+{
+    struct opcua_nodeid type_id;
+    uint32_t request_id;
+
+    if (opcua_read_u32(msg) != conn->channel_id || conn->channel_id == 0) {
+        send_error(conn, OPCUA_BAD_TCP_SECURE_CHANNEL_UNKNOWN, "Unknown channel");
+        return -EINVAL;
+    }
+
+    (void)opcua_read_u32(msg); /* TokenId */
+    (void)opcua_read_u32(msg); /* SequenceNumber */
+    request_id = opcua_read_u32(msg);
+    opcua_read_nodeid(msg, &type_id);
+
+    if (msg->error || type_id.type != OPCUA_NODEID_NUMERIC || type_id.ns != 0) {
+        send_error(conn, OPCUA_BAD_DECODING_ERROR, "Invalid message");
+        return -EINVAL;
+    }
+
+    return opcua_services_dispatch(conn, request_id, type_id.numeric, msg);
+}
+
+static int handle_message(struct opcua_conn *conn, uint8_t *data, size_t len)
+{
+    struct opcua_buf msg;
+
+    opcua_buf_init(&msg, data, len);
+    msg.pos = HEADER_LEN;
+
+    if (data[3] != 'F') {
+        /* Aborted chunks are dropped, intermediate ones are never negotiated */
+        if (data[3] == 'A') {
+            return 0;
+        }
+
+        send_error(conn, OPCUA_BAD_TCP_MESSAGE_TOO_LARGE, "Chunking not supported");
+        return -EMSGSIZE;
+    }
+
+    if (memcmp(data, "HEL", 3) == 0) {
+        return handle_hello(conn, &msg);
+    }
+
+    if (memcmp(data, "OPN", 3) == 0) {
+        return handle_open(conn, &msg);
+    }
+
+    if (memcmp(data, "MSG", 3) == 0) {
+        return handle_msg(conn, &msg);
+    }
+
+    if (memcmp(data, "CLO", 3) == 0) {
+        return -ECONNRESET;
+    }
+
+    send_error(conn, OPCUA_BAD_TCP_MESSAGE_TYPE_INVALID, "Unknown message type");
+    return -EINVAL;
+}
+
+/* Handle all complete messages in the receive buffer */
+static int conn_process(struct opcua_conn *conn)
+{
+    while (conn->rx_len >= HEADER_LEN) {
+        uint32_t size = sys_get_le32(&conn->rx[4]);
+        int ret;
+
+        if (size < HEADER_LEN || size > sizeof(conn->rx)) {
+            send_error(conn, OPCUA_BAD_TCP_MESSAGE_TOO_LARGE, "Message too large");
+            return -EMSGSIZE;
+        }
+
+        if (conn->rx_len < size) {
+            break;
+        }
+
+        ret = handle_message(conn, conn->rx, size);
+        if (ret < 0) {
+            return ret;
+        }
+
+        conn->rx_len -= size;
+        memmove(conn->rx, &conn->rx[size], conn->rx_len);
+    }
+
+    return 0;
+}
+
+static void conn_close(struct opcua_conn *conn)
+{
+    opcua_services_close(conn);
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+    if (conn->websocket) {
+        (void)websocket_unregister(conn->sock);
+        conn->sock = -1;
+        return;
+    }
+#endif
+    (void)close(conn->sock);
+    conn->sock = -1;
+}
+
+/* conn_receive() only closes a connection when its request failed, not when
+ * a publish response could not be sent
+ */
+static void conns_close_failed(void)
+{
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (conns[i].sock >= 0 && conns[i].send_failed) {
+            LOG_INF("[%d] Couldn't send OPC UA message, closing connection", i);
+            conn_close(&conns[i]);
+        }
+    }
+}
+
+static struct opcua_conn *conn_alloc(int sock)
+{
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (conns[i].sock < 0) {
+            memset(&conns[i], 0, sizeof(conns[i]));
+            conns[i].sock = sock;
+            return &conns[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void conn_accept(int listener)
+{
+    struct opcua_conn *conn;
+    int sock;
+
+    sock = accept(listener, NULL, NULL);
+    if (sock < 0) {
+        LOG_ERR("Accept failed (%d)", -errno);
+        return;
+    }
+
+    conn = conn_alloc(sock);
+    if (conn == NULL) {
+        LOG_WRN("Too many OPC UA connections");
+        (void)close(sock);
+        return;
+    }
+
+    LOG_INF("[%d] Accepted OPC UA connection", (int)(conn - conns));
+}
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+int opcua_server_adopt(int sock)
+{
+    if (k_msgq_put(&adopted_socks, &sock, K_NO_WAIT) < 0) {
+        return -ENOMEM;
+    }
+
+    opcua_server_wakeup();
+
+    return 0;
+}
+
+static bool websocket_active(void)
+{
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (conns[i].sock >= 0 && conns[i].websocket) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void conn_adopt(void)
+{
+    struct opcua_conn *conn;
+    int sock;
+
+    while (k_msgq_get(&adopted_socks, &sock, K_NO_WAIT) == 0) {
+        /*
+         * The HTTP server registers every WebSocket of a resource with the
+         * same receive buffer, so only one of them can be read safely.
+         */
+        if (websocket_active()) {
+            LOG_WRN("Only one OPC UA WebSocket connection is served at a time");
+            (void)websocket_unregister(sock);
+            continue;
+        }
+
+        conn = conn_alloc(sock);
+        if (conn == NULL) {
+            LOG_WRN("Too many OPC UA connections");
+            (void)websocket_unregister(sock);
+            continue;
+        }
+
+        conn->websocket = true;
+
+        LOG_INF("[%d] Accepted OPC UA WebSocket connection", (int)(conn - conns));
+    }
+}
+#endif
+
+static void conn_receive(struct opcua_conn *conn)
+{
+    ssize_t received;
+    int ret;
+
+    received = recv(conn->sock, &conn->rx[conn->rx_len],
+                    sizeof(conn->rx) - conn->rx_len, 0);
+    if (received <= 0) {
+        LOG_INF("[%d] OPC UA connection closed", (int)(conn - conns));
+        conn_close(conn);
+        return;
+    }
+
+    conn->rx_len += received;
+
+    ret = conn_process(conn);
+    if (ret < 0) {
+        LOG_INF("[%d] Closing OPC UA connection (%d)", (int)(conn - conns), ret);
+        conn_close(conn);
+    }
+}
+
+static int listen_on(int family, int *listener)
+{
+    struct sockaddr_storage addr = { 0 };
+    socklen_t addr_len;
+    int opt = 1;
+    int sock;
+
+    if (family == AF_INET) {
+        struct sockaddr_in *addr4 = (struct sockaddr_in *)&addr;
+
+        addr4->sin_family = AF_INET;
+        addr4->sin_port = htons(CONFIG_NET_SAMPLE_OPCUA_PORT);
+        addr_len = sizeof(*addr4);
+    } else {
+        struct sockaddr_in6 *addr6 = (struct sockaddr_in6 *)&addr;
+
+        addr6->sin6_family = AF_INET6;
+        addr6->sin6_port = htons(CONFIG_NET_SAMPLE_OPCUA_PORT);
+        addr_len = sizeof(*addr6);
+    }
+
+    sock = socket(family, SOCK_STREAM, IPPROTO_TCP);
+    if (sock < 0) {
+        return -errno;
+    }
+
+    (void)setsockopt(sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+
+    if (family == AF_INET6) {
+        /* IPv4 has a listener of its own */
+        (void)setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, &opt, sizeof(opt));
+    }
+
+    if (bind(sock, (struct sockaddr *)&addr, addr_len) < 0 ||
+        listen(sock, MAX_CONNECTIONS) < 0) {
+        int ret = -errno;
+
+        (void)close(sock);
+        return ret;
+    }
+
+    *listener = sock;
+
+    return 0;
+}
+
+static void opcua_server_thread(void *p1, void *p2, void *p3)
+{
+    struct pollfd fds[LISTENERS + MAX_CONNECTIONS + WAKEUP_FDS];
+    int listeners = 0;
+    int timeout = -1;
+    int ret;
+
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    opcua_nodes_init();
+
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        conns[i].sock = -1;
+    }
+
+    if (IS_ENABLED(CONFIG_NET_IPV4)) {
+        ret = listen_on(AF_INET, &fds[listeners].fd);
+        if (ret < 0) {
+            LOG_ERR("Failed to listen on IPv4 (%d)", ret);
+        } else {
+            listeners++;
+        }
+    }
+
+    if (IS_ENABLED(CONFIG_NET_IPV6)) {
+        ret = listen_on(AF_INET6, &fds[listeners].fd);
+        if (ret < 0) {
+            LOG_ERR("Failed to listen on IPv6 (%d)", ret);
+        } else {
+            listeners++;
+        }
+    }
+
+    if (listeners == 0) {
+        return;
+    }
+
+    LOG_INF("OPC UA server listening on port %d", CONFIG_NET_SAMPLE_OPCUA_PORT);
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WAKEUP)
+    wakeup_init(&fds[listeners + MAX_CONNECTIONS]);
+#endif
+
+    while (true) {
+        for (int i = 0; i < listeners + MAX_CONNECTIONS + WAKEUP_FDS; i++) {
+            fds[i].events = POLLIN;
+            fds[i].revents = 0;
+        }
+
+        for (int i = 0; i < MAX_CONNECTIONS; i++) {
+            fds[listeners + i].fd = conns[i].sock;
+        }
+
+        ret = poll(fds, listeners + MAX_CONNECTIONS + WAKEUP_FDS, timeout);
+        if (ret < 0) {
+            LOG_ERR("Poll failed (%d)", -errno);
+            k_sleep(K_MSEC(100));
+            continue;
+        }
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WAKEUP)
+        wakeup_clear(&fds[listeners + MAX_CONNECTIONS]);
+#endif
+
+        for (int i = 0; i < MAX_CONNECTIONS; i++) {
+            if (conns[i].sock >= 0 && fds[listeners + i].revents != 0) {
+                conn_receive(&conns[i]);
+            }
+        }
+
+        for (int i = 0; i < listeners; i++) {
+            if (fds[i].revents & POLLIN) {
+                conn_accept(fds[i].fd);
+            }
+        }
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET)
+        conn_adopt();
+#endif
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_SUBSCRIPTIONS)
+        /* Requests may have changed what is due, so always ask again */
+        timeout = opcua_subscriptions_process();
+#endif
+
+        conns_close_failed();
+    }
+}
+
+K_THREAD_DEFINE(opcua_server, STACK_SIZE, opcua_server_thread, NULL, NULL, NULL,
+                THREAD_PRIORITY, 0, 0);
@@ -0,0 +1,160 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef OPCUA_SERVER_H
+#define OPCUA_SERVER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "OpcUaBinary.h"
+
+#define OPCUA_SECURITY_POLICY_NONE "http://opcfoundation.org/UA/SecurityPolicy#None"
+#define OPCUA_TRANSPORT_PROFILE_BINARY \
+    "http://opcfoundation.org/UA-Profile/Transport/uatcp-uasc-uabinary"
+
+#define OPCUA_ENDPOINT_URL_LEN 96
+
+/* Size of the MSG chunk headers in front of every response body */
+#define OPCUA_MSG_HEADER_LEN 24
+
+/* Publish requests a session can queue, and acknowledgements per request */
+#define OPCUA_MAX_PUBLISH_REQUESTS 4
+#define OPCUA_MAX_ACKNOWLEDGEMENTS 8
+
+/**
+ * @brief A Publish request waiting for notifications to send
+ *
+ * Acknowledgements are processed on arrival, their results are kept until
+ * the response is sent.
+ */
+struct opcua_publish_request {
+    uint32_t request_id;
+    uint32_t handle;
+    /** Uptime in milliseconds when the request times out, 0 for never */
+    int64_t deadline;
+    uint8_t ack_count;
+    uint32_t ack_results[OPCUA_MAX_ACKNOWLEDGEMENTS];
+};
+
+struct opcua_session {
+    bool created;
+    bool activated;
+    uint32_t id;
+    uint8_t token[16];
+    /** Oldest first */
+    uint8_t publish_count;
+    struct opcua_publish_request publish[OPCUA_MAX_PUBLISH_REQUESTS];
+};
+
+/**
+ * @brief A client connection with its secure channel and session
+ *
+ * Only SecurityPolicy None is offered, and every message has to fit in a
+ * single chunk, so a connection needs one receive buffer and no other
+ * per-message state. Each secure channel carries at most one session.
+ */
+struct opcua_conn {
+    int sock;
+    /** Upgraded by the HTTP server, every chunk is a WebSocket message */
+    bool websocket;
+    /** A send failed, the server thread closes the connection */
+    bool send_failed;
+    bool hello;
+    uint32_t channel_id;
+    uint32_t token_id;
+    uint32_t send_seq;
+    /** Largest chunk the client accepts */
+    uint32_t send_size;
+    size_t rx_len;
+    struct opcua_session session;
+    char endpoint_url[OPCUA_ENDPOINT_URL_LEN];
+    uint8_t rx[CONFIG_NET_SAMPLE_OPCUA_BUFFER_SIZE];
+};
+
+/**
+ * @brief Start a response on @p conn
+ *
+ * All connections share one transmit buffer, which is only used from the
+ * server thread. @p buf is positioned after the message header.
+ */
+void opcua_conn_response_begin(struct opcua_conn *conn, struct opcua_buf *buf);
+
+/**
+ * @brief Send a response started with opcua_conn_response_begin()
+ *
+ * @return 0 on success, or a negative error code if the connection failed
+ */
+int opcua_conn_response_send(struct opcua_conn *conn, uint32_t request_id,
+                             struct opcua_buf *buf);
+
+/**
+ * @brief Wake the server thread
+ *
+ * It then serves adopted connections and runs opcua_subscriptions_process().
+ * Can be called from any thread.
+ */
+void opcua_server_wakeup(void);
+
+/**
+ * @brief Hand a WebSocket connection over to the server thread
+ *
+ * @param sock WebSocket registered by the HTTP server after the upgrade
+ *
+ * @return 0, or -ENOMEM if too many connections are waiting already
+ */
+int opcua_server_adopt(int sock);
+
+/** Send a ServiceFault for a request */
+int opcua_send_fault(struct opcua_conn *conn, uint32_t request_id, uint32_t handle,
+                     uint32_t status);
+
+/** Send a response, or a fault if it did not fit */
+int opcua_send_response(struct opcua_conn *conn, uint32_t request_id, uint32_t handle,
+                        struct opcua_buf *buf);
+
+/**
+ * @brief Handle a service request received on a secure channel
+ *
+ * @param type_id Binary encoding id of the request
+ * @param req The request, starting with its RequestHeader
+ *
+ * @return 0, or a negative error code if the connection has to be closed
+ */
+int opcua_services_dispatch(struct opcua_conn *conn, uint32_t request_id,
+                            uint32_t type_id, struct opcua_buf *req);
+
+/** Release what the services hold for a connection that is closed */
+void opcua_services_close(struct opcua_conn *conn);
+
+/**
+ * @brief Handle a subscription service request of an activated session
+ *
+ * Publish requests are queued and answered once there is something to
+ * publish.
+ *
+ * @return 0, a negative error code if the connection has to be closed, or
+ *         -ENOTSUP if @p type_id is not a subscription service
+ */
+int opcua_subscriptions_dispatch(struct opcua_conn *conn, uint32_t request_id,
+                                 uint32_t type_id, const struct opcua_request_header *hdr,
+                                 struct opcua_buf *req);
+
+/**
+ * @brief Sample monitored items and publish notifications that are due
+ *
+ * Called from the server thread whenever it wakes up.
+ *
+ * @return Milliseconds until the next call is due, or -1 if there is no
+ *         subscription
+ */
+int opcua_subscriptions_process(void);
+
+/** Delete the subscriptions and Publish requests of a closed session */
+void opcua_subscriptions_close(struct opcua_conn *conn);
+
+#endif /* OPCUA_SERVER_H */
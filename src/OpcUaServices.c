@@ -0,0 +1,686 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/random/random.h>
+#include <zephyr/logging/log.h>
+
+#include "OpcUaNodes.h"
+#include "OpcUaServer.h"
+
+LOG_MODULE_DECLARE(opcua, CONFIG_NET_SAMPLE_LOG_LEVEL);
+
+/* Operations per Read or Browse request */
+#define MAX_OPERATIONS 64
+
+#define NONCE_LEN 32
+
+#define SESSION_TIMEOUT_MIN 10000.0
+#define SESSION_TIMEOUT_MAX 3600000.0
+
+enum browse_direction {
+    BROWSE_FORWARD,
+    BROWSE_INVERSE,
+    BROWSE_BOTH,
+};
+
+/* ReferenceDescription fields selected by the result mask */
+#define RESULT_REFERENCE_TYPE   0x01
+#define RESULT_IS_FORWARD       0x02
+#define RESULT_NODE_CLASS       0x04
+#define RESULT_BROWSE_NAME      0x08
+#define RESULT_DISPLAY_NAME     0x10
+#define RESULT_TYPE_DEFINITION  0x20
+
+/**
+ * Everything needed to continue a browse is carried in the continuation
+ * point itself, so the server keeps no state between Browse and BrowseNext.
+ */
+struct browse {
+    const struct opcua_node *node;
+    uint32_t cursor;
+    uint32_t direction;
+    uint32_t reference_type;
+    bool subtypes;
+    uint32_t node_class_mask;
+    uint32_t result_mask;
+    uint32_t max_references;
+};
+
+#define CONTINUATION_POINT_LEN 27
+
+static struct opcua_snapshot snapshot;
+
+static void write_fault(struct opcua_buf *buf, uint32_t handle, uint32_t status)
+{
+    opcua_write_numeric_nodeid(buf, 0, OPCUA_ID_SERVICE_FAULT);
+    opcua_write_response_header(buf, handle, status);
+}
+
+int opcua_send_fault(struct opcua_conn *conn, uint32_t request_id, uint32_t handle,
+                     uint32_t status)
+{
+    struct opcua_buf buf;
+
+    opcua_conn_response_begin(conn, &buf);
+    write_fault(&buf, handle, status);
+
+    return opcua_conn_response_send(conn, request_id, &buf);
+}
+
+int opcua_send_response(struct opcua_conn *conn, uint32_t request_id, uint32_t handle,
+                        struct opcua_buf *buf)
+{
+    if (buf->error) {
+        return opcua_send_fault(conn, request_id, handle, OPCUA_BAD_RESPONSE_TOO_LARGE);
+    }
+
+    return opcua_conn_response_send(conn, request_id, buf);
+}
+
+static void write_application_description(struct opcua_buf *buf, const struct opcua_conn *conn)
+{
+    opcua_write_string(buf, OPCUA_APPLICATION_URI);
+    opcua_write_string(buf, OPCUA_PRODUCT_URI);
+    opcua_write_localized_text(buf, "Induction OPC UA Server");
+    opcua_write_i32(buf, 0); /* Server */
+    opcua_write_string(buf, NULL);
+    opcua_write_string(buf, NULL);
+    opcua_write_i32(buf, 1);
+    opcua_write_string(buf, conn->endpoint_url);
+}
+
+/* The HTTP server sends the 101 response before the upgrade callback runs
+ * and cannot select the opcua+uacp subprotocol in it, which clients that
+ * offer it have to reject. So the WebSocket transport is not advertised,
+ * a client connected over it sees no endpoints.
+ */
+static void write_endpoints(struct opcua_buf *buf, const struct opcua_conn *conn)
+{
+    if (conn->websocket) {
+        opcua_write_i32(buf, 0);
+        return;
+    }
+
+    opcua_write_i32(buf, 1);
+    opcua_write_string(buf, conn->endpoint_url);
+    write_application_description(buf, conn);
+    opcua_write_bytestring(buf, NULL, 0);   /* ServerCertificate */
+    opcua_write_i32(buf, 1);                /* MessageSecurityMode None */
+    opcua_write_string(buf, OPCUA_SECURITY_POLICY_NONE);
+    opcua_write_i32(buf, 1);                /* UserIdentityTokens */
+    opcua_write_string(buf, "anonymous");
+    opcua_write_i32(buf, 0);                /* Anonymous */
+    opcua_write_string(buf, NULL);
+    opcua_write_string(buf, NULL);
+    opcua_write_string(buf, NULL);
+    opcua_write_string(buf, OPCUA_TRANSPORT_PROFILE_BINARY);
+    opcua_write_u8(buf, 0);                 /* SecurityLevel */
+}
+
+static void write_nonce(struct opcua_buf *buf)
+{
+    uint8_t nonce[NONCE_LEN];
+
+    sys_rand_get(nonce, sizeof(nonce));
+    opcua_write_bytestring(buf, nonce, sizeof(nonce));
+}
+
+static int get_endpoints(struct opcua_conn *conn, uint32_t request_id,
+                         const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+
+    opcua_skip_string(req);         /* EndpointUrl */
+    opcua_skip_string_array(req);   /* LocaleIds */
+    opcua_skip_string_array(req);   /* ProfileUris */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_GET_ENDPOINTS_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    write_endpoints(&buf, conn);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static int find_servers(struct opcua_conn *conn, uint32_t request_id,
+                        const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+
+    opcua_skip_string(req);         /* EndpointUrl */
+    opcua_skip_string_array(req);   /* LocaleIds */
+    opcua_skip_string_array(req);   /* ServerUris */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_FIND_SERVERS_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_i32(&buf, 1);
+    write_application_description(&buf, conn);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static void write_session_token(struct opcua_buf *buf, const struct opcua_session *session)
+{
+    struct opcua_nodeid token = { .type = OPCUA_NODEID_GUID };
+
+    memcpy(token.guid, session->token, sizeof(token.guid));
+    opcua_write_nodeid(buf, &token);
+}
+
+static int create_session(struct opcua_conn *conn, uint32_t request_id,
+                          const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_session *session = &conn->session;
+    struct opcua_buf buf;
+    double timeout;
+
+    opcua_skip_application_description(req);
+    opcua_skip_string(req);     /* ServerUri */
+    opcua_skip_string(req);     /* EndpointUrl */
+    opcua_skip_string(req);     /* SessionName */
+    opcua_skip_string(req);     /* ClientNonce */
+    opcua_skip_string(req);     /* ClientCertificate */
+    timeout = opcua_read_double(req);
+    (void)opcua_read_u32(req);  /* MaxResponseMessageSize */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    /* A new session replaces the one on this channel */
+    opcua_services_close(conn);
+
+    session->created = true;
+    session->activated = false;
+    session->id = sys_rand32_get();
+    sys_rand_get(session->token, sizeof(session->token));
+
+    timeout = CLAMP(timeout, SESSION_TIMEOUT_MIN, SESSION_TIMEOUT_MAX);
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_CREATE_SESSION_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_numeric_nodeid(&buf, 1, session->id);
+    write_session_token(&buf, session);
+    opcua_write_double(&buf, timeout);
+    write_nonce(&buf);
+    opcua_write_bytestring(&buf, NULL, 0);  /* ServerCertificate */
+    write_endpoints(&buf, conn);
+    opcua_write_i32(&buf, 0);               /* ServerSoftwareCertificates */
+    opcua_write_string(&buf, NULL);         /* ServerSignature */
+    opcua_write_bytestring(&buf, NULL, 0);
+    opcua_write_u32(&buf, CONFIG_NET_SAMPLE_OPCUA_BUFFER_SIZE);
+
+    LOG_INF("Created session %u", session->id);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static bool session_token_valid(const struct opcua_session *session,
+                                const struct opcua_request_header *hdr)
+{
+    return session->created && hdr->auth_token.type == OPCUA_NODEID_GUID &&
+           hdr->auth_token.ns == 0 &&
+           memcmp(hdr->auth_token.guid, session->token, sizeof(session->token)) == 0;
+}
+
+static int activate_session(struct opcua_conn *conn, uint32_t request_id,
+                            const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_nodeid token_type;
+    struct opcua_buf buf;
+    int32_t count;
+    uint8_t encoding;
+
+    opcua_skip_string(req);     /* ClientSignature */
+    opcua_skip_string(req);
+    count = opcua_read_array_len(req);
+    for (int32_t i = 0; i < count && !req->error; i++) {
+        opcua_skip_string(req); /* SignedSoftwareCertificate */
+        opcua_skip_string(req);
+    }
+    opcua_skip_string_array(req);   /* LocaleIds */
+    opcua_read_nodeid(req, &token_type);
+    encoding = opcua_read_u8(req);
+    if (encoding != 0) {
+        opcua_skip_string(req);
+    }
+    opcua_skip_string(req);     /* UserTokenSignature */
+    opcua_skip_string(req);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (!session_token_valid(&conn->session, hdr)) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_SESSION_ID_INVALID);
+    }
+
+    /* Only anonymous users, an empty token means anonymous as well */
+    if (!(encoding == 0 && token_type.numeric == 0) &&
+        token_type.numeric != OPCUA_ID_ANONYMOUS_IDENTITY_TOKEN) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_IDENTITY_TOKEN_INVALID);
+    }
+
+    conn->session.activated = true;
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_ACTIVATE_SESSION_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    write_nonce(&buf);
+    opcua_write_i32(&buf, 0);   /* Results */
+    opcua_write_i32(&buf, 0);   /* DiagnosticInfos */
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static int close_session(struct opcua_conn *conn, uint32_t request_id,
+                         const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+
+    (void)opcua_read_u8(req);   /* DeleteSubscriptions */
+
+    if (!session_token_valid(&conn->session, hdr)) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_SESSION_ID_INVALID);
+    }
+
+    LOG_INF("Closed session %u", conn->session.id);
+    opcua_services_close(conn);
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_CLOSE_SESSION_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static int read_values(struct opcua_conn *conn, uint32_t request_id,
+                       const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+    uint32_t timestamps;
+    int32_t count;
+
+    (void)opcua_read_double(req);   /* MaxAge, values are always current */
+    timestamps = opcua_read_u32(req);
+    count = opcua_read_array_len(req);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (timestamps > OPCUA_TIMESTAMPS_NEITHER) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_TIMESTAMPS_TO_RETURN_INVALID);
+    }
+
+    if (count == 0) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_NOTHING_TO_DO);
+    }
+
+    if (count > MAX_OPERATIONS) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_TOO_MANY_OPERATIONS);
+    }
+
+    /* All values of one request come from the same snapshot */
+    opcua_snapshot_take(&snapshot);
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_READ_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_i32(&buf, count);
+
+    for (int32_t i = 0; i < count && !req->error; i++) {
+        const struct opcua_node *node;
+        struct opcua_variant val = { 0 };
+        struct opcua_nodeid id;
+        struct opcua_string range;
+        uint32_t attribute;
+        uint32_t status;
+
+        opcua_read_nodeid(req, &id);
+        attribute = opcua_read_u32(req);
+        opcua_read_string(req, &range);
+        opcua_skip_qualified_name(req); /* DataEncoding */
+
+        node = opcua_node_find(&id);
+        if (node == NULL) {
+            status = OPCUA_BAD_NODE_ID_UNKNOWN;
+        } else if (range.len > 0) {
+            status = OPCUA_BAD_INDEX_RANGE_INVALID;
+        } else {
+            status = opcua_node_read(node, attribute, &snapshot, &val);
+        }
+
+        opcua_write_data_value(&buf, status, &val, timestamps, attribute == OPCUA_ATTR_VALUE,
+                               snapshot.now);
+    }
+
+    opcua_write_i32(&buf, 0);   /* DiagnosticInfos */
+
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static void write_reference(struct opcua_buf *buf, const struct opcua_reference *ref,
+                            uint32_t mask)
+{
+    const struct opcua_node *target = ref->target;
+
+    opcua_write_numeric_nodeid(buf, 0, mask & RESULT_REFERENCE_TYPE ? ref->type : 0);
+    opcua_write_u8(buf, (mask & RESULT_IS_FORWARD) && ref->forward);
+    opcua_write_numeric_nodeid(buf, target->ns, target->id);
+    opcua_write_qualified_name(buf, target->ns,
+                               mask & RESULT_BROWSE_NAME ? target->name : NULL);
+    opcua_write_localized_text(buf, mask & RESULT_DISPLAY_NAME ? target->name : NULL);
+    opcua_write_i32(buf, mask & RESULT_NODE_CLASS ? target->node_class : 0);
+    opcua_write_numeric_nodeid(buf, 0, mask & RESULT_TYPE_DEFINITION ?
+                                       target->type_definition : 0);
+}
+
+static bool reference_selected(const struct browse *browse, const struct opcua_reference *ref)
+{
+    if ((browse->direction == BROWSE_FORWARD && !ref->forward) ||
+        (browse->direction == BROWSE_INVERSE && ref->forward)) {
+        return false;
+    }
+
+    if (browse->node_class_mask != 0 &&
+        (browse->node_class_mask & ref->target->node_class) == 0) {
+        return false;
+    }
+
+    return opcua_reference_matches(browse->reference_type, ref->type, browse->subtypes);
+}
+
+static void write_continuation_point(struct opcua_buf *buf, const struct browse *browse)
+{
+    opcua_write_i32(buf, CONTINUATION_POINT_LEN);
+    opcua_write_u8(buf, browse->node->ns);
+    opcua_write_u32(buf, browse->node->id);
+    opcua_write_u32(buf, browse->cursor);
+    opcua_write_u8(buf, browse->direction);
+    opcua_write_u32(buf, browse->reference_type);
+    opcua_write_u8(buf, browse->subtypes);
+    opcua_write_u32(buf, browse->node_class_mask);
+    opcua_write_u32(buf, browse->result_mask);
+    opcua_write_u32(buf, browse->max_references);
+}
+
+static uint32_t read_continuation_point(const struct opcua_string *point, struct browse *browse)
+{
+    struct opcua_nodeid id = { 0 };
+    struct opcua_buf buf;
+
+    if (point->len != CONTINUATION_POINT_LEN) {
+        return OPCUA_BAD_CONTINUATION_POINT_INVALID;
+    }
+
+    opcua_buf_init(&buf, (uint8_t *)point->data, point->len);
+    id.ns = opcua_read_u8(&buf);
+    id.numeric = opcua_read_u32(&buf);
+    browse->cursor = opcua_read_u32(&buf);
+    browse->direction = opcua_read_u8(&buf);
+    browse->reference_type = opcua_read_u32(&buf);
+    browse->subtypes = opcua_read_u8(&buf) != 0;
+    browse->node_class_mask = opcua_read_u32(&buf);
+    browse->result_mask = opcua_read_u32(&buf);
+    browse->max_references = opcua_read_u32(&buf);
+
+    browse->node = opcua_node_find(&id);
+    if (buf.error || browse->node == NULL) {
+        return OPCUA_BAD_CONTINUATION_POINT_INVALID;
+    }
+
+    return OPCUA_GOOD;
+}
+
+/* Write one BrowseResult, starting at browse->cursor */
+static void write_browse_result(struct opcua_buf *buf, const struct browse *browse)
+{
+    struct opcua_reference ref;
+    uint32_t cursor = browse->cursor;
+    uint32_t end = cursor;
+    uint32_t count = 0;
+    bool more = false;
+
+    /* Count what fits first, the continuation point precedes the references */
+    while (opcua_node_next_reference(browse->node, &cursor, &ref)) {
+        if (!reference_selected(browse, &ref)) {
+            continue;
+        }
+
+        if (browse->max_references != 0 && count == browse->max_references) {
+            more = true;
+            break;
+        }
+
+        count++;
+        end = cursor;
+    }
+
+    opcua_write_u32(buf, OPCUA_GOOD);
+
+    if (more) {
+        struct browse next = *browse;
+
+        next.cursor = end;
+        write_continuation_point(buf, &next);
+    } else {
+        opcua_write_bytestring(buf, NULL, 0);
+    }
+
+    opcua_write_i32(buf, count);
+
+    cursor = browse->cursor;
+    for (uint32_t i = 0; i < count && opcua_node_next_reference(browse->node, &cursor, &ref);) {
+        if (reference_selected(browse, &ref)) {
+            write_reference(buf, &ref, browse->result_mask);
+            i++;
+        }
+    }
+}
+
+static void write_browse_error(struct opcua_buf *buf, uint32_t status)
+{
+    opcua_write_u32(buf, status);
+    opcua_write_bytestring(buf, NULL, 0);
+    opcua_write_i32(buf, 0);
+}
+
+static int browse_nodes(struct opcua_conn *conn, uint32_t request_id,
+                        const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_nodeid view;
+    struct opcua_buf buf;
+    uint32_t max_references;
+    int32_t count;
+
+    opcua_read_nodeid(req, &view);  /* Views are not supported, only the default */
+    opcua_skip(req, 8 + 4);         /* Timestamp, ViewVersion */
+    max_references = opcua_read_u32(req);
+    count = opcua_read_array_len(req);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (count == 0) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_NOTHING_TO_DO);
+    }
+
+    if (count > MAX_OPERATIONS) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_TOO_MANY_OPERATIONS);
+    }
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_BROWSE_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_i32(&buf, count);
+
+    for (int32_t i = 0; i < count && !req->error; i++) {
+        struct browse browse = { .max_references = max_references };
+        struct opcua_nodeid id;
+        struct opcua_nodeid reference_type;
+
+        opcua_read_nodeid(req, &id);
+        browse.direction = opcua_read_u32(req);
+        opcua_read_nodeid(req, &reference_type);
+        browse.subtypes = opcua_read_u8(req) != 0;
+        browse.node_class_mask = opcua_read_u32(req);
+        browse.result_mask = opcua_read_u32(req);
+        browse.reference_type = reference_type.numeric;
+        browse.node = opcua_node_find(&id);
+
+        if (browse.node == NULL) {
+            write_browse_error(&buf, OPCUA_BAD_NODE_ID_UNKNOWN);
+        } else if (browse.direction > BROWSE_BOTH) {
+            write_browse_error(&buf, OPCUA_BAD_BROWSE_DIRECTION_INVALID);
+        } else if (reference_type.type != OPCUA_NODEID_NUMERIC || reference_type.ns != 0 ||
+                   !opcua_reference_known(reference_type.numeric)) {
+            write_browse_error(&buf, OPCUA_BAD_REFERENCE_TYPE_ID_INVALID);
+        } else {
+            write_browse_result(&buf, &browse);
+        }
+    }
+
+    opcua_write_i32(&buf, 0);   /* DiagnosticInfos */
+
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static int browse_next(struct opcua_conn *conn, uint32_t request_id,
+                       const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+    bool release;
+    int32_t count;
+
+    release = opcua_read_u8(req) != 0;
+    count = opcua_read_array_len(req);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (count == 0) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_NOTHING_TO_DO);
+    }
+
+    if (count > MAX_OPERATIONS) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_TOO_MANY_OPERATIONS);
+    }
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_BROWSE_NEXT_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_i32(&buf, count);
+
+    for (int32_t i = 0; i < count && !req->error; i++) {
+        struct opcua_string point;
+        struct browse browse;
+        uint32_t status;
+
+        opcua_read_string(req, &point);
+        status = read_continuation_point(&point, &browse);
+
+        if (status != OPCUA_GOOD) {
+            write_browse_error(&buf, status);
+        } else if (release) {
+            /* Nothing is held for a continuation point */
+            write_browse_error(&buf, OPCUA_GOOD);
+        } else {
+            write_browse_result(&buf, &browse);
+        }
+    }
+
+    opcua_write_i32(&buf, 0);   /* DiagnosticInfos */
+
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+int opcua_services_dispatch(struct opcua_conn *conn, uint32_t request_id,
+                            uint32_t type_id, struct opcua_buf *req)
+{
+    struct opcua_request_header hdr;
+
+    opcua_read_request_header(req, &hdr);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, 0, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    switch (type_id) {
+    case OPCUA_ID_GET_ENDPOINTS_REQUEST:
+        return get_endpoints(conn, request_id, &hdr, req);
+    case OPCUA_ID_FIND_SERVERS_REQUEST:
+        return find_servers(conn, request_id, &hdr, req);
+    case OPCUA_ID_CREATE_SESSION_REQUEST:
+        return create_session(conn, request_id, &hdr, req);
+    case OPCUA_ID_ACTIVATE_SESSION_REQUEST:
+        return activate_session(conn, request_id, &hdr, req);
+    case OPCUA_ID_CLOSE_SESSION_REQUEST:
+        return close_session(conn, request_id, &hdr, req);
+    default:
+        break;
+    }
+
+    /* Everything else needs an activated session */
+    if (!session_token_valid(&conn->session, &hdr)) {
+        return opcua_send_fault(conn, request_id, hdr.handle, OPCUA_BAD_SESSION_ID_INVALID);
+    }
+
+    if (!conn->session.activated) {
+        return opcua_send_fault(conn, request_id, hdr.handle, OPCUA_BAD_SESSION_NOT_ACTIVATED);
+    }
+
+    switch (type_id) {
+    case OPCUA_ID_READ_REQUEST:
+        return read_values(conn, request_id, &hdr, req);
+    case OPCUA_ID_BROWSE_REQUEST:
+        return browse_nodes(conn, request_id, &hdr, req);
+    case OPCUA_ID_BROWSE_NEXT_REQUEST:
+        return browse_next(conn, request_id, &hdr, req);
+    default:
+        break;
+    }
+
+#if defined(CONFIG_NET_SAMPLE_OPCUA_SUBSCRIPTIONS)
+    int ret = opcua_subscriptions_dispatch(conn, request_id, type_id, &hdr, req);
+
+    if (ret != -ENOTSUP) {
+        return ret;
+    }
+#endif
+
+    LOG_DBG("Unsupported service %u", type_id);
+    return opcua_send_fault(conn, request_id, hdr.handle, OPCUA_BAD_SERVICE_UNSUPPORTED);
+}
+
+void opcua_services_close(struct opcua_conn *conn)
+{
+#if defined(CONFIG_NET_SAMPLE_OPCUA_SUBSCRIPTIONS)
+    opcua_subscriptions_close(conn);
+#endif
+    memset(&conn->session, 0, sizeof(conn->session));
+}
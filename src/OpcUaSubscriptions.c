@@ -0,0 +1,1296 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/dlist.h>
+#include <zephyr/logging/log.h>
+
+#include "TagDb.h"
+#include "OpcUaNodes.h"
+#include "OpcUaServer.h"
+
+LOG_MODULE_DECLARE(opcua, CONFIG_NET_SAMPLE_LOG_LEVEL);
+
+#define MAX_SUBSCRIPTIONS CONFIG_NET_SAMPLE_OPCUA_MAX_SUBSCRIPTIONS
+#define MAX_ITEMS CONFIG_NET_SAMPLE_OPCUA_MAX_MONITORED_ITEMS
+
+/* Sampling and publishing intervals are multiples of one tick */
+#define TICK_MS CONFIG_NET_SAMPLE_OPCUA_SAMPLING_INTERVAL
+#define MAX_INTERVAL_MS (3600 * MSEC_PER_SEC)
+
+#define DEFAULT_KEEPALIVE 10
+#define MAX_KEEPALIVE 1000
+#define MAX_LIFETIME 100000
+
+/* Operations per request */
+#define MAX_OPERATIONS 64
+
+/* Room left in a PublishResponse for what follows the notifications */
+#define PUBLISH_TRAILER_LEN (16 + 4 * OPCUA_MAX_ACKNOWLEDGEMENTS)
+
+enum monitoring_mode {
+    MODE_DISABLED,
+    MODE_SAMPLING,
+    MODE_REPORTING,
+};
+
+struct subscription {
+    /** Owner, NULL for a free entry */
+    struct opcua_conn *conn;
+    uint32_t id;
+    uint32_t interval;
+    uint32_t max_keepalive;
+    uint32_t lifetime;
+    uint32_t max_notifications;
+    uint32_t keepalive_counter;
+    uint32_t lifetime_counter;
+    /** Sequence number of the next NotificationMessage */
+    uint32_t seq;
+    int64_t next_publish;
+    bool enabled;
+    /** A publishing interval passed without a Publish request to answer */
+    bool late;
+    /** Items with a sampled value that has not been published */
+    sys_dlist_t notify;
+};
+
+/**
+ * @brief A monitored item, with a queue of one value
+ *
+ * An item is only visited when the value it watches changed, when it is
+ * due for sampling after such a change, and when its value is published.
+ */
+struct monitored_item {
+    /** In watchers[], while the item is enabled */
+    sys_dnode_t watch;
+    /** In pending, until the value is sampled */
+    sys_dnode_t pending;
+    /** In subscription::notify, until the value is published */
+    sys_dnode_t queued;
+    /** Owner, NULL for a free entry */
+    struct subscription *sub;
+    const struct opcua_node *node;
+    uint32_t id;
+    uint32_t client_handle;
+    uint32_t attribute;
+    uint32_t interval;
+    int64_t next_sample;
+    uint8_t mode;
+    uint8_t timestamps;
+    bool unreported;
+    struct opcua_sample sample;
+};
+
+static struct subscription subscriptions[MAX_SUBSCRIPTIONS];
+static struct monitored_item items[MAX_ITEMS];
+static uint32_t next_subscription_id = 1;
+static uint32_t next_item_id = 1;
+static size_t next_late;
+static int subscription_count;
+
+/* Enabled items, by the bit of the change mask they watch */
+static sys_dlist_t watchers[32];
+static sys_dlist_t pending;
+
+/* Bits with watchers, changes of other values do not wake the server */
+static atomic_t watched;
+
+static struct opcua_snapshot snapshot;
+static int64_t last_pass;
+static bool initialized;
+
+/* Only called for the first change of a tag since the last pass */
+static void tags_changed(struct tag_listener *listener, uint32_t tags)
+{
+    ARG_UNUSED(listener);
+
+    if (tags & (uint32_t)atomic_get(&watched)) {
+        opcua_server_wakeup();
+    }
+}
+
+/* Its dirty bits are cleared when the snapshot is updated */
+static struct tag_listener tag_listener = {
+    .tags = OPCUA_CHANGE_CONFIG_ALL | OPCUA_CHANGE_STATS_ALL,
+    .notify = tags_changed,
+};
+
+/* Changed values that have watchers */
+static uint32_t watched_changes(void)
+{
+    return (uint32_t)atomic_get(&tag_listener.changed) & (uint32_t)atomic_get(&watched);
+}
+
+static void subscriptions_init(void)
+{
+    if (initialized) {
+        return;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(watchers); i++) {
+        sys_dlist_init(&watchers[i]);
+    }
+    sys_dlist_init(&pending);
+
+    opcua_snapshot_take(&snapshot);
+    last_pass = -TICK_MS;
+
+    tag_db_listen(&tag_listener);
+    initialized = true;
+}
+
+static uint32_t revise_interval(double interval)
+{
+    /* Also catches NaN */
+    if (!(interval > TICK_MS)) {
+        return TICK_MS;
+    }
+
+    if (interval >= MAX_INTERVAL_MS) {
+        return MAX_INTERVAL_MS;
+    }
+
+    return DIV_ROUND_UP((uint32_t)interval, TICK_MS) * TICK_MS;
+}
+
+static uint32_t item_changes(const struct monitored_item *item)
+{
+    return item->attribute == OPCUA_ATTR_VALUE ? item->node->changes : 0;
+}
+
+static void item_pend(struct monitored_item *item)
+{
+    if (!sys_dnode_is_linked(&item->pending)) {
+        sys_dlist_append(&pending, &item->pending);
+    }
+}
+
+/* Start sampling, the first sample is always reported */
+static void item_start(struct monitored_item *item)
+{
+    uint32_t bits = item_changes(item);
+
+    item->next_sample = 0;
+    item_pend(item);
+
+    /* Clock values change all the time, they stay pending */
+    if (bits == 0 || (bits & OPCUA_CHANGE_CLOCK)) {
+        return;
+    }
+
+    sys_dlist_t *list = &watchers[find_lsb_set(bits) - 1];
+
+    if (sys_dlist_is_empty(list)) {
+        atomic_or(&watched, bits);
+        /* The snapshot may be older than the value, so refresh it */
+        atomic_or(&tag_listener.changed, bits);
+    }
+    sys_dlist_append(list, &item->watch);
+}
+
+static void item_stop(struct monitored_item *item)
+{
+    uint32_t bits = item_changes(item);
+
+    if (sys_dnode_is_linked(&item->watch)) {
+        sys_dlist_t *list = &watchers[find_lsb_set(bits) - 1];
+
+        sys_dlist_remove(&item->watch);
+        if (sys_dlist_is_empty(list)) {
+            atomic_and(&watched, ~bits);
+        }
+    }
+
+    if (sys_dnode_is_linked(&item->pending)) {
+        sys_dlist_remove(&item->pending);
+    }
+
+    if (sys_dnode_is_linked(&item->queued)) {
+        sys_dlist_remove(&item->queued);
+    }
+
+    item->unreported = false;
+}
+
+static void item_set_mode(struct monitored_item *item, uint8_t mode)
+{
+    if (mode == item->mode) {
+        return;
+    }
+
+    if (mode == MODE_DISABLED) {
+        item_stop(item);
+    } else if (item->mode == MODE_DISABLED) {
+        item_start(item);
+    } else if (mode == MODE_REPORTING) {
+        /* The value sampled meanwhile is reported now */
+        if (item->unreported && !sys_dnode_is_linked(&item->queued)) {
+            sys_dlist_append(&item->sub->notify, &item->queued);
+        }
+    } else if (sys_dnode_is_linked(&item->queued)) {
+        sys_dlist_remove(&item->queued);
+    }
+
+    item->mode = mode;
+}
+
+static void item_free(struct monitored_item *item)
+{
+    item_stop(item);
+    item->sub = NULL;
+}
+
+static struct monitored_item *item_find(const struct subscription *sub, uint32_t id)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++) {
+        if (items[i].sub == sub && items[i].id == id) {
+            return &items[i];
+        }
+    }
+
+    return NULL;
+}
+
+static struct subscription *subscription_find(const struct opcua_conn *conn, uint32_t id)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(subscriptions); i++) {
+        if (subscriptions[i].conn == conn && subscriptions[i].id == id) {
+            return &subscriptions[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool has_subscriptions(const struct opcua_conn *conn)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(subscriptions); i++) {
+        if (subscriptions[i].conn == conn) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static struct opcua_publish_request publish_pop(struct opcua_session *session)
+{
+    struct opcua_publish_request req = session->publish[0];
+
+    session->publish_count--;
+    memmove(&session->publish[0], &session->publish[1],
+            session->publish_count * sizeof(session->publish[0]));
+
+    return req;
+}
+
+static void subscription_delete(struct subscription *sub)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++) {
+        if (items[i].sub == sub) {
+            item_free(&items[i]);
+        }
+    }
+
+    LOG_INF("Deleted subscription %u", sub->id);
+    memset(sub, 0, sizeof(*sub));
+    subscription_count--;
+}
+
+/*
+ * Publish requests are only held while there is something to publish. This
+ * sends responses, so it must not be called while one is being written.
+ */
+static void publish_drain(struct opcua_conn *conn)
+{
+    struct opcua_session *session = &conn->session;
+
+    while (!has_subscriptions(conn) && session->publish_count > 0) {
+        struct opcua_publish_request req = publish_pop(session);
+
+        (void)opcua_send_fault(conn, req.request_id, req.handle, OPCUA_BAD_NO_SUBSCRIPTION);
+    }
+}
+
+static uint32_t write_notifications(struct opcua_buf *buf, struct subscription *sub)
+{
+    uint32_t count = 0;
+
+    while (!sys_dlist_is_empty(&sub->notify) &&
+           (sub->max_notifications == 0 || count < sub->max_notifications)) {
+        struct monitored_item *item = CONTAINER_OF(sys_dlist_peek_head(&sub->notify),
+                                                   struct monitored_item, queued);
+        size_t pos = buf->pos;
+
+        opcua_write_u32(buf, item->client_handle);
+        opcua_write_data_value(buf, item->sample.status, &item->sample.value,
+                               item->timestamps, item->attribute == OPCUA_ATTR_VALUE,
+                               item->sample.time);
+        if (buf->error) {
+            /* The rest goes into the next response */
+            buf->pos = pos;
+            buf->error = false;
+            break;
+        }
+
+        sys_dlist_remove(&item->queued);
+        item->unreported = false;
+        count++;
+    }
+
+    return count;
+}
+
+/* Answer the oldest Publish request with the queued notifications or a keep-alive */
+static void publish_send(struct subscription *sub)
+{
+    struct opcua_conn *conn = sub->conn;
+    struct opcua_publish_request req = publish_pop(&conn->session);
+    bool notify = sub->enabled && !sys_dlist_is_empty(&sub->notify);
+    struct opcua_buf buf;
+    size_t more_pos;
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_PUBLISH_RESPONSE);
+    opcua_write_response_header(&buf, req.handle, OPCUA_GOOD);
+    opcua_write_u32(&buf, sub->id);
+    opcua_write_i32(&buf, 0);   /* AvailableSequenceNumbers, none are kept */
+    more_pos = buf.pos;
+    opcua_write_u8(&buf, 0);    /* MoreNotifications */
+
+    /* A keep-alive carries the sequence number of the next message */
+    opcua_write_u32(&buf, sub->seq);
+    opcua_write_i64(&buf, opcua_datetime_now());
+
+    if (notify) {
+        size_t len_pos;
+        size_t count_pos;
+        uint32_t count;
+
+        opcua_write_i32(&buf, 1);
+        opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_DATA_CHANGE_NOTIFICATION);
+        opcua_write_u8(&buf, 1);
+        len_pos = buf.pos;
+        opcua_write_u32(&buf, 0);
+        count_pos = buf.pos;
+        opcua_write_u32(&buf, 0);
+
+        buf.len -= PUBLISH_TRAILER_LEN;
+        count = write_notifications(&buf, sub);
+        buf.len += PUBLISH_TRAILER_LEN;
+
+        opcua_write_i32(&buf, 0);   /* DiagnosticInfos */
+        opcua_patch_u32(&buf, count_pos, count);
+        opcua_patch_u32(&buf, len_pos, buf.pos - len_pos - 4);
+
+        if (!buf.error) {
+            buf.data[more_pos] = !sys_dlist_is_empty(&sub->notify);
+        }
+
+        sub->seq = sub->seq == UINT32_MAX ? 1 : sub->seq + 1;
+    } else {
+        opcua_write_i32(&buf, 0);
+    }
+
+    opcua_write_i32(&buf, req.ack_count);
+    for (uint8_t i = 0; i < req.ack_count; i++) {
+        opcua_write_u32(&buf, req.ack_results[i]);
+    }
+    opcua_write_i32(&buf, 0);       /* DiagnosticInfos */
+
+    sub->keepalive_counter = 0;
+    sub->lifetime_counter = 0;
+    sub->late = sub->enabled && !sys_dlist_is_empty(&sub->notify);
+
+    (void)opcua_send_response(conn, req.request_id, req.handle, &buf);
+}
+
+static void publish_all(struct subscription *sub)
+{
+    do {
+        publish_send(sub);
+    } while (sub->late && sub->conn->session.publish_count > 0);
+}
+
+/* Serve a late subscription of @p conn, taking turns between them */
+static void publish_late(struct opcua_conn *conn)
+{
+    for (size_t n = 0; n < ARRAY_SIZE(subscriptions); n++) {
+        struct subscription *sub = &subscriptions[(next_late + n) % ARRAY_SIZE(subscriptions)];
+
+        if (sub->conn == conn && sub->late) {
+            next_late = (sub - subscriptions) + 1;
+            publish_all(sub);
+            return;
+        }
+    }
+}
+
+static void subscription_missed(struct subscription *sub)
+{
+    sub->late = true;
+
+    if (++sub->lifetime_counter >= sub->lifetime) {
+        struct opcua_conn *conn = sub->conn;
+
+        LOG_INF("Subscription %u expired", sub->id);
+        subscription_delete(sub);
+        publish_drain(conn);
+    }
+}
+
+static void subscription_timer(struct subscription *sub, int64_t now)
+{
+    if (now < sub->next_publish) {
+        return;
+    }
+
+    sub->next_publish += sub->interval;
+    if (sub->next_publish <= now) {
+        sub->next_publish = now + sub->interval;
+    }
+
+    if (sub->late) {
+        subscription_missed(sub);
+        return;
+    }
+
+    if (!(sub->enabled && !sys_dlist_is_empty(&sub->notify)) &&
+        ++sub->keepalive_counter < sub->max_keepalive) {
+        return;
+    }
+
+    if (sub->conn->session.publish_count > 0) {
+        publish_all(sub);
+    } else {
+        subscription_missed(sub);
+    }
+}
+
+/* Sample the items whose values changed, once per tick for all of them */
+static void sample_pass(int64_t now)
+{
+    uint32_t changed = tag_db_changes(&tag_listener);
+    struct monitored_item *item;
+    struct monitored_item *next;
+
+    opcua_snapshot_update(&snapshot, changed);
+    changed &= (uint32_t)atomic_get(&watched);
+
+    while (changed != 0) {
+        sys_dlist_t *list = &watchers[find_lsb_set(changed) - 1];
+
+        changed &= changed - 1;
+        SYS_DLIST_FOR_EACH_CONTAINER(list, item, watch) {
+            item_pend(item);
+        }
+    }
+
+    SYS_DLIST_FOR_EACH_CONTAINER_SAFE(&pending, item, next, pending) {
+        if (item->next_sample > now) {
+            continue;
+        }
+
+        opcua_node_sample(item->node, item->attribute, &snapshot, &item->sample);
+        item->next_sample = now + item->interval;
+        item->unreported = true;
+
+        if (item->mode == MODE_REPORTING && !sys_dnode_is_linked(&item->queued)) {
+            sys_dlist_append(&item->sub->notify, &item->queued);
+        }
+
+        if (!(item_changes(item) & OPCUA_CHANGE_CLOCK)) {
+            sys_dlist_remove(&item->pending);
+        }
+    }
+
+    last_pass = now;
+}
+
+static int64_t sample_due(int64_t now)
+{
+    int64_t due = watched_changes() != 0 ? now : INT64_MAX;
+    struct monitored_item *item;
+
+    SYS_DLIST_FOR_EACH_CONTAINER(&pending, item, pending) {
+        due = MIN(due, item->next_sample);
+    }
+
+    return due;
+}
+
+static int64_t publish_timeouts(struct opcua_conn *conn, int64_t now)
+{
+    struct opcua_session *session = &conn->session;
+    int64_t next = INT64_MAX;
+
+    for (uint8_t i = 0; i < session->publish_count;) {
+        struct opcua_publish_request *req = &session->publish[i];
+
+        if (req->deadline == 0 || req->deadline > now) {
+            next = req->deadline == 0 ? next : MIN(next, req->deadline);
+            i++;
+            continue;
+        }
+
+        (void)opcua_send_fault(conn, req->request_id, req->handle, OPCUA_BAD_TIMEOUT);
+        session->publish_count--;
+        memmove(req, req + 1, (session->publish_count - i) * sizeof(*req));
+    }
+
+    return next;
+}
+
+int opcua_subscriptions_process(void)
+{
+    int64_t now = k_uptime_get();
+    int64_t next;
+
+    if (subscription_count == 0) {
+        return -1;
+    }
+
+    next = sample_due(now);
+    if (next <= now && now - last_pass >= TICK_MS) {
+        sample_pass(now);
+        next = sample_due(now);
+    }
+
+    /* Changes arriving within a tick wait for the next one */
+    if (next <= now) {
+        next = last_pass + TICK_MS;
+    }
+
+    for (size_t i = 0; i < ARRAY_SIZE(subscriptions); i++) {
+        struct subscription *sub = &subscriptions[i];
+
+        if (sub->conn != NULL) {
+            subscription_timer(sub, now);
+        }
+
+        /* May have been deleted by the timer */
+        if (sub->conn != NULL) {
+            next = MIN(next, sub->next_publish);
+            next = MIN(next, publish_timeouts(sub->conn, now));
+        }
+    }
+
+    if (next == INT64_MAX) {
+        return -1;
+    }
+
+    return (int)CLAMP(next - now, 0, INT32_MAX);
+}
+
+static void revise_subscription(struct subscription *sub, double interval,
+                                uint32_t lifetime, uint32_t keepalive)
+{
+    sub->interval = revise_interval(interval);
+    sub->max_keepalive = keepalive == 0 ? DEFAULT_KEEPALIVE : MIN(keepalive, MAX_KEEPALIVE);
+    sub->lifetime = CLAMP(lifetime, 3 * sub->max_keepalive, MAX_LIFETIME);
+    sub->next_publish = k_uptime_get() + sub->interval;
+}
+
+static int create_subscription(struct opcua_conn *conn, uint32_t request_id,
+                               const struct opcua_request_header *hdr,
+                               struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    uint32_t max_notifications;
+    uint32_t lifetime;
+    uint32_t keepalive;
+    double interval;
+    bool enabled;
+
+    interval = opcua_read_double(req);
+    lifetime = opcua_read_u32(req);
+    keepalive = opcua_read_u32(req);
+    max_notifications = opcua_read_u32(req);
+    enabled = opcua_read_u8(req) != 0;
+    (void)opcua_read_u8(req);   /* Priority */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    sub = subscription_find(NULL, 0);
+    if (sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_TOO_MANY_SUBSCRIPTIONS);
+    }
+
+    subscriptions_init();
+
+    sub->conn = conn;
+    sub->id = next_subscription_id++;
+    subscription_count++;
+    sub->max_notifications = max_notifications;
+    sub->enabled = enabled;
+    sub->seq = 1;
+    sys_dlist_init(&sub->notify);
+    revise_subscription(sub, interval, lifetime, keepalive);
+
+    LOG_INF("Created subscription %u, publishing every %u ms", sub->id, sub->interval);
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_CREATE_SUBSCRIPTION_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_u32(&buf, sub->id);
+    opcua_write_double(&buf, sub->interval);
+    opcua_write_u32(&buf, sub->lifetime);
+    opcua_write_u32(&buf, sub->max_keepalive);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+static int modify_subscription(struct opcua_conn *conn, uint32_t request_id,
+                               const struct opcua_request_header *hdr,
+                               struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    uint32_t max_notifications;
+    uint32_t lifetime;
+    uint32_t keepalive;
+    double interval;
+    uint32_t id;
+
+    id = opcua_read_u32(req);
+    interval = opcua_read_double(req);
+    lifetime = opcua_read_u32(req);
+    keepalive = opcua_read_u32(req);
+    max_notifications = opcua_read_u32(req);
+    (void)opcua_read_u8(req);   /* Priority */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    sub = subscription_find(conn, id);
+    if (sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+    }
+
+    sub->max_notifications = max_notifications;
+    revise_subscription(sub, interval, lifetime, keepalive);
+
+    opcua_conn_response_begin(conn, &buf);
+    opcua_write_numeric_nodeid(&buf, 0, OPCUA_ID_MODIFY_SUBSCRIPTION_RESPONSE);
+    opcua_write_response_header(&buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_double(&buf, sub->interval);
+    opcua_write_u32(&buf, sub->lifetime);
+    opcua_write_u32(&buf, sub->max_keepalive);
+
+    return opcua_send_response(conn, request_id, hdr->handle, &buf);
+}
+
+/* Start a response with one result per operation, or send a fault */
+static int begin_results(struct opcua_conn *conn, uint32_t request_id,
+                         const struct opcua_request_header *hdr, struct opcua_buf *req,
+                         int32_t count, uint32_t type_id, struct opcua_buf *buf)
+{
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (count == 0) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_NOTHING_TO_DO);
+    }
+
+    if (count > MAX_OPERATIONS) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_TOO_MANY_OPERATIONS);
+    }
+
+    opcua_conn_response_begin(conn, buf);
+    opcua_write_numeric_nodeid(buf, 0, type_id);
+    opcua_write_response_header(buf, hdr->handle, OPCUA_GOOD);
+    opcua_write_i32(buf, count);
+
+    return 1;
+}
+
+static int end_results(struct opcua_conn *conn, uint32_t request_id,
+                       const struct opcua_request_header *hdr, struct opcua_buf *req,
+                       struct opcua_buf *buf)
+{
+    opcua_write_i32(buf, 0);    /* DiagnosticInfos */
+
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    return opcua_send_response(conn, request_id, hdr->handle, buf);
+}
+
+static int set_publishing_mode(struct opcua_conn *conn, uint32_t request_id,
+                               const struct opcua_request_header *hdr,
+                               struct opcua_buf *req)
+{
+    struct opcua_buf buf;
+    bool enabled;
+    int32_t count;
+    int ret;
+
+    enabled = opcua_read_u8(req) != 0;
+    count = opcua_read_array_len(req);
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_SET_PUBLISHING_MODE_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct subscription *sub = subscription_find(conn, opcua_read_u32(req));
+
+        if (req->error) {
+            break;
+        }
+
+        if (sub == NULL) {
+            opcua_write_u32(&buf, OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+            continue;
+        }
+
+        sub->enabled = enabled;
+        opcua_write_u32(&buf, OPCUA_GOOD);
+    }
+
+    return end_results(conn, request_id, hdr, req, &buf);
+}
+
+static int delete_subscriptions(struct opcua_conn *conn, uint32_t request_id,
+                                const struct opcua_request_header *hdr,
+                                struct opcua_buf *req)
+{
+    int32_t count = opcua_read_array_len(req);
+    struct opcua_buf buf;
+    int ret;
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_DELETE_SUBSCRIPTIONS_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct subscription *sub = subscription_find(conn, opcua_read_u32(req));
+
+        if (req->error) {
+            break;
+        }
+
+        if (sub == NULL) {
+            opcua_write_u32(&buf, OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+            continue;
+        }
+
+        subscription_delete(sub);
+        opcua_write_u32(&buf, OPCUA_GOOD);
+    }
+
+    ret = end_results(conn, request_id, hdr, req, &buf);
+    if (ret == 0) {
+        publish_drain(conn);
+    }
+
+    return ret;
+}
+
+/* Only data change filters that report every change of the value are supported */
+static uint32_t read_filter(struct opcua_buf *req)
+{
+    struct opcua_nodeid type;
+    struct opcua_string body;
+    struct opcua_buf filter;
+    uint32_t deadband_type;
+    uint32_t trigger;
+    uint8_t encoding;
+
+    opcua_read_nodeid(req, &type);
+    encoding = opcua_read_u8(req);
+    if (encoding == 0) {
+        return OPCUA_GOOD;
+    }
+
+    opcua_read_string(req, &body);
+    if (req->error) {
+        return OPCUA_BAD_DECODING_ERROR;
+    }
+
+    if (encoding != 1 || type.ns != 0 || type.type != OPCUA_NODEID_NUMERIC ||
+        type.numeric != OPCUA_ID_DATA_CHANGE_FILTER) {
+        return OPCUA_BAD_MONITORED_ITEM_FILTER_UNSUPPORTED;
+    }
+
+    opcua_buf_init(&filter, (uint8_t *)body.data, MAX(body.len, 0));
+    trigger = opcua_read_u32(&filter);
+    deadband_type = opcua_read_u32(&filter);
+    (void)opcua_read_double(&filter);
+    if (filter.error) {
+        return OPCUA_BAD_DECODING_ERROR;
+    }
+
+    /* StatusValue or StatusValueTimestamp, without a deadband */
+    if (trigger < 1 || trigger > 2 || deadband_type != 0) {
+        return OPCUA_BAD_MONITORED_ITEM_FILTER_UNSUPPORTED;
+    }
+
+    return OPCUA_GOOD;
+}
+
+struct item_parameters {
+    uint32_t client_handle;
+    double interval;
+    uint32_t filter_status;
+};
+
+static void read_item_parameters(struct opcua_buf *req, struct item_parameters *params)
+{
+    params->client_handle = opcua_read_u32(req);
+    params->interval = opcua_read_double(req);
+    params->filter_status = read_filter(req);
+    (void)opcua_read_u32(req);  /* QueueSize, always 1 */
+    (void)opcua_read_u8(req);   /* DiscardOldest */
+}
+
+static void item_revise(struct monitored_item *item, const struct item_parameters *params)
+{
+    item->client_handle = params->client_handle;
+
+    /* A negative interval asks for the publishing interval */
+    if (params->interval < 0) {
+        item->interval = item->sub->interval;
+    } else {
+        item->interval = revise_interval(params->interval);
+    }
+}
+
+static void write_item_parameters(struct opcua_buf *buf, const struct monitored_item *item)
+{
+    opcua_write_double(buf, item->interval);
+    opcua_write_u32(buf, 1);    /* RevisedQueueSize */
+    opcua_write_numeric_nodeid(buf, 0, 0); /* FilterResult */
+    opcua_write_u8(buf, 0);
+}
+
+static void write_item_error(struct opcua_buf *buf, uint32_t status, bool created)
+{
+    opcua_write_u32(buf, status);
+    if (created) {
+        opcua_write_u32(buf, 0);    /* MonitoredItemId */
+    }
+    opcua_write_double(buf, 0);
+    opcua_write_u32(buf, 0);
+    opcua_write_numeric_nodeid(buf, 0, 0);
+    opcua_write_u8(buf, 0);
+}
+
+static uint32_t item_validate(const struct opcua_node *node, uint32_t attribute,
+                              const struct opcua_string *range)
+{
+    struct opcua_variant val;
+
+    if (node == NULL) {
+        return OPCUA_BAD_NODE_ID_UNKNOWN;
+    }
+
+    if (range->len > 0) {
+        return OPCUA_BAD_INDEX_RANGE_INVALID;
+    }
+
+    return opcua_node_read(node, attribute, &snapshot, &val);
+}
+
+static struct monitored_item *item_alloc(void)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++) {
+        if (items[i].sub == NULL) {
+            memset(&items[i], 0, sizeof(items[i]));
+            return &items[i];
+        }
+    }
+
+    return NULL;
+}
+
+static int create_monitored_items(struct opcua_conn *conn, uint32_t request_id,
+                                  const struct opcua_request_header *hdr,
+                                  struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    uint32_t timestamps;
+    int32_t count;
+    int ret;
+
+    sub = subscription_find(conn, opcua_read_u32(req));
+    timestamps = opcua_read_u32(req);
+    count = opcua_read_array_len(req);
+
+    if (!req->error && sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+    }
+
+    if (!req->error && timestamps > OPCUA_TIMESTAMPS_NEITHER) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_TIMESTAMPS_TO_RETURN_INVALID);
+    }
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_CREATE_MONITORED_ITEMS_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct item_parameters params;
+        struct monitored_item *item;
+        const struct opcua_node *node;
+        struct opcua_string range;
+        struct opcua_nodeid id;
+        uint32_t attribute;
+        uint32_t mode;
+        uint32_t status;
+
+        opcua_read_nodeid(req, &id);
+        attribute = opcua_read_u32(req);
+        opcua_read_string(req, &range);
+        opcua_skip_qualified_name(req); /* DataEncoding */
+        mode = opcua_read_u32(req);
+        read_item_parameters(req, &params);
+        if (req->error) {
+            break;
+        }
+
+        node = opcua_node_find(&id);
+        status = item_validate(node, attribute, &range);
+        if (status == OPCUA_GOOD && mode > MODE_REPORTING) {
+            status = OPCUA_BAD_MONITORING_MODE_INVALID;
+        }
+        if (status == OPCUA_GOOD) {
+            status = params.filter_status;
+        }
+
+        item = status == OPCUA_GOOD ? item_alloc() : NULL;
+        if (status == OPCUA_GOOD && item == NULL) {
+            status = OPCUA_BAD_TOO_MANY_MONITORED_ITEMS;
+        }
+
+        if (status != OPCUA_GOOD) {
+            write_item_error(&buf, status, true);
+            continue;
+        }
+
+        item->sub = sub;
+        item->id = next_item_id++;
+        item->node = node;
+        item->attribute = attribute;
+        item->timestamps = timestamps;
+        item->mode = MODE_DISABLED;
+        item_revise(item, &params);
+        item_set_mode(item, mode);
+
+        opcua_write_u32(&buf, OPCUA_GOOD);
+        opcua_write_u32(&buf, item->id);
+        write_item_parameters(&buf, item);
+    }
+
+    return end_results(conn, request_id, hdr, req, &buf);
+}
+
+static int modify_monitored_items(struct opcua_conn *conn, uint32_t request_id,
+                                  const struct opcua_request_header *hdr,
+                                  struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    uint32_t timestamps;
+    int32_t count;
+    int ret;
+
+    sub = subscription_find(conn, opcua_read_u32(req));
+    timestamps = opcua_read_u32(req);
+    count = opcua_read_array_len(req);
+
+    if (!req->error && sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+    }
+
+    if (!req->error && timestamps > OPCUA_TIMESTAMPS_NEITHER) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_TIMESTAMPS_TO_RETURN_INVALID);
+    }
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_MODIFY_MONITORED_ITEMS_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct item_parameters params;
+        struct monitored_item *item;
+
+        item = item_find(sub, opcua_read_u32(req));
+        read_item_parameters(req, &params);
+        if (req->error) {
+            break;
+        }
+
+        if (item == NULL || params.filter_status != OPCUA_GOOD) {
+            write_item_error(&buf, item == NULL ? OPCUA_BAD_MONITORED_ITEM_ID_INVALID :
+                                                  params.filter_status, false);
+            continue;
+        }
+
+        item->timestamps = timestamps;
+        item_revise(item, &params);
+        /* The next sample is taken at the new interval */
+        item->next_sample = MIN(item->next_sample, k_uptime_get() + item->interval);
+
+        opcua_write_u32(&buf, OPCUA_GOOD);
+        write_item_parameters(&buf, item);
+    }
+
+    return end_results(conn, request_id, hdr, req, &buf);
+}
+
+static int set_monitoring_mode(struct opcua_conn *conn, uint32_t request_id,
+                               const struct opcua_request_header *hdr,
+                               struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    uint32_t mode;
+    int32_t count;
+    int ret;
+
+    sub = subscription_find(conn, opcua_read_u32(req));
+    mode = opcua_read_u32(req);
+    count = opcua_read_array_len(req);
+
+    if (!req->error && sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+    }
+
+    if (!req->error && mode > MODE_REPORTING) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_MONITORING_MODE_INVALID);
+    }
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_SET_MONITORING_MODE_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct monitored_item *item = item_find(sub, opcua_read_u32(req));
+
+        if (req->error) {
+            break;
+        }
+
+        if (item == NULL) {
+            opcua_write_u32(&buf, OPCUA_BAD_MONITORED_ITEM_ID_INVALID);
+            continue;
+        }
+
+        item_set_mode(item, mode);
+        opcua_write_u32(&buf, OPCUA_GOOD);
+    }
+
+    return end_results(conn, request_id, hdr, req, &buf);
+}
+
+static int delete_monitored_items(struct opcua_conn *conn, uint32_t request_id,
+                                  const struct opcua_request_header *hdr,
+                                  struct opcua_buf *req)
+{
+    struct subscription *sub;
+    struct opcua_buf buf;
+    int32_t count;
+    int ret;
+
+    sub = subscription_find(conn, opcua_read_u32(req));
+    count = opcua_read_array_len(req);
+
+    if (!req->error && sub == NULL) {
+        return opcua_send_fault(conn, request_id, hdr->handle,
+                                OPCUA_BAD_SUBSCRIPTION_ID_INVALID);
+    }
+
+    ret = begin_results(conn, request_id, hdr, req, count,
+                        OPCUA_ID_DELETE_MONITORED_ITEMS_RESPONSE, &buf);
+    if (ret <= 0) {
+        return ret;
+    }
+
+    for (int32_t i = 0; i < count; i++) {
+        struct monitored_item *item = item_find(sub, opcua_read_u32(req));
+
+        if (req->error) {
+            break;
+        }
+
+        if (item == NULL) {
+            opcua_write_u32(&buf, OPCUA_BAD_MONITORED_ITEM_ID_INVALID);
+            continue;
+        }
+
+        item_free(item);
+        opcua_write_u32(&buf, OPCUA_GOOD);
+    }
+
+    return end_results(conn, request_id, hdr, req, &buf);
+}
+
+static uint32_t acknowledge(const struct opcua_conn *conn, uint32_t id, uint32_t seq)
+{
+    const struct subscription *sub = subscription_find(conn, id);
+
+    if (sub == NULL) {
+        return OPCUA_BAD_SUBSCRIPTION_ID_INVALID;
+    }
+
+    /*
+     * Nothing is kept for retransmission, so any message that was sent can
+     * be acknowledged.
+     */
+    if (seq == 0 || seq >= sub->seq) {
+        return OPCUA_BAD_SEQUENCE_NUMBER_UNKNOWN;
+    }
+
+    return OPCUA_GOOD;
+}
+
+static int publish(struct opcua_conn *conn, uint32_t request_id,
+                   const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    struct opcua_session *session = &conn->session;
+    struct opcua_publish_request *pending_req;
+    int32_t count;
+
+    count = opcua_read_array_len(req);
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    if (count > OPCUA_MAX_ACKNOWLEDGEMENTS) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_TOO_MANY_OPERATIONS);
+    }
+
+    if (!has_subscriptions(conn)) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_NO_SUBSCRIPTION);
+    }
+
+    /* The oldest request makes room for the new one */
+    if (session->publish_count == OPCUA_MAX_PUBLISH_REQUESTS) {
+        struct opcua_publish_request old = publish_pop(session);
+        int ret;
+
+        ret = opcua_send_fault(conn, old.request_id, old.handle,
+                               OPCUA_BAD_TOO_MANY_PUBLISH_REQUESTS);
+        if (ret < 0) {
+            return ret;
+        }
+    }
+
+    pending_req = &session->publish[session->publish_count];
+    pending_req->request_id = request_id;
+    pending_req->handle = hdr->handle;
+    pending_req->deadline = hdr->timeout_hint == 0 ? 0 : k_uptime_get() + hdr->timeout_hint;
+    pending_req->ack_count = count;
+
+    for (int32_t i = 0; i < count; i++) {
+        uint32_t id = opcua_read_u32(req);
+        uint32_t seq = opcua_read_u32(req);
+
+        pending_req->ack_results[i] = acknowledge(conn, id, seq);
+    }
+
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    session->publish_count++;
+
+    /* Notifications that were waiting for a request go out right away */
+    publish_late(conn);
+
+    /* The timeout may be earlier than anything else the server waits for */
+    if (pending_req->deadline != 0) {
+        opcua_server_wakeup();
+    }
+
+    return 0;
+}
+
+static int republish(struct opcua_conn *conn, uint32_t request_id,
+                     const struct opcua_request_header *hdr, struct opcua_buf *req)
+{
+    uint32_t id = opcua_read_u32(req);
+
+    (void)opcua_read_u32(req);  /* RetransmitSequenceNumber */
+    if (req->error) {
+        return opcua_send_fault(conn, request_id, hdr->handle, OPCUA_BAD_DECODING_ERROR);
+    }
+
+    return opcua_send_fault(conn, request_id, hdr->handle,
+                            subscription_find(conn, id) == NULL ?
+                            OPCUA_BAD_SUBSCRIPTION_ID_INVALID :
+                            OPCUA_BAD_MESSAGE_NOT_AVAILABLE);
+}
+
+int opcua_subscriptions_dispatch(struct opcua_conn *conn, uint32_t request_id,
+                                 uint32_t type_id, const struct opcua_request_header *hdr,
+                                 struct opcua_buf *req)
+{
+    switch (type_id) {
+    case OPCUA_ID_CREATE_SUBSCRIPTION_REQUEST:
+        return create_subscription(conn, request_id, hdr, req);
+    case OPCUA_ID_MODIFY_SUBSCRIPTION_REQUEST:
+        return modify_subscription(conn, request_id, hdr, req);
+    case OPCUA_ID_SET_PUBLISHING_MODE_REQUEST:
+        return set_publishing_mode(conn, request_id, hdr, req);
+    case OPCUA_ID_DELETE_SUBSCRIPTIONS_REQUEST:
+        return delete_subscriptions(conn, request_id, hdr, req);
+    case OPCUA_ID_CREATE_MONITORED_ITEMS_REQUEST:
+        return create_monitored_items(conn, request_id, hdr, req);
+    case OPCUA_ID_MODIFY_MONITORED_ITEMS_REQUEST:
+        return modify_monitored_items(conn, request_id, hdr, req);
+    case OPCUA_ID_SET_MONITORING_MODE_REQUEST:
+        return set_monitoring_mode(conn, request_id, hdr, req);
+    case OPCUA_ID_DELETE_MONITORED_ITEMS_REQUEST:
+        return delete_monitored_items(conn, request_id, hdr, req);
+    case OPCUA_ID_PUBLISH_REQUEST:
+        return publish(conn, request_id, hdr, req);
+    case OPCUA_ID_REPUBLISH_REQUEST:
+        return republish(conn, request_id, hdr, req);
+    default:
+        return -ENOTSUP;
+    }
+}
+
+void opcua_subscriptions_close(struct opcua_conn *conn)
+{
+    /* Nothing is sent on a connection that is going away */
+    conn->session.publish_count = 0;
+
+    for (size_t i = 0; i < ARRAY_SIZE(subscriptions); i++) {
+        if (subscriptions[i].conn == conn) {
+            subscription_delete(&subscriptions[i]);
+        }
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <strings.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/logging/log.h>
+
+#include "HTTPWebsocket.h"
+#include "OpcUaServer.h"
+
+LOG_MODULE_DECLARE(opcua, CONFIG_NET_SAMPLE_LOG_LEVEL);
+
+/* WebSocket subprotocol of the OPC UA binary mapping, OPC 10000-6 7.5.2 */
+#define OPCUA_SUBPROTOCOL "opcua+uacp"
+
+/* Frames are received through this buffer, it does not bound the message size */
+#define WS_BUFFER_SIZE 1024
+
+HTTP_SERVER_REGISTER_HEADER_CAPTURE(capture_ws_protocol, "Sec-WebSocket-Protocol");
+
+/* True if @value, a list of subprotocols, offers OPCUA_SUBPROTOCOL */
+static bool protocol_offered(const char *value)
+{
+    size_t len = strlen(OPCUA_SUBPROTOCOL);
+
+    while (*value != '\0') {
+        const char *end;
+        const char *token_end;
+
+        while (*value == ' ' || *value == ',') {
+            value++;
+        }
+
+        end = strchr(value, ',');
+        if (end == NULL) {
+            end = value + strlen(value);
+        }
+
+        token_end = end;
+        while (token_end > value && token_end[-1] == ' ') {
+            token_end--;
+        }
+
+        if ((size_t)(token_end - value) == len && strncmp(value, OPCUA_SUBPROTOCOL, len) == 0) {
+            return true;
+        }
+
+        value = end;
+    }
+
+    return false;
+}
+
+/* Clients that offer no subprotocol are served too, other subprotocols are
+ * not. The 101 response has already been sent without selecting one, so a
+ * client that offered opcua+uacp fails the handshake on its side (RFC 6455
+ * 4.1) and only clients that offer none are served in practice.
+ */
+static bool protocol_acceptable(const struct http_request_ctx *request_ctx)
+{
+    if (request_ctx->headers_status != HTTP_HEADER_STATUS_OK) {
+        return true;
+    }
+
+    for (size_t i = 0; i < request_ctx->header_count; i++) {
+        if (strcasecmp(request_ctx->headers[i].name, "Sec-WebSocket-Protocol") == 0) {
+            return protocol_offered(request_ctx->headers[i].value);
+        }
+    }
+
+    return true;
+}
+
+static int opcua_ws_setup(int ws_socket, struct http_request_ctx *request_ctx, void *user_data)
+{
+    int ret;
+
+    ARG_UNUSED(user_data);
+
+    if (!protocol_acceptable(request_ctx)) {
+        LOG_WRN("WebSocket client does not speak " OPCUA_SUBPROTOCOL);
+        /* The caller closes the connection */
+        return -EPROTONOSUPPORT;
+    }
+
+    ret = opcua_server_adopt(ws_socket);
+    if (ret < 0) {
+        LOG_WRN("Cannot accept more OPC UA WebSocket connections");
+        return ret;
+    }
+
+    return 0;
+}
+
+/* Receive buffer of the WebSocket layer, shared by all connections on the resource */
+static uint8_t opcua_ws_buffer[WS_BUFFER_SIZE];
+
+static struct http_resource_detail_websocket opcua_ws_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_WEBSOCKET,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
+    },
+    .cb = opcua_ws_setup,
+    .data_buffer = opcua_ws_buffer,
+    .data_buffer_len = sizeof(opcua_ws_buffer),
+};
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(opcua_ws_resource, CONFIG_NET_SAMPLE_OPCUA_WEBSOCKET_PATH,
+                              &opcua_ws_detail);
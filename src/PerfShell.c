@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/logging/log_ctrl.h>
+#include <zephyr/sys/iterable_sections.h>
+
+#include "AppLog.h"
+#include "Flash.h"
+
+static const char *const levels[] = {
+    [LOG_LEVEL_NONE] = "none",
+    [LOG_LEVEL_ERR] = "err",
+    [LOG_LEVEL_WRN] = "wrn",
+    [LOG_LEVEL_INF] = "inf",
+    [LOG_LEVEL_DBG] = "dbg",
+};
+
+#if defined(CONFIG_LOG_RUNTIME_FILTERING)
+/* Registered with APP_LOG_MODULE_REGISTER() */
+static bool app_log_module(const char *name)
+{
+    STRUCT_SECTION_FOREACH(app_log_module, module) {
+        if (strcmp(module->name, name) == 0) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* Levels above CONFIG_NET_SAMPLE_LOG_LEVEL were compiled out and stay off */
+static int cmd_perf_log(const struct shell *sh, size_t argc, char **argv)
+{
+    uint32_t sources = log_src_cnt_get(Z_LOG_LOCAL_DOMAIN_ID);
+    const char *name;
+    uint32_t level;
+    uint32_t set;
+
+    ARG_UNUSED(argc);
+
+    for (level = 0; level < ARRAY_SIZE(levels); level++) {
+        if (strcmp(argv[1], levels[level]) == 0) {
+            break;
+        }
+    }
+
+    if (level == ARRAY_SIZE(levels)) {
+        shell_error(sh, "Unknown level %s, use none, err, wrn, inf or dbg", argv[1]);
+        return -EINVAL;
+    }
+
+    for (uint32_t source = 0; source < sources; source++) {
+        name = log_source_name_get(Z_LOG_LOCAL_DOMAIN_ID, source);
+        if (name == NULL || !app_log_module(name)) {
+            continue;
+        }
+
+        set = log_filter_set(NULL, Z_LOG_LOCAL_DOMAIN_ID, source, level);
+        shell_print(sh, "%-24s %s", name, levels[MIN(set, LOG_LEVEL_DBG)]);
+    }
+
+    return 0;
+}
+#endif /* CONFIG_LOG_RUNTIME_FILTERING */
+
+static int cmd_perf_flush(const struct shell *sh, size_t argc, char **argv)
+{
+    int64_t start = k_uptime_get();
+    int rc;
+
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    rc = Flash_FlushNVS();
+    if (rc < 0) {
+        shell_error(sh, "Saving the configuration failed: %d", rc);
+        return rc;
+    }
+
+    shell_print(sh, "Configuration written in %u ms",
+                (uint32_t)(k_uptime_get() - start));
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(perf_cmds,
+#if defined(CONFIG_LOG_RUNTIME_FILTERING)
+    SHELL_CMD_ARG(log, NULL, "Set the log level of all application modules "
+                  "<none|err|wrn|inf|dbg>", cmd_perf_log, 2, 0),
+#endif
+    SHELL_CMD(flush, NULL, "Write the configuration to flash now instead of when queued",
+              cmd_perf_flush),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(perf, &perf_cmds, "Runtime tuning of the application", NULL);
@@ -0,0 +1,217 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#include "HTTPWebsocket.h"
+#include "LogLimit.h"
+#include "InductionConfig.h"
+#include "netstats.h"
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+#include "TLSSessionCache.h"
+#endif
+
+APP_LOG_MODULE_REGISTER(restapi);
+
+/* The server hands a dynamic resource to one client at a time, so a single
+ * parser and response buffer per resource is enough.
+ */
+static InductionConfigParser_t config_parser;
+static bool config_put_active;
+static char config_buf[256];
+static char netstats_buf[NETSTATS_JSON_LEN];
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+static char tls_buf[128];
+#endif
+
+static const char bad_request[] = "{\"error\":\"invalid configuration\"}";
+
+static int config_get(struct http_response_ctx *response_ctx)
+{
+    const InductionConfig_t *config;
+    int ret;
+
+    config = InductionConfig_acquire();
+    ret = InductionConfig_json_encode(config, config_buf, sizeof(config_buf));
+    InductionConfig_release(config);
+    if (ret < 0) {
+        LOG_ERR("Failed to encode configuration (%d)", ret);
+        response_ctx->status = HTTP_500_INTERNAL_SERVER_ERROR;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    response_ctx->status = HTTP_200_OK;
+    response_ctx->body = (const uint8_t *)config_buf;
+    response_ctx->body_len = ret;
+    response_ctx->final_chunk = true;
+
+    return 0;
+}
+
+/* The body is parsed chunk by chunk as it arrives, and only applied once it
+ * turned out to be a complete, valid object.
+ */
+static int config_put(enum http_data_status status,
+                      const struct http_request_ctx *request_ctx,
+                      struct http_response_ctx *response_ctx)
+{
+    int ret;
+
+    if (!config_put_active) {
+        InductionConfigParser_init(&config_parser);
+        config_put_active = true;
+    }
+
+    (void)InductionConfigParser_feed(&config_parser, (const char *)request_ctx->data,
+                                     request_ctx->data_len);
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    config_put_active = false;
+
+    ret = InductionConfigParser_finish(&config_parser);
+    if (ret < 0) {
+        LOG_WRN_LIMITED("Rejected configuration (%d)", ret);
+        response_ctx->status = HTTP_400_BAD_REQUEST;
+        response_ctx->body = (const uint8_t *)bad_request;
+        response_ctx->body_len = sizeof(bad_request) - 1;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    InductionConfigParser_apply(&config_parser);
+
+    response_ctx->status = HTTP_204_NO_CONTENT;
+    response_ctx->final_chunk = true;
+
+    return 0;
+}
+
+static int config_cb(struct http_client_ctx *client, enum http_data_status status,
+                     const struct http_request_ctx *request_ctx,
+                     struct http_response_ctx *response_ctx, void *user_data)
+{
+    ARG_UNUSED(user_data);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        config_put_active = false;
+        return 0;
+    }
+
+    switch (client->method) {
+    case HTTP_GET:
+        return status == HTTP_SERVER_DATA_FINAL ? config_get(response_ctx) : 0;
+    case HTTP_PUT:
+        return config_put(status, request_ctx, response_ctx);
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static int netstats_cb(struct http_client_ctx *client, enum http_data_status status,
+                       const struct http_request_ctx *request_ctx,
+                       struct http_response_ctx *response_ctx, void *user_data)
+{
+    int ret;
+
+    ARG_UNUSED(client);
+    ARG_UNUSED(request_ctx);
+    ARG_UNUSED(user_data);
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    ret = netstats_collect(netstats_buf, sizeof(netstats_buf));
+    if (ret < 0) {
+        response_ctx->status = HTTP_500_INTERNAL_SERVER_ERROR;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    response_ctx->status = HTTP_200_OK;
+    response_ctx->body = (const uint8_t *)netstats_buf;
+    response_ctx->body_len = ret;
+    response_ctx->final_chunk = true;
+
+    return 0;
+}
+
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+static int tls_cb(struct http_client_ctx *client, enum http_data_status status,
+                  const struct http_request_ctx *request_ctx,
+                  struct http_response_ctx *response_ctx, void *user_data)
+{
+    int ret;
+
+    ARG_UNUSED(client);
+    ARG_UNUSED(request_ctx);
+    ARG_UNUSED(user_data);
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    ret = tls_session_cache_stats_collect(tls_buf, sizeof(tls_buf));
+    if (ret < 0) {
+        response_ctx->status = HTTP_500_INTERNAL_SERVER_ERROR;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    response_ctx->status = HTTP_200_OK;
+    response_ctx->body = (const uint8_t *)tls_buf;
+    response_ctx->body_len = ret;
+    response_ctx->final_chunk = true;
+
+    return 0;
+}
+#endif /* CONFIG_NET_SAMPLE_TLS_SESSION_CACHE */
+
+static struct http_resource_detail_dynamic config_resource_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET) | BIT(HTTP_PUT),
+        .content_type = "application/json",
+    },
+    .cb = config_cb,
+    .user_data = NULL,
+};
+
+static struct http_resource_detail_dynamic netstats_resource_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
+        .content_type = "application/json",
+    },
+    .cb = netstats_cb,
+    .user_data = NULL,
+};
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(config_resource, "/api/config", &config_resource_detail);
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(netstats_resource, "/api/netstats", &netstats_resource_detail);
+
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+static struct http_resource_detail_dynamic tls_resource_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET),
+        .content_type = "application/json",
+    },
+    .cb = tls_cb,
+    .user_data = NULL,
+};
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(tls_resource, "/api/tls", &tls_resource_detail);
+#endif
@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/logging/log.h>
+
+#include <mbedtls/ssl.h>
+#include <mbedtls/ssl_cache.h>
+
+#include "TLSSessionCache.h"
+
+LOG_MODULE_DECLARE(httpwebsocket, CONFIG_NET_SAMPLE_LOG_LEVEL);
+
+#define SESSION_CACHE_RETRY K_MSEC(100)
+#define SESSION_LIFETIME_MS ((int64_t)CONFIG_NET_SAMPLE_TLS_SESSION_LIFETIME * MSEC_PER_SEC)
+
+/* The TLS socket layer stores sessions in the mbedTLS cache through
+ * mbedtls_ssl_cache_get/set. Both are wrapped at link time so that hits and
+ * misses can be counted, and so that the lifetime holds even without
+ * MBEDTLS_HAVE_TIME, where mbedTLS ignores the cache timeout. Each stored
+ * session id is recorded with its uptime, in the same FIFO order and
+ * bound as the mbedTLS cache.
+ */
+struct session_entry {
+    uint8_t id[32];
+    uint8_t id_len;
+    int64_t stored_at;
+};
+
+static struct session_entry sessions[CONFIG_NET_SAMPLE_TLS_SESSION_CACHE_SIZE];
+static size_t next_session;
+static struct k_spinlock sessions_lock;
+
+static atomic_t hits;
+static atomic_t misses;
+static atomic_t expired;
+static atomic_t stored;
+
+static const struct http_service_desc *cache_svc;
+static struct k_work_delayable cache_work;
+
+int __real_mbedtls_ssl_cache_get(void *data, unsigned char const *session_id,
+                                 size_t session_id_len, mbedtls_ssl_session *session);
+int __real_mbedtls_ssl_cache_set(void *data, unsigned char const *session_id,
+                                 size_t session_id_len, const mbedtls_ssl_session *session);
+
+static struct session_entry *find_session(unsigned char const *id, size_t id_len)
+{
+    for (size_t i = 0; i < ARRAY_SIZE(sessions); i++) {
+        if (sessions[i].id_len == id_len && memcmp(sessions[i].id, id, id_len) == 0) {
+            return &sessions[i];
+        }
+    }
+
+    return NULL;
+}
+
+static bool session_expired(unsigned char const *id, size_t id_len)
+{
+    k_spinlock_key_t key = k_spin_lock(&sessions_lock);
+    struct session_entry *entry = find_session(id, id_len);
+    bool ret = false;
+
+    if (entry != NULL && k_uptime_get() - entry->stored_at > SESSION_LIFETIME_MS) {
+        entry->id_len = 0;
+        ret = true;
+    }
+
+    k_spin_unlock(&sessions_lock, key);
+
+    return ret;
+}
+
+static void session_stored(unsigned char const *id, size_t id_len)
+{
+    k_spinlock_key_t key;
+    struct session_entry *entry;
+
+    if (id_len == 0 || id_len > sizeof(entry->id)) {
+        return;
+    }
+
+    key = k_spin_lock(&sessions_lock);
+
+    entry = find_session(id, id_len);
+    if (entry == NULL) {
+        entry = &sessions[next_session];
+        next_session = (next_session + 1) % ARRAY_SIZE(sessions);
+    }
+
+    memcpy(entry->id, id, id_len);
+    entry->id_len = id_len;
+    entry->stored_at = k_uptime_get();
+
+    k_spin_unlock(&sessions_lock, key);
+}
+
+int __wrap_mbedtls_ssl_cache_get(void *data, unsigned char const *session_id,
+                                 size_t session_id_len, mbedtls_ssl_session *session)
+{
+    int ret;
+
+    if (session_expired(session_id, session_id_len)) {
+        (void)mbedtls_ssl_cache_remove(data, session_id, session_id_len);
+        atomic_inc(&expired);
+        return MBEDTLS_ERR_SSL_CACHE_ENTRY_NOT_FOUND;
+    }
+
+    ret = __real_mbedtls_ssl_cache_get(data, session_id, session_id_len, session);
+    if (ret == 0) {
+        atomic_inc(&hits);
+    } else {
+        atomic_inc(&misses);
+    }
+
+    return ret;
+}
+
+int __wrap_mbedtls_ssl_cache_set(void *data, unsigned char const *session_id,
+                                 size_t session_id_len, const mbedtls_ssl_session *session)
+{
+    int ret = __real_mbedtls_ssl_cache_set(data, session_id, session_id_len, session);
+
+    if (ret == 0) {
+        session_stored(session_id, session_id_len);
+        atomic_inc(&stored);
+    }
+
+    return ret;
+}
+
+static void cache_enable_handler(struct k_work *work)
+{
+    static const int enabled = TLS_SESSION_CACHE_ENABLED;
+    int fd = *cache_svc->fd;
+
+    ARG_UNUSED(work);
+
+    if (fd < 0) {
+        (void)k_work_reschedule(&cache_work, SESSION_CACHE_RETRY);
+        return;
+    }
+
+    if (setsockopt(fd, SOL_TLS, TLS_SESSION_CACHE, &enabled, sizeof(enabled)) < 0) {
+        LOG_ERR("Failed to enable TLS session cache (%d)", -errno);
+        return;
+    }
+
+    LOG_INF("TLS session cache enabled, %d entries, %d s lifetime",
+            CONFIG_NET_SAMPLE_TLS_SESSION_CACHE_SIZE,
+            CONFIG_NET_SAMPLE_TLS_SESSION_LIFETIME);
+}
+
+void tls_session_cache_enable(const struct http_service_desc *svc)
+{
+    cache_svc = svc;
+
+    k_work_init_delayable(&cache_work, cache_enable_handler);
+    (void)k_work_reschedule(&cache_work, K_NO_WAIT);
+}
+
+void tls_session_cache_stats_get(struct tls_session_cache_stats *stats)
+{
+    stats->hits = atomic_get(&hits);
+    stats->misses = atomic_get(&misses);
+    stats->expired = atomic_get(&expired);
+    stats->stored = atomic_get(&stored);
+}
+
+int tls_session_cache_stats_collect(char *buf, size_t maxlen)
+{
+    struct tls_session_cache_stats stats;
+    int ret;
+
+    tls_session_cache_stats_get(&stats);
+
+    ret = snprintf(buf, maxlen,
+                   "{\"hits\":%u,\"misses\":%u,\"expired\":%u,\"stored\":%u,"
+                   "\"size\":%u,\"lifetime\":%u}",
+                   stats.hits, stats.misses, stats.expired, stats.stored,
+                   CONFIG_NET_SAMPLE_TLS_SESSION_CACHE_SIZE,
+                   CONFIG_NET_SAMPLE_TLS_SESSION_LIFETIME);
+    if (ret >= maxlen) {
+        LOG_ERR("TLS session stats do not fit in buffer");
+        return -ENOSPC;
+    }
+
+    return ret;
+}
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TLS_SESSION_CACHE_H
+#define TLS_SESSION_CACHE_H
+
+#include <stdint.h>
+#include <zephyr/net/http/service.h>
+
+struct tls_session_cache_stats {
+    /** Handshakes resumed from a cached session */
+    uint32_t hits;
+    /** Resumption attempts for an unknown session */
+    uint32_t misses;
+    /** Resumption attempts for a session older than the lifetime */
+    uint32_t expired;
+    /** Sessions stored after a full handshake */
+    uint32_t stored;
+};
+
+/**
+ * @brief Enable the server session cache on an HTTPS service
+ *
+ * Sockets accepted on the service inherit the setting from the listening
+ * socket. The listening socket only exists once the HTTP server thread has
+ * set it up, so this retries in the background until it does.
+ */
+void tls_session_cache_enable(const struct http_service_desc *svc);
+
+/**
+ * @brief Copy the session cache counters
+ */
+void tls_session_cache_stats_get(struct tls_session_cache_stats *stats);
+
+/**
+ * @brief Encode the session cache counters as JSON
+ *
+ * @return Length of the encoded string, or a negative error code
+ */
+int tls_session_cache_stats_collect(char *buf, size_t maxlen);
+
+#endif /* TLS_SESSION_CACHE_H */
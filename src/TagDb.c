@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/barrier.h>
+
+#include "TagDb.h"
+
+BUILD_ASSERT(TAG_COUNT <= 32, "tag sets are 32 bit masks");
+
+static const struct {
+    const char *name;
+    enum tag_type type;
+} tag_info[TAG_COUNT] = {
+    [TAG_DHCP] = { "DHCP", TAG_TYPE_STRING },
+    [TAG_IP4_ADDRESS] = { "IP4Address", TAG_TYPE_STRING },
+    [TAG_NETMASK] = { "NetMask", TAG_TYPE_STRING },
+    [TAG_CAN_1_0] = { "isEnabled_CAN_1_0", TAG_TYPE_INT32 },
+    [TAG_CAN_1_1] = { "isEnabled_CAN_1_1", TAG_TYPE_INT32 },
+    [TAG_CAN_1_2] = { "isEnabled_CAN_1_2", TAG_TYPE_INT32 },
+    [TAG_CAN_1_3] = { "isEnabled_CAN_1_3", TAG_TYPE_INT32 },
+    [TAG_CAN_2_0] = { "isEnabled_CAN_2_0", TAG_TYPE_INT32 },
+    [TAG_CAN_2_1] = { "isEnabled_CAN_2_1", TAG_TYPE_INT32 },
+    [TAG_CAN_2_2] = { "isEnabled_CAN_2_2", TAG_TYPE_INT32 },
+    [TAG_CAN_2_3] = { "isEnabled_CAN_2_3", TAG_TYPE_INT32 },
+    [TAG_BYTES_RECV] = { "bytes_recv", TAG_TYPE_UINT32 },
+    [TAG_BYTES_SENT] = { "bytes_sent", TAG_TYPE_UINT32 },
+    [TAG_IPV6_RECV] = { "ipv6_recv", TAG_TYPE_UINT32 },
+    [TAG_IPV6_SENT] = { "ipv6_sent", TAG_TYPE_UINT32 },
+    [TAG_IPV4_RECV] = { "ipv4_recv", TAG_TYPE_UINT32 },
+    [TAG_IPV4_SENT] = { "ipv4_sent", TAG_TYPE_UINT32 },
+    [TAG_TCP_RECV] = { "tcp_recv", TAG_TYPE_UINT32 },
+    [TAG_TCP_SENT] = { "tcp_sent", TAG_TYPE_UINT32 },
+};
+
+/*
+ * Readers never wait for a writer: there are two copies of the values and
+ * the sequence count says which one is stable. While the count is odd the
+ * writer updates bank 0 and readers use bank 1, once it is even again the
+ * roles swap. A reader only retries if the count moved while it copied,
+ * so a high priority reader cannot spin on a preempted writer.
+ */
+static struct tag_value banks[2][TAG_COUNT];
+static atomic_t sequence;
+
+/* The writer's copy, always current, only touched with write_lock held */
+static struct tag_value staging[TAG_COUNT];
+static uint32_t staged;
+
+static K_MUTEX_DEFINE(write_lock);
+static sys_slist_t listeners = SYS_SLIST_STATIC_INIT(&listeners);
+
+const char *tag_name(enum tag_id id)
+{
+    return id < TAG_COUNT ? tag_info[id].name : NULL;
+}
+
+enum tag_type tag_type(enum tag_id id)
+{
+    __ASSERT_NO_MSG(id < TAG_COUNT);
+
+    return tag_info[id].type;
+}
+
+void tag_db_read(enum tag_id first, size_t count, struct tag_value *values)
+{
+    atomic_val_t seq;
+
+    __ASSERT_NO_MSG(first + count <= TAG_COUNT);
+
+    do {
+        seq = atomic_get(&sequence);
+        barrier_dmem_fence_full();
+        memcpy(values, &banks[seq & 1][first], count * sizeof(*values));
+        barrier_dmem_fence_full();
+    } while (atomic_get(&sequence) != seq);
+}
+
+void tag_db_get(enum tag_id id, struct tag_value *value)
+{
+    tag_db_read(id, 1, value);
+}
+
+void tag_db_write_begin(void)
+{
+    k_mutex_lock(&write_lock, K_FOREVER);
+    staged = 0;
+}
+
+static void tag_changed(enum tag_id id)
+{
+    staging[id].version++;
+    staging[id].timestamp = k_uptime_get();
+    staged |= BIT(id);
+}
+
+void tag_db_set_str(enum tag_id id, const char *value)
+{
+    char *str = staging[id].str;
+
+    __ASSERT_NO_MSG(id < TAG_COUNT && tag_info[id].type == TAG_TYPE_STRING);
+
+    if (strncmp(str, value, TAG_STR_LEN - 1) != 0) {
+        strncpy(str, value, TAG_STR_LEN - 1);
+        str[TAG_STR_LEN - 1] = '\0';
+        tag_changed(id);
+    }
+}
+
+void tag_db_set_i32(enum tag_id id, int32_t value)
+{
+    __ASSERT_NO_MSG(id < TAG_COUNT && tag_info[id].type == TAG_TYPE_INT32);
+
+    if (staging[id].i32 != value) {
+        staging[id].i32 = value;
+        tag_changed(id);
+    }
+}
+
+void tag_db_set_u32(enum tag_id id, uint32_t value)
+{
+    __ASSERT_NO_MSG(id < TAG_COUNT && tag_info[id].type == TAG_TYPE_UINT32);
+
+    if (staging[id].u32 != value) {
+        staging[id].u32 = value;
+        tag_changed(id);
+    }
+}
+
+/* Copy the staged changes into one bank */
+static void bank_update(struct tag_value *bank, uint32_t mask)
+{
+    while (mask != 0) {
+        int id = find_lsb_set(mask) - 1;
+
+        bank[id] = staging[id];
+        mask &= ~BIT(id);
+    }
+}
+
+uint32_t tag_db_write_end(void)
+{
+    struct tag_listener *listener;
+    uint32_t changed = staged;
+
+    if (changed != 0) {
+        /* Odd: readers move to bank 1 while bank 0 is updated */
+        atomic_inc(&sequence);
+        barrier_dmem_fence_full();
+        bank_update(banks[0], changed);
+        barrier_dmem_fence_full();
+
+        /* Even: readers are back on bank 0 */
+        atomic_inc(&sequence);
+        barrier_dmem_fence_full();
+        bank_update(banks[1], changed);
+
+        /* Still locked, so listeners see changes in the order they were made */
+        SYS_SLIST_FOR_EACH_CONTAINER(&listeners, listener, node) {
+            uint32_t tags = changed & listener->tags;
+
+            if (tags == 0) {
+                continue;
+            }
+
+            tags &= ~(uint32_t)atomic_or(&listener->changed, tags);
+            if (tags != 0 && listener->notify != NULL) {
+                listener->notify(listener, tags);
+            }
+        }
+    }
+
+    k_mutex_unlock(&write_lock);
+
+    return changed;
+}
+
+void tag_db_listen(struct tag_listener *listener)
+{
+    k_mutex_lock(&write_lock, K_FOREVER);
+    sys_slist_append(&listeners, &listener->node);
+    k_mutex_unlock(&write_lock);
+}
+
+void tag_db_unlisten(struct tag_listener *listener)
+{
+    k_mutex_lock(&write_lock, K_FOREVER);
+    sys_slist_find_and_remove(&listeners, &listener->node);
+    k_mutex_unlock(&write_lock);
+}
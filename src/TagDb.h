@@ -0,0 +1,145 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TAG_DB_H
+#define TAG_DB_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/slist.h>
+#include <zephyr/sys/util.h>
+
+/* Longest string value, including the terminator */
+#define TAG_STR_LEN 16
+
+/**
+ * @brief Every value the application publishes
+ *
+ * The configuration tags are in DHCP_t order and the statistics tags in
+ * struct netstats order, so both map to tags by index.
+ */
+enum tag_id {
+    TAG_DHCP,
+    TAG_IP4_ADDRESS,
+    TAG_NETMASK,
+    TAG_CAN_1_0,
+    TAG_CAN_1_1,
+    TAG_CAN_1_2,
+    TAG_CAN_1_3,
+    TAG_CAN_2_0,
+    TAG_CAN_2_1,
+    TAG_CAN_2_2,
+    TAG_CAN_2_3,
+    TAG_BYTES_RECV,
+    TAG_BYTES_SENT,
+    TAG_IPV6_RECV,
+    TAG_IPV6_SENT,
+    TAG_IPV4_RECV,
+    TAG_IPV4_SENT,
+    TAG_TCP_RECV,
+    TAG_TCP_SENT,
+    TAG_COUNT,
+};
+
+#define TAG_CONFIG_FIRST TAG_DHCP
+#define TAG_CONFIG_COUNT (TAG_CAN_2_3 - TAG_DHCP + 1)
+#define TAG_STATS_FIRST  TAG_BYTES_RECV
+#define TAG_STATS_COUNT  (TAG_TCP_SENT - TAG_BYTES_RECV + 1)
+
+/* Sets of tags are bit masks */
+#define TAG_MASK(id)     BIT(id)
+#define TAG_MASK_CONFIG  GENMASK(TAG_CAN_2_3, TAG_DHCP)
+#define TAG_MASK_STATS   GENMASK(TAG_TCP_SENT, TAG_BYTES_RECV)
+#define TAG_MASK_ALL     GENMASK(TAG_COUNT - 1, 0)
+
+enum tag_type {
+    TAG_TYPE_STRING,
+    TAG_TYPE_INT32,
+    TAG_TYPE_UINT32,
+};
+
+struct tag_value {
+    union {
+        int32_t i32;
+        uint32_t u32;
+        char str[TAG_STR_LEN];
+    };
+    /** Incremented on every change of the value, 0 if never written */
+    uint32_t version;
+    /** Uptime in milliseconds of the last change */
+    int64_t timestamp;
+};
+
+/**
+ * @brief Told which tags changed
+ *
+ * Each listener has dirty bits of its own, so it only needs to look at
+ * the tags that changed since it last took them with tag_db_changes().
+ */
+struct tag_listener {
+    sys_snode_t node;
+    /** Tags of interest */
+    uint32_t tags;
+    /** Dirty bits, set by the writers */
+    atomic_t changed;
+    /**
+     * Optional, called from the writing thread with the tags that became
+     * dirty. Tags that were dirty already are not signalled again.
+     */
+    void (*notify)(struct tag_listener *listener, uint32_t tags);
+};
+
+const char *tag_name(enum tag_id id);
+
+enum tag_type tag_type(enum tag_id id);
+
+/**
+ * @brief Copy @p count tags starting at @p first into @p values
+ *
+ * Never blocks: all values are from the same committed write, a write
+ * running at the same time only makes the copy be taken again.
+ */
+void tag_db_read(enum tag_id first, size_t count, struct tag_value *values);
+
+/** Copy a single tag, see tag_db_read() */
+void tag_db_get(enum tag_id id, struct tag_value *value);
+
+/**
+ * @brief Start changing tags
+ *
+ * Writers are serialized. Changes become visible to readers all at once,
+ * in tag_db_write_end().
+ */
+void tag_db_write_begin(void);
+
+/** Set a string tag, values that do not fit are truncated */
+void tag_db_set_str(enum tag_id id, const char *value);
+
+void tag_db_set_i32(enum tag_id id, int32_t value);
+
+void tag_db_set_u32(enum tag_id id, uint32_t value);
+
+/**
+ * @brief Publish the changes and notify the listeners
+ *
+ * @return The tags whose value changed
+ */
+uint32_t tag_db_write_end(void);
+
+void tag_db_listen(struct tag_listener *listener);
+
+void tag_db_unlisten(struct tag_listener *listener);
+
+/** Take the dirty bits of @p listener */
+static inline uint32_t tag_db_changes(struct tag_listener *listener)
+{
+    return (uint32_t)atomic_clear(&listener->changed);
+}
+
+#endif /* TAG_DB_H */
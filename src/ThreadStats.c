@@ -0,0 +1,432 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <stdio.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/net/socket.h>
+#include <zephyr/net/websocket.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/sys/sys_heap.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#include "HTTPWebsocket.h"
+#include "LogLimit.h"
+#include "ThreadStats.h"
+#include "TrafficClass.h"
+#include "WsBuffers.h"
+
+APP_LOG_MODULE_REGISTER(thread_stats);
+
+#define INTERVAL    CONFIG_NET_SAMPLE_THREAD_STATS_INTERVAL
+#define MAX_THREADS CONFIG_NET_SAMPLE_THREAD_STATS_THREADS
+#define MAX_CLIENTS CONFIG_NET_SAMPLE_THREAD_STATS_CLIENTS
+
+/* Long enough for "ws[xx]", "sysworkq" and "http_server" */
+#define NAME_LEN 16
+
+/* The longest thread entry of the JSON object, with a 16 character name */
+#define THREAD_JSON_LEN 80
+#define JSON_LEN        (128 + MAX_THREADS * THREAD_JSON_LEN)
+
+struct thread_sample {
+    const struct k_thread *thread;
+    char name[NAME_LEN];
+    uint64_t cycles;
+    /** Share of the CPU over the last interval, in permille */
+    uint16_t cpu;
+    uint32_t stack_size;
+    /** High-water mark since the thread started */
+    uint32_t stack_used;
+};
+
+struct sample {
+    int64_t uptime;
+    /** Non-idle share of the CPU over the last interval, in permille */
+    uint16_t load;
+    uint32_t heap_size;
+    uint32_t heap_used;
+    uint32_t heap_max_used;
+    size_t thread_count;
+    /** Threads that did not fit in @threads */
+    size_t missed;
+    struct thread_sample threads[MAX_THREADS];
+};
+
+/* Published by the sample work, read by the shell and the feed */
+static struct sample latest;
+static K_MUTEX_DEFINE(latest_lock);
+
+/* Only used by the sample work */
+static struct sample next;
+static uint64_t all_cycles;
+static uint64_t busy_cycles;
+static char json[JSON_LEN];
+
+/* WebSocket clients, negative when the slot is free */
+static int clients[MAX_CLIENTS];
+/* Their receive buffers in thread_stats_ws_buffers */
+static int client_buffers[MAX_CLIENTS];
+/* The latest sample on its way to each client */
+static struct traffic_msg client_msgs[MAX_CLIENTS];
+
+struct new_client {
+    int sock;
+    int buffer;
+};
+
+/* Upgraded by the HTTP server, picked up at the next sample */
+K_MSGQ_DEFINE(thread_stats_new_clients, sizeof(struct new_client), MAX_CLIENTS, 4);
+
+static int thread_stats_ws_setup(int ws_socket, struct http_request_ctx *request_ctx,
+                                 void *user_data);
+
+/* The client only sends close frames */
+WS_BUFFER_POOL_DEFINE(thread_stats_ws_buffers, thread_stats_ws_setup, MAX_CLIENTS, 128);
+
+static void sample_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(sample_work, sample_handler);
+
+static uint16_t permille(uint64_t part, uint64_t whole)
+{
+    if (whole == 0) {
+        return 0;
+    }
+
+    return (uint16_t)MIN(part * 1000U / whole, 1000U);
+}
+
+static void thread_sample(const struct k_thread *cthread, void *user_data)
+{
+    struct k_thread *thread = (struct k_thread *)cthread;
+    struct sample *sample = user_data;
+    struct thread_sample *entry;
+    k_thread_runtime_stats_t runtime;
+    const char *name;
+    size_t unused;
+
+    if (sample->thread_count == MAX_THREADS) {
+        sample->missed++;
+        return;
+    }
+
+    entry = &sample->threads[sample->thread_count++];
+    entry->thread = thread;
+
+    name = k_thread_name_get(thread);
+    if (name != NULL && name[0] != '\0') {
+        snprintk(entry->name, sizeof(entry->name), "%s", name);
+    } else {
+        snprintk(entry->name, sizeof(entry->name), "%p", thread);
+    }
+
+    entry->stack_size = thread->stack_info.size;
+    if (k_thread_stack_space_get(thread, &unused) == 0) {
+        entry->stack_used = entry->stack_size - unused;
+    } else {
+        entry->stack_used = 0;
+    }
+
+    if (k_thread_runtime_stats_get(thread, &runtime) == 0) {
+        entry->cycles = runtime.execution_cycles;
+    } else {
+        entry->cycles = 0;
+    }
+}
+
+/* Cycles of @thread at the previous sample, 0 for a new thread */
+static uint64_t previous_cycles(const struct thread_sample *entry)
+{
+    for (size_t i = 0; i < latest.thread_count; i++) {
+        const struct thread_sample *previous = &latest.threads[i];
+
+        /* A new thread in the memory of an old one starts over */
+        if (previous->thread == entry->thread && previous->cycles <= entry->cycles) {
+            return previous->cycles;
+        }
+    }
+
+    return 0;
+}
+
+#if defined(CONFIG_SYS_HEAP_RUNTIME_STATS) && CONFIG_HEAP_MEM_POOL_SIZE > 0
+extern struct k_heap _system_heap;
+
+static void heap_sample(struct sample *sample)
+{
+    struct sys_memory_stats stats;
+
+    if (sys_heap_runtime_stats_get(&_system_heap.heap, &stats) < 0) {
+        return;
+    }
+
+    sample->heap_size = stats.free_bytes + stats.allocated_bytes;
+    sample->heap_used = stats.allocated_bytes;
+    sample->heap_max_used = stats.max_allocated_bytes;
+}
+#else
+static void heap_sample(struct sample *sample)
+{
+    sample->heap_size = 0;
+    sample->heap_used = 0;
+    sample->heap_max_used = 0;
+}
+#endif
+
+static void clients_adopt(void)
+{
+    struct new_client new_client;
+
+    while (k_msgq_get(&thread_stats_new_clients, &new_client, K_NO_WAIT) == 0) {
+        int slot;
+
+        /* The pool accepts no more connections than there are slots, and a
+         * slot is free once its buffer was given back
+         */
+        for (slot = 0; slot < MAX_CLIENTS; slot++) {
+            if (clients[slot] < 0) {
+                break;
+            }
+        }
+
+        clients[slot] = new_client.sock;
+        client_buffers[slot] = new_client.buffer;
+        LOG_INF("[%d] Thread statistics client connected", slot);
+    }
+}
+
+static void client_release(int slot)
+{
+    (void)websocket_unregister(clients[slot]);
+    ws_buffer_give(&thread_stats_ws_buffers, client_buffers[slot]);
+    clients[slot] = -1;
+}
+
+static void client_close(int slot)
+{
+    traffic_cancel(TRAFFIC_TELEMETRY, &client_msgs[slot]);
+    client_release(slot);
+}
+
+/* Clients only send to close, anything else is read and ignored */
+static bool client_alive(int slot)
+{
+    static uint8_t discard[64];
+    ssize_t ret;
+
+    do {
+        ret = recv(clients[slot], discard, sizeof(discard), MSG_DONTWAIT);
+    } while (ret > 0);
+
+    return ret < 0 && errno == EAGAIN;
+}
+
+/* Called on the telemetry work queue, like the sample work */
+static void client_sent(struct traffic_msg *msg, int ret)
+{
+    int slot = msg - client_msgs;
+
+    /* Not client_close(), which would wait for this very message */
+    if (ret < 0) {
+        LOG_INF("[%d] Couldn't send thread statistics (%d), closing connection", slot, ret);
+        client_release(slot);
+    }
+}
+
+static void clients_send(void)
+{
+    int len = -1;
+
+    clients_adopt();
+
+    for (int slot = 0; slot < MAX_CLIENTS; slot++) {
+        if (clients[slot] < 0) {
+            continue;
+        }
+
+        if (!client_alive(slot)) {
+            LOG_INF("[%d] Thread statistics client disconnected", slot);
+            client_close(slot);
+            continue;
+        }
+
+        /* A client still receiving the previous sample skips this one */
+        if (traffic_pending(TRAFFIC_TELEMETRY, &client_msgs[slot]) != 0) {
+            continue;
+        }
+
+        /* Collected once, for the first client */
+        if (len < 0) {
+            len = thread_stats_collect(json, sizeof(json));
+            if (len < 0) {
+                return;
+            }
+        }
+
+        client_msgs[slot].sock = clients[slot];
+        client_msgs[slot].len = len;
+        (void)traffic_send(TRAFFIC_TELEMETRY, &client_msgs[slot]);
+    }
+}
+
+static void sample_handler(struct k_work *work)
+{
+    k_thread_runtime_stats_t all;
+    uint64_t elapsed;
+
+    next.thread_count = 0;
+    next.missed = 0;
+    k_thread_foreach_unlocked(thread_sample, &next);
+
+    /* Execution cycles of all threads include the idle threads */
+    (void)k_thread_runtime_stats_all_get(&all);
+    elapsed = all.execution_cycles - all_cycles;
+    next.load = permille(all.total_cycles - busy_cycles, elapsed);
+    all_cycles = all.execution_cycles;
+    busy_cycles = all.total_cycles;
+
+    for (size_t i = 0; i < next.thread_count; i++) {
+        struct thread_sample *entry = &next.threads[i];
+
+        entry->cpu = permille(entry->cycles - previous_cycles(entry), elapsed);
+    }
+
+    heap_sample(&next);
+    next.uptime = k_uptime_get();
+
+    k_mutex_lock(&latest_lock, K_FOREVER);
+    latest = next;
+    k_mutex_unlock(&latest_lock);
+
+    clients_send();
+
+    k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY),
+                                k_work_delayable_from_work(work), K_MSEC(INTERVAL));
+}
+
+int thread_stats_collect(char *buf, size_t maxlen)
+{
+    size_t len;
+    int ret;
+
+    k_mutex_lock(&latest_lock, K_FOREVER);
+
+    ret = snprintf(buf, maxlen,
+                   "{\"uptime\":%lld,\"load\":%u,"
+                   "\"heap\":{\"size\":%u,\"used\":%u,\"max_used\":%u},\"threads\":[",
+                   (long long)latest.uptime, latest.load, latest.heap_size, latest.heap_used,
+                   latest.heap_max_used);
+    len = ret;
+
+    for (size_t i = 0; i < latest.thread_count && len < maxlen; i++) {
+        const struct thread_sample *entry = &latest.threads[i];
+
+        ret = snprintf(&buf[len], maxlen - len,
+                       "%s{\"name\":\"%s\",\"cpu\":%u,\"stack_size\":%u,\"stack_used\":%u}",
+                       i == 0 ? "" : ",", entry->name, entry->cpu, entry->stack_size,
+                       entry->stack_used);
+        len += ret;
+    }
+
+    k_mutex_unlock(&latest_lock);
+
+    if (len < maxlen) {
+        len += snprintf(&buf[len], maxlen - len, "]}");
+    }
+
+    if (len >= maxlen) {
+        LOG_ERR("Thread statistics do not fit in buffer");
+        return -ENOSPC;
+    }
+
+    return len;
+}
+
+#if defined(CONFIG_SHELL)
+static int cmd_stats_threads(const struct shell *sh, size_t argc, char **argv)
+{
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    k_mutex_lock(&latest_lock, K_FOREVER);
+
+    shell_print(sh, "%-16s %6s %15s", "Thread", "CPU", "Stack used");
+    for (size_t i = 0; i < latest.thread_count; i++) {
+        const struct thread_sample *entry = &latest.threads[i];
+
+        shell_print(sh, "%-16s %3u.%u%% %6u/%-6u %3u%%", entry->name, entry->cpu / 10,
+                    entry->cpu % 10, entry->stack_used, entry->stack_size,
+                    entry->stack_size != 0 ? entry->stack_used * 100 / entry->stack_size : 0);
+    }
+
+    if (latest.missed != 0) {
+        shell_print(sh, "%zu more threads, see CONFIG_NET_SAMPLE_THREAD_STATS_THREADS",
+                    latest.missed);
+    }
+
+    shell_print(sh, "CPU load %u.%u%% over %d ms, heap %u of %u bytes used, at most %u",
+                latest.load / 10, latest.load % 10, INTERVAL, latest.heap_used,
+                latest.heap_size, latest.heap_max_used);
+
+    k_mutex_unlock(&latest_lock);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(stats_cmds,
+    SHELL_CMD(threads, NULL, "CPU share and stack high-water mark of every thread",
+              cmd_stats_threads),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(stats, &stats_cmds, "Runtime statistics of the application", NULL);
+#endif /* CONFIG_SHELL */
+
+static int thread_stats_ws_setup(int ws_socket, struct http_request_ctx *request_ctx,
+                                 void *user_data)
+{
+    struct new_client new_client = {
+        .sock = ws_socket,
+    };
+
+    ARG_UNUSED(request_ctx);
+
+    new_client.buffer = ws_buffer_take(user_data);
+    if (new_client.buffer < 0) {
+        LOG_WRN_LIMITED("Cannot accept more thread statistics connections");
+        /* The caller closes the connection */
+        return -ENOENT;
+    }
+
+    /* Holds every connection the pool accepts */
+    (void)k_msgq_put(&thread_stats_new_clients, &new_client, K_NO_WAIT);
+
+    return 0;
+}
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(thread_stats_ws_resource, CONFIG_NET_SAMPLE_THREAD_STATS_PATH,
+                              &thread_stats_ws_buffers.detail);
+
+static int thread_stats_init(void)
+{
+    for (int i = 0; i < MAX_CLIENTS; i++) {
+        clients[i] = -1;
+        client_msgs[i].data = json;
+        client_msgs[i].sent = client_sent;
+    }
+
+    k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY), &sample_work,
+                                K_MSEC(INTERVAL));
+    return 0;
+}
+
+SYS_INIT(thread_stats_init, APPLICATION, 0);
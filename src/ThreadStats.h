@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef THREAD_STATS_H
+#define THREAD_STATS_H
+
+#include <stddef.h>
+
+/**
+ * @brief Collect the latest thread and heap statistics as a JSON object
+ *
+ * Threads are sampled every CONFIG_NET_SAMPLE_THREAD_STATS_INTERVAL
+ * milliseconds. CPU shares are in permille of that interval, stack usage
+ * is the high-water mark since the thread started:
+ *
+ * {"uptime":..,"load":..,"heap":{"size":..,"used":..,"max_used":..},
+ *  "threads":[{"name":"ws[0]","cpu":..,"stack_size":..,"stack_used":..}]}
+ *
+ * @param buf Output buffer
+ * @param maxlen Size of @p buf
+ *
+ * @return Length of the JSON string, or -ENOSPC if it does not fit
+ */
+int thread_stats_collect(char *buf, size_t maxlen);
+
+#endif /* THREAD_STATS_H */
@@ -0,0 +1,45 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "TokenBucket.h"
+
+void token_bucket_init(struct token_bucket *bucket, uint32_t rate, uint32_t burst)
+{
+    bucket->rate = rate;
+    bucket->burst = burst;
+    bucket->balance = (int64_t)burst * 1000;
+    bucket->updated = k_uptime_get();
+}
+
+void token_bucket_configure(struct token_bucket *bucket, uint32_t rate, uint32_t burst)
+{
+    bucket->rate = rate;
+    bucket->burst = burst;
+    bucket->balance = MIN(bucket->balance, (int64_t)burst * 1000);
+}
+
+uint32_t token_bucket_take(struct token_bucket *bucket, uint32_t tokens)
+{
+    int64_t now = k_uptime_get();
+
+    if (bucket->rate == 0) {
+        return 0;
+    }
+
+    /* rate tokens per second are rate thousandths per millisecond */
+    bucket->balance = MIN(bucket->balance + (now - bucket->updated) * bucket->rate,
+                          (int64_t)bucket->burst * 1000);
+    bucket->updated = now;
+    bucket->balance -= (int64_t)tokens * 1000;
+
+    if (bucket->balance >= 0) {
+        return 0;
+    }
+
+    return (uint32_t)DIV_ROUND_UP(-bucket->balance, bucket->rate);
+}
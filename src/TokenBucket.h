@@ -0,0 +1,56 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TOKEN_BUCKET_H
+#define TOKEN_BUCKET_H
+
+#include <stdint.h>
+
+/**
+ * @brief Rate limit of one client for one kind of work
+ *
+ * The bucket holds up to @p burst tokens and is refilled with @p rate
+ * tokens per second. Work takes its tokens even when there are not enough,
+ * the bucket then owes them and the client has to wait until it is paid
+ * back. That way work of unknown size, like a message of unknown length,
+ * is charged after it was received.
+ */
+struct token_bucket {
+    uint32_t rate;
+    uint32_t burst;
+    /** In thousandths of a token */
+    int64_t balance;
+    /** Uptime of the last refill in milliseconds */
+    int64_t updated;
+};
+
+/**
+ * @brief Set up a full bucket
+ *
+ * @param bucket Bucket to initialize
+ * @param rate Tokens per second, 0 for no limit
+ * @param burst Tokens that can be taken at once after the client was idle
+ */
+void token_bucket_init(struct token_bucket *bucket, uint32_t rate, uint32_t burst);
+
+/**
+ * @brief Change the limit of a bucket in use, keeping its balance
+ *
+ * @param bucket Bucket to change
+ * @param rate Tokens per second, 0 for no limit
+ * @param burst Tokens that can be taken at once after the client was idle
+ */
+void token_bucket_configure(struct token_bucket *bucket, uint32_t rate, uint32_t burst);
+
+/**
+ * @brief Take @p tokens from the bucket
+ *
+ * @return Milliseconds until the bucket no longer owes tokens, 0 if the
+ *         client is within its limit
+ */
+uint32_t token_bucket_take(struct token_bucket *bucket, uint32_t tokens);
+
+#endif /* TOKEN_BUCKET_H */
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/net/websocket.h>
+#include <zephyr/sys/slist.h>
+
+#include "TrafficClass.h"
+
+struct traffic {
+    struct k_work_q queue;
+    struct k_work drain;
+    sys_slist_t outbound;
+    /* Sent at the moment, without the lock */
+    struct traffic_msg *sending;
+    struct k_spinlock lock;
+    int32_t timeout;
+};
+
+static K_THREAD_STACK_DEFINE(control_stack, CONFIG_NET_SAMPLE_CONTROL_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(telemetry_stack, CONFIG_NET_SAMPLE_TELEMETRY_STACK_SIZE);
+
+static struct traffic classes[TRAFFIC_CLASS_COUNT] = {
+    [TRAFFIC_CONTROL] = {
+        .timeout = CONFIG_NET_SAMPLE_CONTROL_SEND_TIMEOUT,
+    },
+    [TRAFFIC_TELEMETRY] = {
+        .timeout = CONFIG_NET_SAMPLE_TELEMETRY_SEND_TIMEOUT,
+    },
+};
+
+/* One copy per message and turn, so a client with many pending copies
+ * cannot hold back the others
+ */
+static void drain_handler(struct k_work *work)
+{
+    struct traffic *traffic = CONTAINER_OF(work, struct traffic, drain);
+    struct traffic_msg *msg;
+    sys_snode_t *node;
+    k_spinlock_key_t key;
+    int ret;
+
+    while (true) {
+        key = k_spin_lock(&traffic->lock);
+        node = sys_slist_get(&traffic->outbound);
+        if (node == NULL) {
+            k_spin_unlock(&traffic->lock, key);
+            break;
+        }
+        msg = CONTAINER_OF(node, struct traffic_msg, node);
+        traffic->sending = msg;
+        k_spin_unlock(&traffic->lock, key);
+
+        ret = websocket_send_msg(msg->sock, msg->data, msg->len, WEBSOCKET_OPCODE_DATA_TEXT,
+                                 false, true, traffic->timeout);
+        if (msg->sent != NULL) {
+            msg->sent(msg, ret);
+        }
+
+        key = k_spin_lock(&traffic->lock);
+        if (ret < 0 || msg->pending <= 1) {
+            msg->pending = 0;
+        } else {
+            msg->pending--;
+            sys_slist_append(&traffic->outbound, &msg->node);
+        }
+        traffic->sending = NULL;
+        k_spin_unlock(&traffic->lock, key);
+    }
+}
+
+struct k_work_q *traffic_queue(enum traffic_class cls)
+{
+    return &classes[cls].queue;
+}
+
+uint32_t traffic_send(enum traffic_class cls, struct traffic_msg *msg)
+{
+    struct traffic *traffic = &classes[cls];
+    k_spinlock_key_t key;
+    uint32_t pending;
+
+    key = k_spin_lock(&traffic->lock);
+    /* A message being sent is queued again afterwards */
+    if (msg->pending == 0) {
+        sys_slist_append(&traffic->outbound, &msg->node);
+    }
+    pending = ++msg->pending;
+    k_spin_unlock(&traffic->lock, key);
+
+    k_work_submit_to_queue(&traffic->queue, &traffic->drain);
+
+    return pending;
+}
+
+uint32_t traffic_pending(enum traffic_class cls, const struct traffic_msg *msg)
+{
+    struct traffic *traffic = &classes[cls];
+    k_spinlock_key_t key;
+    uint32_t pending;
+
+    key = k_spin_lock(&traffic->lock);
+    pending = msg->pending;
+    k_spin_unlock(&traffic->lock, key);
+
+    return pending;
+}
+
+void traffic_cancel(enum traffic_class cls, struct traffic_msg *msg)
+{
+    struct traffic *traffic = &classes[cls];
+    k_spinlock_key_t key;
+
+    while (true) {
+        key = k_spin_lock(&traffic->lock);
+        if (traffic->sending != msg) {
+            if (msg->pending > 0) {
+                sys_slist_find_and_remove(&traffic->outbound, &msg->node);
+                msg->pending = 0;
+            }
+            k_spin_unlock(&traffic->lock, key);
+            return;
+        }
+        k_spin_unlock(&traffic->lock, key);
+
+        k_msleep(1);
+    }
+}
+
+static void traffic_start(enum traffic_class cls, k_thread_stack_t *stack, size_t stack_size,
+                          int priority, const char *name)
+{
+    const struct k_work_queue_config cfg = {
+        .name = name,
+    };
+
+    sys_slist_init(&classes[cls].outbound);
+    k_work_init(&classes[cls].drain, drain_handler);
+    k_work_queue_start(&classes[cls].queue, stack, stack_size, priority, &cfg);
+}
+
+#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
+BUILD_ASSERT(CONFIG_NUM_COOP_PRIORITIES >= 2,
+             "control needs a cooperative priority above the protocol threads");
+#endif
+
+static int traffic_class_init(void)
+{
+    traffic_start(TRAFFIC_CONTROL, control_stack, K_THREAD_STACK_SIZEOF(control_stack),
+                  TRAFFIC_CONTROL_PRIORITY, "control");
+    traffic_start(TRAFFIC_TELEMETRY, telemetry_stack, K_THREAD_STACK_SIZEOF(telemetry_stack),
+                  TRAFFIC_TELEMETRY_PRIORITY, "telemetry");
+
+    return 0;
+}
+
+/* Started before the APPLICATION level modules schedule work on the queues */
+SYS_INIT(traffic_class_init, POST_KERNEL, CONFIG_KERNEL_INIT_PRIORITY_DEFAULT);
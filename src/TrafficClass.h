@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef TRAFFIC_CLASS_H
+#define TRAFFIC_CLASS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+/**
+ * @brief Kinds of work, each served by a work queue of its own priority
+ */
+enum traffic_class {
+    /** Configuration writes and their acknowledgements */
+    TRAFFIC_CONTROL,
+    /** Statistics sampled and streamed to dashboards */
+    TRAFFIC_TELEMETRY,
+    TRAFFIC_CLASS_COUNT,
+};
+
+/*
+ * Thread priorities of the classes. With cooperative network threads the
+ * request and protocol threads run at the lowest cooperative priority, so
+ * control takes the one above it and stays ahead of them there too.
+ */
+#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
+#define TRAFFIC_CONTROL_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 2)
+#else
+#define TRAFFIC_CONTROL_PRIORITY K_PRIO_PREEMPT(CONFIG_NET_SAMPLE_CONTROL_PRIORITY)
+#endif
+#define TRAFFIC_TELEMETRY_PRIORITY K_PRIO_PREEMPT(CONFIG_NET_SAMPLE_TELEMETRY_PRIORITY)
+
+/**
+ * @brief A websocket message waiting in the outbound queue of a class
+ *
+ * Owned by the caller, the data must stay valid until the message was sent.
+ */
+struct traffic_msg {
+    sys_snode_t node;
+    int sock;
+    const void *data;
+    size_t len;
+    /** Copies still to be sent, the message is queued while non-zero */
+    uint32_t pending;
+    /** Called on the work queue of the class with the result of each copy, may be NULL */
+    void (*sent)(struct traffic_msg *msg, int ret);
+};
+
+/**
+ * @brief Work queue of @p cls
+ */
+struct k_work_q *traffic_queue(enum traffic_class cls);
+
+/**
+ * @brief Queue one more copy of @p msg for sending on the work queue of @p cls
+ *
+ * Queued messages take turns, one copy each. A failed send drops the
+ * copies still pending.
+ *
+ * @return Copies pending including this one
+ */
+uint32_t traffic_send(enum traffic_class cls, struct traffic_msg *msg);
+
+/**
+ * @brief Copies of @p msg still to be sent
+ */
+uint32_t traffic_pending(enum traffic_class cls, const struct traffic_msg *msg);
+
+/**
+ * @brief Drop the pending copies of @p msg before its socket is closed
+ *
+ * Waits for a copy being sent at the moment, that is bounded by the send
+ * timeout of the class.
+ */
+void traffic_cancel(enum traffic_class cls, struct traffic_msg *msg);
+
+#endif /* TRAFFIC_CLASS_H */
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "WebAssets.h"
+
+#include <string.h>
+#include <strings.h>
+
+#if defined(CONFIG_HTTP_SERVER_CAPTURE_HEADERS)
+HTTP_SERVER_REGISTER_HEADER_CAPTURE(capture_accept_encoding, "Accept-Encoding");
+#endif
+
+static const struct http_header identity_headers[] = {
+    { .name = "Vary", .value = "Accept-Encoding" },
+};
+
+static const struct http_header gzip_headers[] = {
+    { .name = "Content-Encoding", .value = "gzip" },
+    { .name = "Vary", .value = "Accept-Encoding" },
+};
+
+static const struct http_header brotli_headers[] = {
+    { .name = "Content-Encoding", .value = "br" },
+    { .name = "Vary", .value = "Accept-Encoding" },
+};
+
+/* True if the q-value starting at @param (just after ';') is zero. */
+static bool is_q_zero(const char *param, const char *end)
+{
+    while (param < end && *param == ' ') {
+        param++;
+    }
+
+    if (end - param < 3 || strncmp(param, "q=0", 3) != 0) {
+        return false;
+    }
+
+    for (param += 3; param < end; param++) {
+        if (*param != '.' && *param != '0' && *param != ' ') {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool header_accepts(const char *value, const char *coding)
+{
+    size_t len = strlen(coding);
+
+    while (*value != '\0') {
+        const char *end;
+        const char *param;
+        const char *name_end;
+
+        while (*value == ' ' || *value == ',') {
+            value++;
+        }
+
+        end = strchr(value, ',');
+        if (end == NULL) {
+            end = value + strlen(value);
+        }
+
+        param = memchr(value, ';', end - value);
+        name_end = param != NULL ? param : end;
+        while (name_end > value && name_end[-1] == ' ') {
+            name_end--;
+        }
+
+        if ((size_t)(name_end - value) == len &&
+            strncasecmp(value, coding, len) == 0) {
+            return param == NULL || !is_q_zero(param + 1, end);
+        }
+
+        value = end;
+    }
+
+    return false;
+}
+
+bool web_asset_accepts_encoding(const struct http_request_ctx *request_ctx,
+                                const char *coding)
+{
+    if (request_ctx->headers_status != HTTP_HEADER_STATUS_OK) {
+        return false;
+    }
+
+    for (size_t i = 0; i < request_ctx->header_count; i++) {
+        if (strcasecmp(request_ctx->headers[i].name, "Accept-Encoding") == 0) {
+            return header_accepts(request_ctx->headers[i].value, coding);
+        }
+    }
+
+    return false;
+}
+
+void web_asset_respond(const struct web_asset *asset,
+                       const struct http_request_ctx *request_ctx,
+                       struct http_response_ctx *response_ctx)
+{
+    response_ctx->status = HTTP_200_OK;
+    response_ctx->final_chunk = true;
+
+    if (asset->brotli != NULL && web_asset_accepts_encoding(request_ctx, "br")) {
+        response_ctx->headers = brotli_headers;
+        response_ctx->header_count = ARRAY_SIZE(brotli_headers);
+        response_ctx->body = asset->brotli;
+        response_ctx->body_len = asset->brotli_len;
+        return;
+    }
+
+    if (asset->encoding != NULL) {
+        response_ctx->headers = gzip_headers;
+        response_ctx->header_count = ARRAY_SIZE(gzip_headers);
+    } else {
+        response_ctx->headers = identity_headers;
+        response_ctx->header_count = ARRAY_SIZE(identity_headers);
+    }
+
+    response_ctx->body = asset->data;
+    response_ctx->body_len = asset->len;
+}
+
+int web_asset_cb(struct http_client_ctx *client, enum http_data_status status,
+                 const struct http_request_ctx *request_ctx,
+                 struct http_response_ctx *response_ctx, void *user_data)
+{
+    ARG_UNUSED(client);
+
+    if (status == HTTP_SERVER_DATA_FINAL) {
+        web_asset_respond(user_data, request_ctx, response_ctx);
+    }
+
+    return 0;
+}
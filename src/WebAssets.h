@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef WEB_ASSETS_H
+#define WEB_ASSETS_H
+
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+
+/**
+ * @brief Built-in web asset generated from src/static_web_resources
+ *
+ * All pointers refer to const data in flash.
+ */
+struct web_asset {
+    /** File name relative to the web resource directory */
+    const char *file;
+    /** Content encoding of @ref data, NULL if stored as is */
+    const char *encoding;
+    const uint8_t *data;
+    size_t len;
+    /** Brotli variant, NULL if none was generated */
+    const uint8_t *brotli;
+    size_t brotli_len;
+};
+
+/**
+ * @brief Check whether a request lists a content coding in Accept-Encoding
+ *
+ * Needs CONFIG_HTTP_SERVER_CAPTURE_HEADERS, otherwise always false.
+ *
+ * @param request_ctx Request context of the current request
+ * @param coding Content coding to look for, e.g. "br"
+ *
+ * @return true if the coding is accepted with a non-zero q-value
+ */
+bool web_asset_accepts_encoding(const struct http_request_ctx *request_ctx,
+                                const char *coding);
+
+/**
+ * @brief Fill a response with a built-in asset in a single chunk
+ *
+ * Picks the Brotli variant when there is one and the client accepts it.
+ *
+ * @param asset Asset to send
+ * @param request_ctx Request context of the current request
+ * @param response_ctx Response to fill
+ */
+void web_asset_respond(const struct web_asset *asset,
+                       const struct http_request_ctx *request_ctx,
+                       struct http_response_ctx *response_ctx);
+
+/**
+ * @brief Dynamic resource callback serving a built-in asset
+ *
+ * @p user_data must point to the struct web_asset to serve.
+ */
+int web_asset_cb(struct http_client_ctx *client, enum http_data_status status,
+                 const struct http_request_ctx *request_ctx,
+                 struct http_response_ctx *response_ctx, void *user_data);
+
+#endif /* WEB_ASSETS_H */
@@ -0,0 +1,480 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "WebFS.h"
+#include "HTTPWebsocket.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/fs/fs.h>
+#include <zephyr/fs/littlefs.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+APP_LOG_MODULE_REGISTER(webfs);
+
+#if !DT_NODE_EXISTS(DT_NODELABEL(web_partition))
+#error "web_partition node not found in devicetree!"
+#endif
+
+#define WEB_FS_MOUNT_POINT CONFIG_NET_SAMPLE_WEB_FS_MOUNT_POINT
+#define WEB_FS_URL_PREFIX "/webfs/"
+#define WEB_FS_PATH_MAX (sizeof(WEB_FS_MOUNT_POINT "/.tmp") + \
+                         CONFIG_NET_SAMPLE_WEB_FS_NAME_MAX)
+#define CHUNK_SIZE CONFIG_NET_SAMPLE_WEB_FS_CHUNK_SIZE
+
+FS_LITTLEFS_DECLARE_DEFAULT_CONFIG(web_fs_data);
+
+static struct fs_mount_t web_fs_mount = {
+    .type = FS_LITTLEFS,
+    .fs_data = &web_fs_data,
+    .storage_dev = (void *)FIXED_PARTITION_ID(web_partition),
+    .mnt_point = WEB_FS_MOUNT_POINT,
+};
+
+/* Chunk buffers shared by every response streamed from the web partition.
+ * Peak RAM is bounded by the pool, not by the size of the files served.
+ */
+K_MEM_SLAB_DEFINE_STATIC(web_fs_chunks, CHUNK_SIZE,
+                         CONFIG_NET_SAMPLE_WEB_FS_CHUNK_COUNT, 4);
+
+static bool web_fs_mounted;
+static bool web_fs_populated;
+
+/* One upload at a time, a PUT from another client meanwhile gets 409 */
+static struct web_fs_upload {
+    /* Client whose body is being written, NULL while idle */
+    struct http_client_ctx *client;
+    struct fs_file_t file;
+    bool open;
+    int error;
+    size_t written;
+} upload;
+
+static struct web_fs_stream file_stream;
+
+static const struct {
+    const char *ext;
+    const char *type;
+} content_types[] = {
+    { ".html", "text/html" },
+    { ".js", "text/javascript" },
+    { ".css", "text/css" },
+    { ".json", "application/json" },
+    { ".svg", "image/svg+xml" },
+    { ".png", "image/png" },
+    { ".ico", "image/x-icon" },
+    { ".txt", "text/plain" },
+};
+
+static void stream_close(struct web_fs_stream *stream)
+{
+    if (stream->open) {
+        (void)fs_close(&stream->file);
+        stream->open = false;
+    }
+
+    if (stream->chunk != NULL) {
+        k_mem_slab_free(&web_fs_chunks, stream->chunk);
+        stream->chunk = NULL;
+    }
+}
+
+static bool web_fs_has_files(void)
+{
+    struct fs_dir_t dir;
+    struct fs_dirent entry;
+    bool found = false;
+
+    fs_dir_t_init(&dir);
+    if (fs_opendir(&dir, WEB_FS_MOUNT_POINT) < 0) {
+        return false;
+    }
+
+    while (fs_readdir(&dir, &entry) == 0 && entry.name[0] != '\0') {
+        if (entry.type == FS_DIR_ENTRY_FILE) {
+            found = true;
+            break;
+        }
+    }
+
+    (void)fs_closedir(&dir);
+
+    return found;
+}
+
+static const char *content_type_of(const char *name)
+{
+    const char *ext = strrchr(name, '.');
+
+    if (ext != NULL) {
+        for (size_t i = 0; i < ARRAY_SIZE(content_types); i++) {
+            if (strcmp(ext, content_types[i].ext) == 0) {
+                return content_types[i].type;
+            }
+        }
+    }
+
+    return "application/octet-stream";
+}
+
+static bool valid_name(const char *name)
+{
+    size_t len = strlen(name);
+
+    return len > 0 && len <= CONFIG_NET_SAMPLE_WEB_FS_NAME_MAX &&
+           strchr(name, '/') == NULL && strstr(name, "..") == NULL;
+}
+
+/* Open "<name>.gz" if the client accepts gzip, else "<name>", and borrow a
+ * chunk buffer for it. Returns -ENOTSUP if there only is a "<name>.gz".
+ */
+static int stream_open(struct web_fs_stream *stream, const char *name,
+                       const struct http_request_ctx *request_ctx)
+{
+    char path[WEB_FS_PATH_MAX];
+    const char *encoding = NULL;
+    struct fs_dirent entry;
+    off_t size;
+    int ret = -ENOENT;
+
+    fs_file_t_init(&stream->file);
+
+    if (web_asset_accepts_encoding(request_ctx, "gzip")) {
+        snprintk(path, sizeof(path), "%s/%s.gz", WEB_FS_MOUNT_POINT, name);
+        ret = fs_open(&stream->file, path, FS_O_READ);
+        encoding = "gzip";
+    }
+
+    if (ret < 0) {
+        encoding = NULL;
+        snprintk(path, sizeof(path), "%s/%s", WEB_FS_MOUNT_POINT, name);
+        ret = fs_open(&stream->file, path, FS_O_READ);
+        if (ret < 0) {
+            /* Only stored compressed, which this client cannot decode */
+            snprintk(path, sizeof(path), "%s/%s.gz", WEB_FS_MOUNT_POINT, name);
+            return fs_stat(path, &entry) == 0 ? -ENOTSUP : ret;
+        }
+    }
+
+    stream->open = true;
+
+    ret = fs_seek(&stream->file, 0, FS_SEEK_END);
+    size = fs_tell(&stream->file);
+    if (ret < 0 || size < 0 || fs_seek(&stream->file, 0, FS_SEEK_SET) < 0) {
+        stream_close(stream);
+        return -EIO;
+    }
+
+    ret = k_mem_slab_alloc(&web_fs_chunks, &stream->chunk, K_NO_WAIT);
+    if (ret < 0) {
+        LOG_WRN("No free chunk buffer for %s", name);
+        stream->chunk = NULL;
+        stream_close(stream);
+        return -ENOMEM;
+    }
+
+    stream->remaining = size;
+    stream->headers[0].name = "Content-Type";
+    stream->headers[0].value = content_type_of(name);
+    stream->headers[1].name = "Vary";
+    stream->headers[1].value = "Accept-Encoding";
+    stream->headers[2].name = "Content-Encoding";
+    stream->headers[2].value = encoding;
+
+    return 0;
+}
+
+/* The server sends a chunk after the callback has returned, so the last
+ * one with data is followed by an empty final chunk. The server asks for
+ * that once the data went out, and the buffer goes back to the pool then.
+ */
+static int stream_next(struct web_fs_stream *stream,
+                       struct http_response_ctx *response_ctx)
+{
+    ssize_t len = 0;
+
+    if (stream->remaining > 0) {
+        len = fs_read(&stream->file, stream->chunk, MIN(stream->remaining, CHUNK_SIZE));
+        if (len < 0) {
+            LOG_ERR("Failed to read web file (%d)", (int)len);
+            stream_close(stream);
+            return len;
+        }
+    }
+
+    if (len == 0) {
+        stream_close(stream);
+        response_ctx->body = NULL;
+        response_ctx->body_len = 0;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    stream->remaining -= len;
+
+    response_ctx->body = stream->chunk;
+    response_ctx->body_len = len;
+    response_ctx->final_chunk = false;
+
+    return 0;
+}
+
+/* Headers go out with the first chunk only. Built-in resources already
+ * carry their content type in the resource detail.
+ */
+static void stream_respond_first(struct web_fs_stream *stream, bool content_type,
+                                 struct http_response_ctx *response_ctx)
+{
+    size_t count = stream->headers[2].value != NULL ? 3 : 2;
+
+    response_ctx->status = HTTP_200_OK;
+    response_ctx->headers = content_type ? &stream->headers[0] : &stream->headers[1];
+    response_ctx->header_count = content_type ? count : count - 1;
+}
+
+int web_fs_asset_cb(struct http_client_ctx *client, enum http_data_status status,
+                    const struct http_request_ctx *request_ctx,
+                    struct http_response_ctx *response_ctx, void *user_data)
+{
+    struct web_fs_stream *stream = user_data;
+
+    ARG_UNUSED(client);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        stream_close(stream);
+        return 0;
+    }
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    if (!stream->open) {
+        if (!web_fs_populated || stream_open(stream, stream->asset->file, request_ctx) < 0) {
+            web_asset_respond(stream->asset, request_ctx, response_ctx);
+            return 0;
+        }
+
+        stream_respond_first(stream, false, response_ctx);
+    }
+
+    return stream_next(stream, response_ctx);
+}
+
+static void upload_abort(void)
+{
+    if (upload.open) {
+        (void)fs_close(&upload.file);
+        upload.open = false;
+    }
+
+    upload.error = 0;
+    upload.client = NULL;
+}
+
+static int upload_data(const char *name, const struct http_request_ctx *request_ctx)
+{
+    char path[WEB_FS_PATH_MAX];
+    ssize_t len;
+
+    if (upload.error != 0) {
+        return upload.error;
+    }
+
+    if (!upload.open) {
+        snprintk(path, sizeof(path), "%s/%s.tmp", WEB_FS_MOUNT_POINT, name);
+        (void)fs_unlink(path);
+
+        fs_file_t_init(&upload.file);
+        upload.error = fs_open(&upload.file, path, FS_O_CREATE | FS_O_WRITE);
+        if (upload.error < 0) {
+            return upload.error;
+        }
+
+        upload.open = true;
+        upload.written = 0;
+    }
+
+    if (request_ctx->data_len == 0) {
+        return 0;
+    }
+
+    len = fs_write(&upload.file, request_ctx->data, request_ctx->data_len);
+    if (len < 0 || (size_t)len != request_ctx->data_len) {
+        upload.error = len < 0 ? len : -ENOSPC;
+        return upload.error;
+    }
+
+    upload.written += len;
+
+    return 0;
+}
+
+/* Replace the file atomically once the whole body has been written */
+static enum http_status upload_finish(const char *name)
+{
+    char tmp[WEB_FS_PATH_MAX];
+    char path[WEB_FS_PATH_MAX];
+    int ret = upload.error;
+
+    snprintk(tmp, sizeof(tmp), "%s/%s.tmp", WEB_FS_MOUNT_POINT, name);
+    snprintk(path, sizeof(path), "%s/%s", WEB_FS_MOUNT_POINT, name);
+
+    if (upload.open) {
+        upload.open = false;
+        if (fs_close(&upload.file) < 0 && ret == 0) {
+            ret = -EIO;
+        }
+    }
+
+    if (ret == 0) {
+        ret = fs_rename(tmp, path);
+    }
+
+    upload.error = 0;
+    upload.client = NULL;
+
+    if (ret < 0) {
+        LOG_ERR("Upload of %s failed (%d)", name, ret);
+        (void)fs_unlink(tmp);
+        return ret == -ENOSPC ? HTTP_507_INSUFFICIENT_STORAGE :
+                                HTTP_500_INTERNAL_SERVER_ERROR;
+    }
+
+    LOG_INF("Stored %s (%zu bytes)", name, upload.written);
+    web_fs_populated = true;
+
+    return HTTP_201_CREATED;
+}
+
+static enum http_status delete_file(const char *name)
+{
+    char path[WEB_FS_PATH_MAX];
+
+    snprintk(path, sizeof(path), "%s/%s", WEB_FS_MOUNT_POINT, name);
+    if (fs_unlink(path) < 0) {
+        return HTTP_404_NOT_FOUND;
+    }
+
+    web_fs_populated = web_fs_has_files();
+
+    return HTTP_204_NO_CONTENT;
+}
+
+/* GET, PUT and DELETE of individual files below /webfs/ */
+static int web_fs_file_cb(struct http_client_ctx *client, enum http_data_status status,
+                          const struct http_request_ctx *request_ctx,
+                          struct http_response_ctx *response_ctx, void *user_data)
+{
+    const char *name = (const char *)client->url_buffer + strlen(WEB_FS_URL_PREFIX);
+    int ret;
+
+    ARG_UNUSED(user_data);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        stream_close(&file_stream);
+        if (upload.client == client) {
+            upload_abort();
+        }
+        return 0;
+    }
+
+    if (!web_fs_mounted || !valid_name(name)) {
+        if (status == HTTP_SERVER_DATA_FINAL) {
+            response_ctx->status = web_fs_mounted ? HTTP_400_BAD_REQUEST :
+                                                    HTTP_503_SERVICE_UNAVAILABLE;
+            response_ctx->final_chunk = true;
+        }
+        return 0;
+    }
+
+    switch (client->method) {
+    case HTTP_GET:
+        if (status != HTTP_SERVER_DATA_FINAL) {
+            return 0;
+        }
+
+        if (!file_stream.open) {
+            ret = stream_open(&file_stream, name, request_ctx);
+            if (ret < 0) {
+                response_ctx->status = ret == -ENOMEM  ? HTTP_503_SERVICE_UNAVAILABLE :
+                                       ret == -ENOTSUP ? HTTP_406_NOT_ACCEPTABLE :
+                                                         HTTP_404_NOT_FOUND;
+                response_ctx->final_chunk = true;
+                return 0;
+            }
+
+            stream_respond_first(&file_stream, true, response_ctx);
+        }
+
+        return stream_next(&file_stream, response_ctx);
+
+    case HTTP_PUT:
+        if (upload.client != NULL && upload.client != client) {
+            if (status == HTTP_SERVER_DATA_FINAL) {
+                response_ctx->status = HTTP_409_CONFLICT;
+                response_ctx->final_chunk = true;
+            }
+            return 0;
+        }
+
+        upload.client = client;
+        (void)upload_data(name, request_ctx);
+        if (status == HTTP_SERVER_DATA_FINAL) {
+            response_ctx->status = upload_finish(name);
+            response_ctx->final_chunk = true;
+        }
+        return 0;
+
+    case HTTP_DELETE:
+        if (status == HTTP_SERVER_DATA_FINAL) {
+            response_ctx->status = delete_file(name);
+            response_ctx->final_chunk = true;
+        }
+        return 0;
+
+    default:
+        return -ENOTSUP;
+    }
+}
+
+static struct http_resource_detail_dynamic web_fs_file_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods =
+            BIT(HTTP_GET) | BIT(HTTP_PUT) | BIT(HTTP_DELETE),
+    },
+    .cb = web_fs_file_cb,
+    .user_data = NULL,
+};
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(web_fs_file_resource, WEB_FS_URL_PREFIX "*",
+                              &web_fs_file_detail);
+
+static int web_fs_init(void)
+{
+    int ret;
+
+    ret = fs_mount(&web_fs_mount);
+    if (ret < 0) {
+        LOG_ERR("Failed to mount web partition at %s: %d", WEB_FS_MOUNT_POINT, ret);
+        return 0;
+    }
+
+    web_fs_mounted = true;
+    web_fs_populated = web_fs_has_files();
+
+    LOG_INF("Web partition mounted at %s, %s", WEB_FS_MOUNT_POINT,
+            web_fs_populated ? "serving UI from it" : "empty, using built-in UI");
+
+    return 0;
+}
+
+SYS_INIT(web_fs_init, APPLICATION, 0);
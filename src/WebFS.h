@@ -0,0 +1,44 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef WEB_FS_H
+#define WEB_FS_H
+
+#include <zephyr/fs/fs.h>
+#include <zephyr/net/http/server.h>
+
+#include "WebAssets.h"
+
+/**
+ * @brief Per-resource streaming state
+ *
+ * The HTTP server hands a dynamic resource to one client at a time, so a
+ * single stream per resource is enough. File data goes through chunk
+ * buffers borrowed from a shared pool for the duration of a response.
+ */
+struct web_fs_stream {
+    /** Built-in copy served when the file is not on the web partition */
+    const struct web_asset *asset;
+    struct fs_file_t file;
+    bool open;
+    size_t remaining;
+    void *chunk;
+    struct http_header headers[3];
+};
+
+/**
+ * @brief Dynamic resource callback serving a web asset from the web partition
+ *
+ * Streams "<file>.gz" to clients that accept gzip, or "<file>", from the
+ * LittleFS web partition in fixed size chunks, and falls back to the
+ * built-in asset when neither can be served.
+ * @p user_data must point to a struct web_fs_stream.
+ */
+int web_fs_asset_cb(struct http_client_ctx *client, enum http_data_status status,
+                    const struct http_request_ctx *request_ctx,
+                    struct http_response_ctx *response_ctx, void *user_data);
+
+#endif /* WEB_FS_H */
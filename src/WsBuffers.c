@@ -0,0 +1,30 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+
+#include "WsBuffers.h"
+
+int ws_buffer_take(struct ws_buffer_pool *pool)
+{
+    int taken = (pool->detail.data_buffer - pool->buffers) / pool->size;
+
+    /* Another one has to be left for the next upgrade */
+    for (size_t i = 0; i < pool->count; i++) {
+        if ((int)i != taken && !atomic_test_bit(&pool->owned, i)) {
+            atomic_set_bit(&pool->owned, taken);
+            pool->detail.data_buffer = &pool->buffers[i * pool->size];
+            return taken;
+        }
+    }
+
+    return -ENOMEM;
+}
+
+void ws_buffer_give(struct ws_buffer_pool *pool, int buffer)
+{
+    atomic_clear_bit(&pool->owned, buffer);
+}
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef WS_BUFFERS_H
+#define WS_BUFFERS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/net/http/server.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * @brief A WebSocket resource whose connections each get a receive buffer
+ *
+ * The HTTP server registers every connection upgraded on a resource with
+ * the data_buffer of its detail, where the WebSocket layer keeps the frame
+ * bytes it read but not yet returned. The pool has one buffer more than
+ * the connections it serves and keeps the detail pointing at one that no
+ * connection owns, so a connection never shares its buffer.
+ *
+ * Only the HTTP server thread changes the detail, in the setup callback
+ * right after the upgrade it was read for.
+ */
+struct ws_buffer_pool {
+    struct http_resource_detail_websocket detail;
+    uint8_t *buffers;
+    size_t size;
+    size_t count;
+    /** Bit n is set while buffer n is owned by a connection */
+    atomic_t owned;
+};
+
+/**
+ * @brief Define @p _name, a WebSocket resource detail for
+ *        HTTP_RESOURCE_DEFINE() as @p _name.detail
+ *
+ * @p _setup gets the pool as its user data and calls ws_buffer_take() for
+ * each connection it accepts, which limits them to @p _connections.
+ */
+#define WS_BUFFER_POOL_DEFINE(_name, _setup, _connections, _size)               \
+    BUILD_ASSERT((_connections) < ATOMIC_BITS, "too many connections");         \
+    static uint8_t _name##_buffers[(_connections) + 1][_size];                  \
+    static struct ws_buffer_pool _name = {                                      \
+        .detail = {                                                             \
+            .common = {                                                         \
+                .type = HTTP_RESOURCE_TYPE_WEBSOCKET,                           \
+                .bitmask_of_supported_http_methods = BIT(HTTP_GET),             \
+            },                                                                  \
+            .cb = _setup,                                                       \
+            .data_buffer = _name##_buffers[0],                                  \
+            .data_buffer_len = (_size),                                         \
+            .user_data = &_name,                                                \
+        },                                                                      \
+        .buffers = &_name##_buffers[0][0],                                      \
+        .size = (_size),                                                        \
+        .count = (_connections) + 1,                                            \
+    }
+
+/**
+ * @brief Keep the buffer the connection being set up was registered with
+ *
+ * Called from the setup callback of the resource.
+ *
+ * @return The buffer to give back with ws_buffer_give(), or -ENOMEM if the
+ *         pool already serves as many connections as it was defined for
+ */
+int ws_buffer_take(struct ws_buffer_pool *pool);
+
+/**
+ * @brief Give back the buffer of a connection once it was unregistered
+ */
+void ws_buffer_give(struct ws_buffer_pool *pool, int buffer);
+
+#endif /* WS_BUFFERS_H */
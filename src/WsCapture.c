@@ -0,0 +1,228 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/net/http/server.h>
+#include <zephyr/net/http/service.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/logging/log.h>
+#include "AppLog.h"
+
+#include "HTTPWebsocket.h"
+#include "WsCapture.h"
+
+APP_LOG_MODULE_REGISTER(ws_capture);
+
+#define RING_SIZE CONFIG_NET_SAMPLE_WS_CAPTURE_SIZE
+
+#define RECORD_MAX (sizeof(struct ws_capture_record) + WS_CAPTURE_PAYLOAD_MAX)
+
+BUILD_ASSERT(RING_SIZE >= 2 * RECORD_MAX, "NET_SAMPLE_WS_CAPTURE_SIZE too small");
+
+/* Records back to back, the oldest are overwritten. Positions only ever
+ * grow and are taken modulo the size, so a download can tell whether the
+ * record it was about to send has been overwritten meanwhile.
+ */
+static uint8_t ring[RING_SIZE];
+static uint32_t head;
+static uint32_t tail;
+static uint32_t dropped;
+static K_MUTEX_DEFINE(ring_lock);
+
+static atomic_t connections;
+
+/* The server hands the resource to one client at a time */
+static struct {
+    bool open;
+    uint32_t cursor;
+    uint32_t end;
+    uint8_t chunk[RECORD_MAX];
+} download;
+
+static void ring_write(uint32_t pos, const void *data, size_t len)
+{
+    size_t offset = pos % RING_SIZE;
+    size_t first = MIN(len, RING_SIZE - offset);
+
+    memcpy(&ring[offset], data, first);
+    memcpy(ring, (const uint8_t *)data + first, len - first);
+}
+
+static void ring_read(uint32_t pos, void *data, size_t len)
+{
+    size_t offset = pos % RING_SIZE;
+    size_t first = MIN(len, RING_SIZE - offset);
+
+    memcpy(data, &ring[offset], first);
+    memcpy((uint8_t *)data + first, ring, len - first);
+}
+
+static uint32_t record_size_at(uint32_t pos)
+{
+    struct ws_capture_record record;
+
+    ring_read(pos, &record, sizeof(record));
+    return sizeof(record) + sys_le16_to_cpu(record.len);
+}
+
+static void capture(uint32_t connection, enum ws_capture_event event,
+                    const void *data, size_t len)
+{
+    struct ws_capture_record record = {
+        .time_us = sys_cpu_to_le64(k_ticks_to_us_floor64(k_uptime_ticks())),
+        .connection = sys_cpu_to_le32(connection),
+        .event = event,
+    };
+
+    if (len > WS_CAPTURE_PAYLOAD_MAX) {
+        len = WS_CAPTURE_PAYLOAD_MAX;
+        record.flags |= WS_CAPTURE_TRUNCATED;
+    }
+    record.len = sys_cpu_to_le16(len);
+
+    k_mutex_lock(&ring_lock, K_FOREVER);
+
+    while (head - tail + sizeof(record) + len > RING_SIZE) {
+        tail += record_size_at(tail);
+        dropped++;
+    }
+
+    ring_write(head, &record, sizeof(record));
+    if (len > 0) {
+        ring_write(head + sizeof(record), data, len);
+    }
+    head += sizeof(record) + len;
+
+    k_mutex_unlock(&ring_lock);
+}
+
+uint32_t ws_capture_open(void)
+{
+    uint32_t connection = atomic_inc(&connections) + 1;
+
+    capture(connection, WS_CAPTURE_OPEN, NULL, 0);
+    return connection;
+}
+
+void ws_capture_message(uint32_t connection, const void *data, size_t len)
+{
+    capture(connection, WS_CAPTURE_MESSAGE, data, len);
+}
+
+void ws_capture_close(uint32_t connection)
+{
+    capture(connection, WS_CAPTURE_CLOSE, NULL, 0);
+}
+
+/* The records present when the download started, whole ones per chunk */
+static size_t download_next(void)
+{
+    size_t len = 0;
+    uint32_t size;
+
+    k_mutex_lock(&ring_lock, K_FOREVER);
+
+    /* Overwritten while the previous chunks went out */
+    if ((int32_t)(download.cursor - tail) < 0) {
+        download.cursor = (int32_t)(download.end - tail) < 0 ? download.end : tail;
+    }
+
+    while (download.cursor != download.end) {
+        size = record_size_at(download.cursor);
+        if (len + size > sizeof(download.chunk)) {
+            break;
+        }
+        ring_read(download.cursor, &download.chunk[len], size);
+        download.cursor += size;
+        len += size;
+    }
+
+    k_mutex_unlock(&ring_lock);
+
+    return len;
+}
+
+static void download_start(void)
+{
+    struct ws_capture_file *file = (struct ws_capture_file *)download.chunk;
+
+    k_mutex_lock(&ring_lock, K_FOREVER);
+    download.cursor = tail;
+    download.end = head;
+    memcpy(file->magic, WS_CAPTURE_MAGIC, sizeof(file->magic));
+    file->version = sys_cpu_to_le16(WS_CAPTURE_VERSION);
+    file->record_size = sys_cpu_to_le32(sizeof(struct ws_capture_record));
+    file->dropped = sys_cpu_to_le32(dropped);
+    k_mutex_unlock(&ring_lock);
+
+    download.open = true;
+}
+
+static void clear(void)
+{
+    k_mutex_lock(&ring_lock, K_FOREVER);
+    tail = head;
+    dropped = 0;
+    k_mutex_unlock(&ring_lock);
+}
+
+static int capture_cb(struct http_client_ctx *client, enum http_data_status status,
+                      const struct http_request_ctx *request_ctx,
+                      struct http_response_ctx *response_ctx, void *user_data)
+{
+    ARG_UNUSED(request_ctx);
+    ARG_UNUSED(user_data);
+
+    if (status == HTTP_SERVER_DATA_ABORTED) {
+        download.open = false;
+        return 0;
+    }
+
+    if (status != HTTP_SERVER_DATA_FINAL) {
+        return 0;
+    }
+
+    if (client->method == HTTP_DELETE) {
+        clear();
+        response_ctx->status = HTTP_204_NO_CONTENT;
+        response_ctx->final_chunk = true;
+        return 0;
+    }
+
+    if (!download.open) {
+        download_start();
+        response_ctx->status = HTTP_200_OK;
+        response_ctx->body = download.chunk;
+        response_ctx->body_len = sizeof(struct ws_capture_file);
+        response_ctx->final_chunk = false;
+        return 0;
+    }
+
+    response_ctx->body = download.chunk;
+    response_ctx->body_len = download_next();
+    response_ctx->final_chunk = download.cursor == download.end;
+    if (response_ctx->final_chunk) {
+        download.open = false;
+    }
+
+    return 0;
+}
+
+static struct http_resource_detail_dynamic capture_resource_detail = {
+    .common = {
+        .type = HTTP_RESOURCE_TYPE_DYNAMIC,
+        .bitmask_of_supported_http_methods = BIT(HTTP_GET) | BIT(HTTP_DELETE),
+        .content_type = "application/octet-stream",
+    },
+    .cb = capture_cb,
+    .user_data = NULL,
+};
+
+HTTPWEBSOCKET_RESOURCE_DEFINE(capture_resource, CONFIG_NET_SAMPLE_WS_CAPTURE_PATH,
+                              &capture_resource_detail);
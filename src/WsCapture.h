@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef WS_CAPTURE_H
+#define WS_CAPTURE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <zephyr/toolchain.h>
+
+/* Longest message payload kept, the websocket receive buffer size */
+#define WS_CAPTURE_PAYLOAD_MAX 1280
+
+/* Start of a capture download, followed by the records oldest first */
+#define WS_CAPTURE_MAGIC "WSCAP"
+#define WS_CAPTURE_VERSION 1
+
+enum ws_capture_event {
+    WS_CAPTURE_MESSAGE = 0,
+    WS_CAPTURE_OPEN = 1,
+    WS_CAPTURE_CLOSE = 2,
+};
+
+/* The message was longer than WS_CAPTURE_PAYLOAD_MAX */
+#define WS_CAPTURE_TRUNCATED 0x01
+
+/**
+ * @brief Header of a download: magic, version, record header size and the
+ *        number of records overwritten since boot. Little endian.
+ */
+struct ws_capture_file {
+    char magic[6];
+    uint16_t version;
+    uint32_t record_size;
+    uint32_t dropped;
+} __packed;
+
+/**
+ * @brief A captured event, followed by @p len bytes of payload. Little endian.
+ */
+struct ws_capture_record {
+    /** Uptime in microseconds */
+    uint64_t time_us;
+    /** Numbered from 1 in the order the connections were accepted */
+    uint32_t connection;
+    uint16_t len;
+    /** enum ws_capture_event */
+    uint8_t event;
+    uint8_t flags;
+} __packed;
+
+#if defined(CONFIG_NET_SAMPLE_WS_CAPTURE)
+/**
+ * @brief Record a new connection
+ *
+ * @return Connection id for the other calls
+ */
+uint32_t ws_capture_open(void);
+
+/**
+ * @brief Record a message received on @p connection
+ */
+void ws_capture_message(uint32_t connection, const void *data, size_t len);
+
+/**
+ * @brief Record the end of @p connection
+ */
+void ws_capture_close(uint32_t connection);
+#else
+static inline uint32_t ws_capture_open(void)
+{
+    return 0;
+}
+
+static inline void ws_capture_message(uint32_t connection, const void *data, size_t len)
+{
+}
+
+static inline void ws_capture_close(uint32_t connection)
+{
+}
+#endif /* CONFIG_NET_SAMPLE_WS_CAPTURE */
+
+#endif /* WS_CAPTURE_H */
@@ -8,10 +8,11 @@
 #include <stdio.h>
 #include <zephyr/kernel.h>
 #include <zephyr/logging/log.h>
+#include "AppLog.h"
 
 #include "HTTPWebsocket.h"
 
-LOG_MODULE_REGISTER(main, LOG_LEVEL_DBG);
+APP_LOG_MODULE_REGISTER(main);
 
 int main(void)
 {
@@ -0,0 +1,251 @@
+/*
+ * Copyright (c) 2024, Nordic Semiconductor
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/net/net_mgmt.h>
+#include <zephyr/net/net_pkt.h>
+#include <zephyr/net/net_stats.h>
+#include <zephyr/logging/log.h>
+
+#include "netstats.h"
+#include "TagDb.h"
+#include "TrafficClass.h"
+#if defined(CONFIG_NET_SAMPLE_WEBSOCKET_SERVICE)
+#include "ws.h"
+#endif
+
+LOG_MODULE_DECLARE(httpwebsocket, CONFIG_NET_SAMPLE_LOG_LEVEL);
+
+static void sample_handler(struct k_work *work);
+
+static K_WORK_DELAYABLE_DEFINE(sample_work, sample_handler);
+
+BUILD_ASSERT(sizeof(struct netstats) == TAG_STATS_COUNT * sizeof(uint32_t));
+
+static const char *const pool_names[NETSTATS_POOL_COUNT] = {
+    [NETSTATS_POOL_RX_PKT] = "rx_pkt",
+    [NETSTATS_POOL_TX_PKT] = "tx_pkt",
+    [NETSTATS_POOL_RX_DATA] = "rx_data",
+    [NETSTATS_POOL_TX_DATA] = "tx_data",
+    [NETSTATS_POOL_WS_RECV] = "ws_recv",
+};
+
+/* Written by the sample work, the peaks and full sample counts accumulate */
+static struct netstats_pool pools[NETSTATS_POOL_COUNT];
+static struct netstats_drops drops;
+static K_MUTEX_DEFINE(pools_lock);
+
+/* Read the counters from the network stack */
+static void netstats_sample(struct netstats *stats) {
+    struct netstats_drops sample = { 0 };
+    struct net_stats data;
+
+    memset(stats, 0, sizeof(*stats));
+
+    net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL, &data, sizeof(data));
+
+    stats->bytes_recv = data.bytes.received;
+    stats->bytes_sent = data.bytes.sent;
+    sample.processing = data.processing_error;
+#if defined(CONFIG_NET_STATISTICS_IPV6)
+    stats->ipv6_recv = data.ipv6.recv;
+    stats->ipv6_sent = data.ipv6.sent;
+    sample.ipv6 = data.ipv6.drop;
+#endif
+#if defined(CONFIG_NET_STATISTICS_IPV4)
+    stats->ipv4_recv = data.ipv4.recv;
+    stats->ipv4_sent = data.ipv4.sent;
+    sample.ipv4 = data.ipv4.drop;
+#endif
+#if defined(CONFIG_NET_STATISTICS_TCP)
+    stats->tcp_recv = data.tcp.bytes.received;
+    stats->tcp_sent = data.tcp.bytes.sent;
+    sample.tcp = data.tcp.drop;
+#endif
+#if defined(CONFIG_NET_STATISTICS_UDP)
+    sample.udp = data.udp.drop;
+#endif
+
+    k_mutex_lock(&pools_lock, K_FOREVER);
+    drops = sample;
+    k_mutex_unlock(&pools_lock);
+}
+
+#if defined(CONFIG_NET_SAMPLE_NETSTATS_POOLS)
+static void slab_sample(struct k_mem_slab *slab, struct netstats_pool *pool) {
+    pool->size = slab->info.num_blocks;
+    pool->used = k_mem_slab_num_used_get(slab);
+    /* Tracked by the kernel, so bursts between samples count too */
+    pool->peak = k_mem_slab_max_used_get(slab);
+}
+
+static void buf_pool_sample(struct net_buf_pool *buf_pool, struct netstats_pool *pool) {
+    pool->size = buf_pool->buf_count;
+    pool->used = buf_pool->buf_count - atomic_get(&buf_pool->avail_count);
+    pool->peak = buf_pool->max_used;
+}
+
+static void pools_sample(void) {
+    struct netstats_pool sample[NETSTATS_POOL_COUNT] = { 0 };
+    struct k_mem_slab *rx_pkt;
+    struct k_mem_slab *tx_pkt;
+    struct net_buf_pool *rx_data;
+    struct net_buf_pool *tx_data;
+
+    net_pkt_get_info(&rx_pkt, &tx_pkt, &rx_data, &tx_data);
+
+    slab_sample(rx_pkt, &sample[NETSTATS_POOL_RX_PKT]);
+    slab_sample(tx_pkt, &sample[NETSTATS_POOL_TX_PKT]);
+    buf_pool_sample(rx_data, &sample[NETSTATS_POOL_RX_DATA]);
+    buf_pool_sample(tx_data, &sample[NETSTATS_POOL_TX_DATA]);
+#if defined(CONFIG_NET_SAMPLE_WEBSOCKET_SERVICE)
+    if (ws_recv_slab() != NULL) {
+        slab_sample(ws_recv_slab(), &sample[NETSTATS_POOL_WS_RECV]);
+        sample[NETSTATS_POOL_WS_RECV].timeouts = ws_recv_timeouts();
+    }
+#endif
+
+    k_mutex_lock(&pools_lock, K_FOREVER);
+    for (size_t i = 0; i < NETSTATS_POOL_COUNT; i++) {
+        pools[i].size = sample[i].size;
+        pools[i].used = sample[i].used;
+        pools[i].peak = MAX(pools[i].peak, MAX(sample[i].peak, sample[i].used));
+        if (sample[i].size != 0 && sample[i].used == sample[i].size) {
+            pools[i].full_samples++;
+        }
+    }
+    k_mutex_unlock(&pools_lock);
+}
+#else
+static void pools_sample(void) {
+}
+#endif /* CONFIG_NET_SAMPLE_NETSTATS_POOLS */
+
+void netstats_pools_get(struct netstats_pool out[NETSTATS_POOL_COUNT]) {
+    k_mutex_lock(&pools_lock, K_FOREVER);
+    memcpy(out, pools, sizeof(pools));
+    k_mutex_unlock(&pools_lock);
+}
+
+void netstats_drops_get(struct netstats_drops *out) {
+    k_mutex_lock(&pools_lock, K_FOREVER);
+    *out = drops;
+    k_mutex_unlock(&pools_lock);
+}
+
+void netstats_get(struct netstats *stats) {
+    struct tag_value values[TAG_STATS_COUNT];
+    uint32_t *counters = (uint32_t *)stats;
+
+    tag_db_read(TAG_STATS_FIRST, TAG_STATS_COUNT, values);
+
+    for (size_t i = 0; i < TAG_STATS_COUNT; i++) {
+        counters[i] = values[i].u32;
+    }
+}
+
+int netstats_collect(char *buf, size_t maxlen) {
+    int ret;
+    size_t len;
+    struct netstats stats;
+    struct netstats_pool pool_stats[NETSTATS_POOL_COUNT];
+    struct netstats_drops drop_stats;
+
+    netstats_get(&stats);
+    netstats_pools_get(pool_stats);
+    netstats_drops_get(&drop_stats);
+
+    const char *net_stats_json_template = "{"
+            "\"bytes_recv\":%u,"
+            "\"bytes_sent\":%u,"
+            "\"ipv6_pkt_recv\":%u,"
+            "\"ipv6_pkt_sent\":%u,"
+            "\"ipv4_pkt_recv\":%u,"
+            "\"ipv4_pkt_sent\":%u,"
+            "\"tcp_bytes_recv\":%u,"
+            "\"tcp_bytes_sent\":%u,"
+            "\"pools\":{";
+
+    ret = snprintf(buf, maxlen, net_stats_json_template, stats.bytes_recv, stats.bytes_sent,
+                   stats.ipv6_recv, stats.ipv6_sent, stats.ipv4_recv, stats.ipv4_sent,
+                   stats.tcp_recv, stats.tcp_sent);
+    len = ret;
+
+    for (size_t i = 0; i < NETSTATS_POOL_COUNT && len < maxlen; i++) {
+        ret = snprintf(&buf[len], maxlen - len,
+                       "%s\"%s\":{\"size\":%u,\"used\":%u,\"peak\":%u,\"full_samples\":%u,"
+                       "\"timeouts\":%u}",
+                       i == 0 ? "" : ",", pool_names[i], pool_stats[i].size,
+                       pool_stats[i].used, pool_stats[i].peak, pool_stats[i].full_samples,
+                       pool_stats[i].timeouts);
+        len += ret;
+    }
+
+    if (len < maxlen) {
+        len += snprintf(&buf[len], maxlen - len, "}");
+    }
+
+    if (len < maxlen) {
+        len += snprintf(&buf[len], maxlen - len,
+                        ",\"drops\":{\"ipv4\":%u,\"ipv6\":%u,\"tcp\":%u,\"udp\":%u,"
+                        "\"processing\":%u}",
+                        drop_stats.ipv4, drop_stats.ipv6, drop_stats.tcp, drop_stats.udp,
+                        drop_stats.processing);
+    }
+
+#if defined(CONFIG_NET_SAMPLE_WEBSOCKET_SERVICE)
+    if (len < maxlen) {
+        struct ws_throttle_stats throttled;
+
+        ws_throttle_stats_get(&throttled);
+        len += snprintf(&buf[len], maxlen - len,
+                        ",\"ws_throttled\":{\"messages\":%u,\"bytes\":%u,\"delay_ms\":%u}",
+                        throttled.messages, throttled.bytes, throttled.delay_ms);
+    }
+#endif
+
+    if (len < maxlen) {
+        len += snprintf(&buf[len], maxlen - len, "}");
+    }
+
+    if (len >= maxlen) {
+        LOG_ERR("Net stats do not fit in buffer");
+        return -ENOSPC;
+    }
+
+    return len;
+}
+
+static void sample_handler(struct k_work *work) {
+    const uint32_t *counters;
+    struct netstats stats;
+
+    netstats_sample(&stats);
+    pools_sample();
+
+    /* Only counters that moved become new tag versions */
+    counters = (const uint32_t *)&stats;
+    tag_db_write_begin();
+    for (size_t i = 0; i < TAG_STATS_COUNT; i++) {
+        tag_db_set_u32(TAG_STATS_FIRST + i, counters[i]);
+    }
+    tag_db_write_end();
+
+    k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY),
+                                k_work_delayable_from_work(work),
+                                K_MSEC(CONFIG_NET_SAMPLE_NETSTATS_SAMPLE_INTERVAL));
+}
+
+static int netstats_init(void) {
+    k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY), &sample_work, K_NO_WAIT);
+    return 0;
+}
+
+SYS_INIT(netstats_init, APPLICATION, 0);
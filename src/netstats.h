@@ -0,0 +1,122 @@
+/*
+ * Copyright (c) 2024, Nordic Semiconductor
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef NETSTATS_H
+#define NETSTATS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Network statistics shown on the web page
+ */
+struct netstats {
+    uint32_t bytes_recv;
+    uint32_t bytes_sent;
+    uint32_t ipv6_recv;
+    uint32_t ipv6_sent;
+    uint32_t ipv4_recv;
+    uint32_t ipv4_sent;
+    uint32_t tcp_recv;
+    uint32_t tcp_sent;
+};
+
+/**
+ * @brief Network buffer and packet pools of the stack, and the websocket
+ *        receive buffers of the application
+ */
+enum netstats_pool_id {
+    NETSTATS_POOL_RX_PKT,
+    NETSTATS_POOL_TX_PKT,
+    NETSTATS_POOL_RX_DATA,
+    NETSTATS_POOL_TX_DATA,
+    NETSTATS_POOL_WS_RECV,
+    NETSTATS_POOL_COUNT,
+};
+
+/**
+ * @brief Occupancy of one pool
+ */
+struct netstats_pool {
+    uint16_t size;
+    uint16_t used;
+    /** Most buffers in use at once since boot */
+    uint16_t peak;
+    /**
+     * Samples that found every buffer in use. Allocations failing between
+     * two samples are not seen here, see struct netstats_drops.
+     */
+    uint32_t full_samples;
+    /**
+     * Allocations that gave up waiting for a free buffer. Only the
+     * application pools count them, the stack drops packets instead.
+     */
+    uint32_t timeouts;
+};
+
+/**
+ * @brief Packets dropped by the stack, from its own counters
+ *
+ * Counters of protocols without statistics support stay at zero.
+ */
+struct netstats_drops {
+    uint32_t ipv4;
+    uint32_t ipv6;
+    uint32_t tcp;
+    uint32_t udp;
+    /** Packets the stack failed to process, e.g. for lack of a buffer */
+    uint32_t processing;
+};
+
+/* Fits the counters, all pools, the drops and the throttling counters */
+#define NETSTATS_JSON_LEN 1024
+
+/**
+ * @brief Read the network statistics
+ *
+ * The counters are sampled into the tag database every
+ * CONFIG_NET_SAMPLE_NETSTATS_SAMPLE_INTERVAL milliseconds, so this is the
+ * latest sample. Counters for protocols without statistics support are
+ * left at zero.
+ *
+ * @param stats Filled with the current values
+ */
+void netstats_get(struct netstats *stats);
+
+/**
+ * @brief Read the occupancy of the network pools
+ *
+ * Sampled together with the counters. Without
+ * CONFIG_NET_SAMPLE_NETSTATS_POOLS all pools read as empty.
+ *
+ * @param pools Filled with the current values, indexed by netstats_pool_id
+ */
+void netstats_pools_get(struct netstats_pool pools[NETSTATS_POOL_COUNT]);
+
+/**
+ * @brief Read the drop counters of the stack, sampled with the counters
+ *
+ * @param drops Filled with the current values
+ */
+void netstats_drops_get(struct netstats_drops *drops);
+
+/**
+ * @brief Collect network statistics as a JSON object
+ *
+ * The counters, the pools in a "pools" object by name, for example
+ * "rx_pkt":{"size":16,"used":2,"peak":9,"full_samples":0,"timeouts":0}, and the drop
+ * counters of the stack in a "drops" object. With the websocket
+ * service also the throttling counters of the echo connections in
+ * "ws_throttled", see ws_throttle_stats_get().
+ *
+ * @param buf Output buffer, NETSTATS_JSON_LEN is enough
+ * @param maxlen Size of @p buf
+ *
+ * @return Length of the JSON string, or -ENOSPC if it does not fit
+ */
+int netstats_collect(char *buf, size_t maxlen);
+
+#endif /* NETSTATS_H */
@@ -0,0 +1,24 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+/* Appended to the Zephyr mbedTLS configuration through
+ * CONFIG_MBEDTLS_USER_CONFIG_FILE, see overlay-tls.conf.
+ */
+
+#ifndef MBEDTLS_USER_CONFIG_H
+#define MBEDTLS_USER_CONFIG_H
+
+#if defined(CONFIG_NET_SAMPLE_TLS_SESSION_CACHE)
+/* Bounded server side session cache for abbreviated handshakes. Cached
+ * sessions are allocated from the mbedTLS heap, so the bound also caps the
+ * heap they can take.
+ */
+#define MBEDTLS_SSL_CACHE_C
+#define MBEDTLS_SSL_CACHE_DEFAULT_MAX_ENTRIES CONFIG_NET_SAMPLE_TLS_SESSION_CACHE_SIZE
+#define MBEDTLS_SSL_CACHE_DEFAULT_TIMEOUT CONFIG_NET_SAMPLE_TLS_SESSION_LIFETIME
+#endif
+
+#endif /* MBEDTLS_USER_CONFIG_H */
@@ -5,7 +5,7 @@
  */
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_DECLARE(net_http_server_sample, LOG_LEVEL_DBG);
+LOG_MODULE_DECLARE(net_http_server_sample, CONFIG_NET_SAMPLE_LOG_LEVEL);
 
 #include <zephyr/usb/usb_device.h>
 #include <zephyr/net/net_config.h>
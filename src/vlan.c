@@ -5,7 +5,7 @@
  */
 
 #include <zephyr/logging/log.h>
-LOG_MODULE_DECLARE(net_mdns_responder_sample, LOG_LEVEL_DBG);
+LOG_MODULE_DECLARE(net_mdns_responder_sample, CONFIG_NET_SAMPLE_LOG_LEVEL);
 
 #include <zephyr/kernel.h>
 
@@ -13,15 +13,21 @@
 #include <zephyr/net/net_ip.h>
 #include <zephyr/net/socket.h>
 #include <zephyr/net/websocket.h>
-#include <zephyr/net/net_mgmt.h>
-#include <zephyr/net/net_stats.h>
 #include <zephyr/init.h>
+#include <zephyr/shell/shell.h>
 
 #include <zephyr/logging/log.h>
 #include "InductionConfig.h"
+#include "LogLimit.h"
+#include "netstats.h"
+#include "TokenBucket.h"
+#include "TrafficClass.h"
+#include "ws.h"
+#include "WsBuffers.h"
+#include "WsCapture.h"
 
 
-LOG_MODULE_DECLARE(httpwebsocket, LOG_LEVEL_DBG);
+LOG_MODULE_DECLARE(httpwebsocket, CONFIG_NET_SAMPLE_LOG_LEVEL);
 
 
 #if defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS) || defined(CONFIG_COVERAGE_GCOV)
@@ -30,11 +36,8 @@ LOG_MODULE_DECLARE(httpwebsocket, LOG_LEVEL_DBG);
 #define STACK_SIZE 2048
 #endif
 
-#if defined(CONFIG_NET_TC_THREAD_COOPERATIVE)
-#define THREAD_PRIORITY K_PRIO_COOP(CONFIG_NUM_COOP_PRIORITIES - 1)
-#else
-#define THREAD_PRIORITY K_PRIO_PREEMPT(8)
-#endif
+/* The handlers apply configurations, they are control traffic */
+#define THREAD_PRIORITY TRAFFIC_CONTROL_PRIORITY
 
 #if defined(CONFIG_USERSPACE)
 #include <zephyr/app_memory/app_memdomain.h>
@@ -50,9 +53,20 @@ extern struct k_mem_domain app_domain;
 #define MAX_CLIENT_QUEUE CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS
 #define RECV_BUFFER_SIZE 1280
 
+/* Milliseconds a whole message may take once its first byte arrived */
+#define MESSAGE_TIMEOUT 2000
+
+/* Milliseconds to wait for a free receive buffer before polling again */
+#define RECV_BUFFER_TIMEOUT 100
+
+/* Sent to every client for each configuration message */
+static const char ack[] = "send successful";
+
 struct ws_netstats_ctx {
     int sock;
     struct k_work_delayable work;
+    struct traffic_msg msg;
+    char buf[NETSTATS_JSON_LEN];
 };
 
 K_THREAD_STACK_ARRAY_DEFINE(ws_handler_stack,
@@ -63,12 +77,37 @@ static APP_BMEM bool ws_handler_in_use[CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS]
 
 static struct ws_netstats_ctx netstats_ctx[CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS];
 
+#if defined(CONFIG_USERSPACE)
+/* User mode handlers cannot take blocks of a kernel slab, each keeps its own */
+static APP_BMEM char recv_buffers[CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS][RECV_BUFFER_SIZE];
+#else
+/* Taken only while a message is received and processed, so idle clients hold none */
+K_MEM_SLAB_DEFINE_STATIC(recv_slab, RECV_BUFFER_SIZE, CONFIG_NET_SAMPLE_WEBSOCKET_RECV_BUFFERS, 4);
+
+static atomic_t recv_buffer_timeouts;
+#endif
+
 static struct data {
     int sock;
-    uint32_t counter;
+    /* WebSocket receive buffer of the connection, see WsBuffers.h */
+    struct ws_buffer_pool *buffers;
+    int buffer;
     uint32_t bytes_received;
+    uint32_t messages_received;
+    /* Longer than the receive buffer */
+    uint32_t messages_dropped;
+    uint32_t throttled;
+    /* Microseconds from the end of a message to its acknowledgement being queued */
+    uint64_t process_us;
+    uint32_t process_max_us;
     struct pollfd fds[1];
-    char recv_buffer[RECV_BUFFER_SIZE];
+    /* Generation of the limits the buckets were set up with */
+    atomic_val_t limits_generation;
+    struct token_bucket messages;
+    struct token_bucket bytes;
+    /* Milliseconds to wait before the next message is received */
+    uint32_t delay;
+    struct traffic_msg ack;
 } config[CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS] = {
     [0 ... (CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS - 1)] = {
         .sock = -1,
@@ -76,6 +115,28 @@ static struct data {
     }
 };
 
+static APP_BMEM atomic_t throttled_messages;
+static APP_BMEM atomic_t throttled_bytes;
+static APP_BMEM atomic_t throttle_delay_ms;
+
+/* Changed at runtime with the ws shell command */
+static APP_DMEM struct ws_limits {
+    uint32_t message_rate;
+    uint32_t message_burst;
+    uint32_t byte_rate;
+    uint32_t byte_burst;
+} limits = {
+    .message_rate = CONFIG_NET_SAMPLE_WS_ECHO_MESSAGE_RATE,
+    .message_burst = CONFIG_NET_SAMPLE_WS_ECHO_MESSAGE_BURST,
+    .byte_rate = CONFIG_NET_SAMPLE_WS_ECHO_BYTE_RATE,
+    .byte_burst = CONFIG_NET_SAMPLE_WS_ECHO_BYTE_BURST,
+};
+
+/* Bumped on a change, each handler applies the new limits to its own buckets */
+static APP_BMEM atomic_t limits_generation;
+
+static uint32_t stats_interval = CONFIG_NET_SAMPLE_WEBSOCKET_STATS_INTERVAL;
+
 static int get_free_echo_slot(struct data *cfg) {
     for (int i = 0; i < CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS; i++) {
         if (cfg[i].sock < 0) {
@@ -96,43 +157,194 @@ static int get_free_netstats_slot(void) {
     return -1;
 }
 
-static ssize_t sendall(int sock, const void *buf, size_t len) {
-    while (len) {
-        ssize_t out_len = send(sock, buf, len, 0);
+#if defined(CONFIG_USERSPACE)
+static char *recv_buffer_get(int slot) {
+    return recv_buffers[slot];
+}
+
+static void recv_buffer_put(char *buffer) {
+    ARG_UNUSED(buffer);
+}
 
-        if (out_len < 0) {
-            return out_len;
-        }
-        buf = (const char *) buf + out_len;
-        len -= out_len;
-    }
+struct k_mem_slab *ws_recv_slab(void) {
+    return NULL;
+}
 
+uint32_t ws_recv_timeouts(void) {
     return 0;
 }
+#else
+static char *recv_buffer_get(int slot) {
+    void *buffer;
+
+    ARG_UNUSED(slot);
+
+    /* The message waits in the socket while the buffers are held by other
+     * connections. Never wait for good, the caller polls again and so
+     * notices a client that went away meanwhile.
+     */
+    if (k_mem_slab_alloc(&recv_slab, &buffer, K_MSEC(RECV_BUFFER_TIMEOUT)) < 0) {
+        atomic_inc(&recv_buffer_timeouts);
+        return NULL;
+    }
+
+    return buffer;
+}
+
+static void recv_buffer_put(char *buffer) {
+    k_mem_slab_free(&recv_slab, buffer);
+}
+
+struct k_mem_slab *ws_recv_slab(void) {
+    return &recv_slab;
+}
+
+uint32_t ws_recv_timeouts(void) {
+    return atomic_get(&recv_buffer_timeouts);
+}
+#endif /* CONFIG_USERSPACE */
+
+void ws_throttle_stats_get(struct ws_throttle_stats *stats) {
+    stats->messages = atomic_get(&throttled_messages);
+    stats->bytes = atomic_get(&throttled_bytes);
+    stats->delay_ms = atomic_get(&throttle_delay_ms);
+}
+
+/* Charge received frames, a client over its limits waits before the next.
+ * Pings and pongs count as messages too, or a client could send them at any
+ * rate.
+ */
+static void throttle_charge(int slot, struct data *cfg, uint32_t messages, size_t received) {
+    atomic_val_t generation = atomic_get(&limits_generation);
+
+    if (generation != cfg->limits_generation) {
+        token_bucket_configure(&cfg->messages, limits.message_rate, limits.message_burst);
+        token_bucket_configure(&cfg->bytes, limits.byte_rate, limits.byte_burst);
+        cfg->limits_generation = generation;
+    }
+
+    uint32_t message_delay = token_bucket_take(&cfg->messages, messages);
+    uint32_t byte_delay = token_bucket_take(&cfg->bytes, received);
+
+    if (message_delay > 0) {
+        atomic_inc(&throttled_messages);
+    }
+
+    if (byte_delay > 0) {
+        atomic_inc(&throttled_bytes);
+    }
+
+    cfg->delay = MAX(message_delay, byte_delay);
+    if (cfg->delay > 0) {
+        cfg->throttled++;
+        LOG_DBG_LIMITED("[%d] Throttled for %u ms", slot, cfg->delay);
+    }
+}
+
+/* Receive the next message into @buffer. The frame headers tell where it
+ * ends, so the frames and TCP segments of a message are put together in
+ * place and it is never mixed up with the next one. The caller polled, so
+ * its first byte is already there and the whole message has to follow
+ * within MESSAGE_TIMEOUT, however the client spreads it over frames.
+ *
+ * Returns its length, -EAGAIN if only control frames arrived, -EMSGSIZE if
+ * it did not fit, -ENOTCONN if the client closed, -ETIMEDOUT if the rest of
+ * the message did not follow in time, or another negative errno. @total
+ * is set to the payload bytes read, the end of a message that did not fit
+ * is read over itself and dropped. @control is set to the number of pings
+ * and pongs read.
+ */
+static int ws_recv_message(int sock, char *buffer, size_t size, size_t *total,
+                           uint32_t *control) {
+    int64_t deadline = k_uptime_get() + MESSAGE_TIMEOUT;
+    bool truncated = false;
+    int64_t timeout;
+    size_t len = 0;
+    uint64_t remaining;
+    uint32_t type;
+    int ret;
+
+    *total = 0;
+    *control = 0;
+
+    while (true) {
+        if (len == size) {
+            len = 0;
+            truncated = true;
+        }
+
+        timeout = deadline - k_uptime_get();
+        if (timeout <= 0) {
+            return -ETIMEDOUT;
+        }
+
+        ret = websocket_recv_msg(sock, (uint8_t *)&buffer[len], size - len, &type,
+                                 &remaining, (int32_t)timeout);
+        if (ret < 0) {
+            return ret == -EAGAIN ? -ETIMEDOUT : ret;
+        }
+
+        if (type & WEBSOCKET_FLAG_CLOSE) {
+            return -ENOTCONN;
+        }
+
+        /* Control frames may come between the frames of a message */
+        if (type & (WEBSOCKET_FLAG_PING | WEBSOCKET_FLAG_PONG)) {
+            if (remaining == 0) {
+                (*control)++;
+                if (len == 0 && *total == 0) {
+                    return -EAGAIN;
+                }
+            }
+            continue;
+        }
+
+        len += ret;
+        *total += ret;
+
+        if (remaining == 0 && (type & WEBSOCKET_FLAG_FINAL)) {
+            return truncated ? -EMSGSIZE : (int)len;
+        }
+    }
+}
 
 static void ws_echo_handler(void *ptr1, void *ptr2, void *ptr3) {
     int slot = POINTER_TO_INT(ptr1);
     struct data *cfg = ptr2;
     bool *in_use = ptr3;
-    int offset = 0;
-    int received;
+    char *buffer;
+    size_t received;
+    uint32_t control;
+    uint32_t start;
+    uint32_t elapsed;
+    int len;
     int client;
-    int ret;
+    uint32_t capture;
 
     client = cfg->sock;
+    capture = ws_capture_open();
 
     cfg->fds[0].fd = client;
     cfg->fds[0].events = POLLIN;
 
-    /* In this example, we start to receive data from the websocket
-     * and send it back to the client. Note that we could either use
-     * the BSD socket interface if we do not care about Websocket
-     * specific packets, or we could use the websocket_{send/recv}_msg()
-     * function to send websocket specific data.
+    cfg->limits_generation = atomic_get(&limits_generation);
+    token_bucket_init(&cfg->messages, limits.message_rate, limits.message_burst);
+    token_bucket_init(&cfg->bytes, limits.byte_rate, limits.byte_burst);
+    cfg->delay = 0;
+    cfg->ack = (struct traffic_msg) {
+        .sock = client,
+        .data = ack,
+        .len = sizeof(ack),
+    };
+
+    /* In this example, we receive configuration messages from the
+     * websocket and acknowledge them. Messages are received with
+     * websocket_recv_msg(), whose frame information delimits them, and
+     * parsed where they were received.
      */
     while (true) {
         if (poll(cfg->fds, 1, -1) < 0) {
-            LOG_ERR("Error in poll:%d", errno);
+            LOG_ERR_LIMITED("Error in poll:%d", errno);
             continue;
         }
 
@@ -145,156 +357,143 @@ static void ws_echo_handler(void *ptr1, void *ptr2, void *ptr3) {
             break;
         }
 
-        received = recv(client,
-                        cfg->recv_buffer + offset,
-                        sizeof(cfg->recv_buffer) - offset,
-                        0);
+        /* The pending data stays in the socket, so TCP flow control slows
+         * the client down while no receive buffer is held. Poll again
+         * afterwards to notice a client that gave up meanwhile.
+         */
+        if (cfg->delay > 0) {
+            atomic_add(&throttle_delay_ms, cfg->delay);
+            k_msleep(cfg->delay);
+            cfg->delay = 0;
+            continue;
+        }
+
+        buffer = recv_buffer_get(slot);
+        if (buffer == NULL) {
+            LOG_DBG_LIMITED("[%d] No receive buffer free", slot);
+            continue;
+        }
+
+        len = ws_recv_message(client, buffer, RECV_BUFFER_SIZE, &received, &control);
 
-        if (received == 0) {
+        if (len == -EAGAIN) {
+            /* Only a ping or pong */
+            recv_buffer_put(buffer);
+            throttle_charge(slot, cfg, control, 0);
+            continue;
+        } else if (len == -ENOTCONN) {
             /* Connection closed */
             LOG_INF("[%d] Connection closed", slot);
+            recv_buffer_put(buffer);
             break;
-        } else if (received < 0) {
+        } else if (len < 0 && len != -EMSGSIZE) {
             /* Socket error */
-            LOG_ERR("[%d] Connection error %d", slot, errno);
+            LOG_ERR_LIMITED("[%d] Connection error %d", slot, len);
+            recv_buffer_put(buffer);
             break;
         }
 
+        start = k_cycle_get_32();
         cfg->bytes_received += received;
-        offset += received;
-        offset = 0;
-
-        InductionConfig_json_parser(cfg->recv_buffer, cfg->bytes_received);
+        cfg->messages_received++;
+        throttle_charge(slot, cfg, 1 + control, received);
+
+        if (len >= 0) {
+            ws_capture_message(capture, buffer, len);
+            InductionConfig_json_parser(buffer, len);
+        } else {
+            cfg->messages_dropped++;
+            LOG_WRN_LIMITED("[%d] Message of %zu bytes dropped, longer than %d", slot,
+                            received, RECV_BUFFER_SIZE);
+        }
+        recv_buffer_put(buffer);
 
-        char response[] = "send successful";
-        websocket_send_msg(client, response, sizeof(response),
+#if defined(CONFIG_USERSPACE)
+        /* User mode cannot submit work, the handler sends it itself */
+        websocket_send_msg(client, ack, sizeof(ack),
                            WEBSOCKET_OPCODE_DATA_TEXT, false, true, 0);
+#else
+        /* Sent by the control work queue, the handler goes on receiving */
+        (void)traffic_send(TRAFFIC_CONTROL, &cfg->ack);
+#endif
 
+        elapsed = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+        cfg->process_us += elapsed;
+        cfg->process_max_us = MAX(cfg->process_max_us, elapsed);
 
-        /*
-#if !defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
-        /* To prevent fragmentation of the response, reply only if
-         * buffer is full or there is no more data to read
+        /* One message per turn: the handlers run at the same priority, so
+         * every other connection with a message waiting is served before
+         * this one parses its next
          */
-        if (offset == sizeof(cfg->recv_buffer) ||
-            (recv(client, cfg->recv_buffer + offset,
-                  sizeof(cfg->recv_buffer) - offset,
-                  MSG_PEEK | MSG_DONTWAIT) < 0 &&
-             (errno == EAGAIN || errno == EWOULDBLOCK))) {
-
-            ret = sendall(client, cfg->recv_buffer, offset);
-            if (ret < 0) {
-                LOG_ERR("[%d] Failed to send data, closing socket",
-                        slot);
-                break;
-            }
-
-            LOG_DBG("[%d] Received and replied with %d bytes",
-                    slot, offset);
+        k_yield();
+    }
 
-            if (++cfg->counter % 1000 == 0U) {
-                LOG_INF("[%d] Sent %u packets", slot, cfg->counter);
-            }
+    ws_capture_close(capture);
 
-            offset = 0;
-#if !defined(CONFIG_NET_SOCKETS_SOCKOPT_TLS)
-        }
+#if !defined(CONFIG_USERSPACE)
+    traffic_cancel(TRAFFIC_CONTROL, &cfg->ack);
 #endif
-    }
 
     *in_use = false;
 
     (void) websocket_unregister(client);
+    ws_buffer_give(cfg->buffers, cfg->buffer);
 
     cfg->sock = -1;
 }
 
-static int netstats_collect(char *buf, size_t maxlen) {
-    int ret;
-    struct net_stats data;
-    uint32_t bytes_recv = 0;
-    uint32_t bytes_sent = 0;
-    uint32_t ipv6_recv = 0;
-    uint32_t ipv6_sent = 0;
-    uint32_t ipv4_recv = 0;
-    uint32_t ipv4_sent = 0;
-    uint32_t tcp_recv = 0;
-    uint32_t tcp_sent = 0;
-
-    net_mgmt(NET_REQUEST_STATS_GET_ALL, NULL, &data, sizeof(data));
-
-    const char *net_stats_json_template = "{"
-            "\"bytes_recv\":%u,"
-            "\"bytes_sent\":%u,"
-            "\"ipv6_pkt_recv\":%u,"
-            "\"ipv6_pkt_sent\":%u,"
-            "\"ipv4_pkt_recv\":%u,"
-            "\"ipv4_pkt_sent\":%u,"
-            "\"tcp_bytes_recv\":%u,"
-            "\"tcp_bytes_sent\":%u"
-            "}";
-
-    bytes_recv = data.bytes.received;
-    bytes_sent = data.bytes.sent;
-#if defined(CONFIG_NET_STATISTICS_IPV6)
-    ipv6_recv = data.ipv6.recv;
-    ipv6_sent = data.ipv6.sent;
-#endif
-#if defined(CONFIG_NET_STATISTICS_IPV4)
-    ipv4_recv = data.ipv4.recv;
-    ipv4_sent = data.ipv4.sent;
-#endif
-#if defined(CONFIG_NET_STATISTICS_TCP)
-    tcp_recv = data.tcp.bytes.received;
-    tcp_sent = data.tcp.bytes.sent;
-#endif
+static void netstats_close(struct ws_netstats_ctx *ctx) {
+    (void) websocket_unregister(ctx->sock);
+    ctx->sock = -1;
+}
 
-    ret = snprintf(buf, maxlen, net_stats_json_template, bytes_recv, bytes_sent, ipv6_recv,
-                   ipv6_sent, ipv4_recv, ipv4_sent, tcp_recv, tcp_sent);
-    if (ret >= maxlen) {
-        LOG_ERR("Net stats do not fit in buffer");
-        return -ENOSPC;
-    }
+/* Called on the telemetry work queue, like the handler below */
+static void netstats_sent(struct traffic_msg *msg, int ret) {
+    struct ws_netstats_ctx *ctx = CONTAINER_OF(msg, struct ws_netstats_ctx, msg);
 
-    return ret;
+    if (ret < 0) {
+        LOG_INF("Couldn't send websocket msg (%d), closing connection", ret);
+        (void) k_work_cancel_delayable(&ctx->work);
+        netstats_close(ctx);
+    }
 }
 
 static void netstats_handler(struct k_work *work) {
     int ret;
-    static char tx_buf[256];
     struct k_work_delayable *dwork = k_work_delayable_from_work(work);
     struct ws_netstats_ctx *ctx = CONTAINER_OF(dwork, struct ws_netstats_ctx, work);
 
-    ret = netstats_collect(tx_buf, sizeof(tx_buf));
-    if (ret < 0) {
-        LOG_ERR("Unable to collect network statistics, err %d", ret);
-        goto unregister;
-    }
+    /* A dashboard still receiving the previous sample skips this one */
+    if (traffic_pending(TRAFFIC_TELEMETRY, &ctx->msg) == 0) {
+        ret = netstats_collect(ctx->buf, sizeof(ctx->buf));
+        if (ret < 0) {
+            LOG_ERR("Unable to collect network statistics, err %d", ret);
+            netstats_close(ctx);
+            return;
+        }
 
-    ret = websocket_send_msg(ctx->sock, tx_buf, ret, WEBSOCKET_OPCODE_DATA_TEXT, false, true,
-                             SYS_FOREVER_MS);
-    if (ret < 0) {
-        LOG_INF("Couldn't send websocket msg (%d), closing connection", ret);
-        goto unregister;
+        ctx->msg.sock = ctx->sock;
+        ctx->msg.len = ret;
+        (void) traffic_send(TRAFFIC_TELEMETRY, &ctx->msg);
     }
 
-    ret = k_work_reschedule(&ctx->work, K_MSEC(CONFIG_NET_SAMPLE_WEBSOCKET_STATS_INTERVAL));
+    ret = k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY), &ctx->work,
+                                      K_MSEC(stats_interval));
     if (ret < 0) {
         LOG_ERR("Failed to schedule netstats work, err %d", ret);
-        goto unregister;
+        traffic_cancel(TRAFFIC_TELEMETRY, &ctx->msg);
+        netstats_close(ctx);
     }
-
-    return;
-
-unregister:
-    (void) websocket_unregister(ctx->sock);
-    ctx->sock = -1;
 }
 
 int ws_netstats_init(void) {
     for (int i = 0; i < CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS; i++) {
         netstats_ctx[i].sock = -1;
         k_work_init_delayable(&netstats_ctx[i].work, netstats_handler);
+        netstats_ctx[i].msg = (struct traffic_msg) {
+            .data = netstats_ctx[i].buf,
+            .sent = netstats_sent,
+        };
     }
 
     return 0;
@@ -307,12 +506,25 @@ int ws_echo_setup(int ws_socket, struct http_request_ctx *request_ctx, void *use
 
     slot = get_free_echo_slot(config);
     if (slot < 0) {
-        LOG_ERR("Cannot accept more connections");
+        LOG_WRN_LIMITED("Cannot accept more connections");
         /* The caller will close the connection in this case */
         return -ENOENT;
     }
 
+    /* A free slot has given its buffer back, so this one is there */
+    config[slot].buffer = ws_buffer_take(user_data);
+    if (config[slot].buffer < 0) {
+        return config[slot].buffer;
+    }
+
     config[slot].sock = ws_socket;
+    config[slot].buffers = user_data;
+    config[slot].bytes_received = 0;
+    config[slot].messages_received = 0;
+    config[slot].messages_dropped = 0;
+    config[slot].throttled = 0;
+    config[slot].process_us = 0;
+    config[slot].process_max_us = 0;
 
     LOG_INF("[%d] Accepted a Websocket connection", slot);
 
@@ -346,13 +558,14 @@ int ws_netstats_setup(int ws_socket, struct http_request_ctx *request_ctx, void
 
     slot = get_free_netstats_slot();
     if (slot < 0) {
-        LOG_ERR("Cannot accept more netstats websocket connections");
+        LOG_WRN_LIMITED("Cannot accept more netstats websocket connections");
         return -ENOENT;
     }
 
     netstats_ctx[slot].sock = ws_socket;
 
-    ret = k_work_reschedule(&netstats_ctx[slot].work, K_NO_WAIT);
+    ret = k_work_reschedule_for_queue(traffic_queue(TRAFFIC_TELEMETRY), &netstats_ctx[slot].work,
+                                      K_NO_WAIT);
     if (ret < 0) {
         LOG_ERR("Failed to schedule netstats work, err %d", ret);
         return ret;
@@ -361,3 +574,136 @@ int ws_netstats_setup(int ws_socket, struct http_request_ctx *request_ctx, void
     LOG_INF("Accepted websocket connection for net stats");
     return 0;
 }
+
+#if defined(CONFIG_SHELL)
+static int cmd_ws_list(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    shell_print(sh, "%-4s %6s %10s %10s %8s %9s %9s %9s %4s", "Slot", "Socket", "Messages",
+                "Bytes", "Dropped", "Throttled", "Avg us", "Max us", "Acks");
+
+    for (int i = 0; i < CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS; i++) {
+        const struct data *cfg = &config[i];
+
+        if (cfg->sock < 0) {
+            continue;
+        }
+
+        shell_print(sh, "%-4d %6d %10u %10u %8u %9u %9u %9u %4u", i, cfg->sock,
+                    cfg->messages_received, cfg->bytes_received, cfg->messages_dropped,
+                    cfg->throttled,
+                    cfg->messages_received != 0
+                        ? (uint32_t)(cfg->process_us / cfg->messages_received)
+                        : 0,
+                    cfg->process_max_us,
+#if defined(CONFIG_USERSPACE)
+                    0U
+#else
+                    traffic_pending(TRAFFIC_CONTROL, &cfg->ack)
+#endif
+                    );
+    }
+
+    for (int i = 0; i < CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS; i++) {
+        if (netstats_ctx[i].sock >= 0) {
+            shell_print(sh, "Netstats socket %d, %u samples pending", netstats_ctx[i].sock,
+                        traffic_pending(TRAFFIC_TELEMETRY, &netstats_ctx[i].msg));
+        }
+    }
+
+    shell_print(sh, "Throttled %ld messages and %ld bytes for %ld ms in total",
+                (long)atomic_get(&throttled_messages), (long)atomic_get(&throttled_bytes),
+                (long)atomic_get(&throttle_delay_ms));
+
+    return 0;
+}
+
+/* Counters of a busy connection may miss the message being processed */
+static int cmd_ws_reset(const struct shell *sh, size_t argc, char **argv) {
+    ARG_UNUSED(argc);
+    ARG_UNUSED(argv);
+
+    for (int i = 0; i < CONFIG_NET_SAMPLE_NUM_WEBSOCKET_HANDLERS; i++) {
+        config[i].bytes_received = 0;
+        config[i].messages_received = 0;
+        config[i].messages_dropped = 0;
+        config[i].throttled = 0;
+        config[i].process_us = 0;
+        config[i].process_max_us = 0;
+    }
+
+    atomic_clear(&throttled_messages);
+    atomic_clear(&throttled_bytes);
+    atomic_clear(&throttle_delay_ms);
+
+    shell_print(sh, "Counters reset");
+
+    return 0;
+}
+
+static int cmd_ws_interval(const struct shell *sh, size_t argc, char **argv) {
+    unsigned long interval;
+    int err = 0;
+
+    if (argc > 1) {
+        interval = shell_strtoul(argv[1], 10, &err);
+        if (err != 0 || interval == 0) {
+            shell_error(sh, "Invalid interval %s", argv[1]);
+            return -EINVAL;
+        }
+        /* Taken by the next sample of each dashboard */
+        stats_interval = interval;
+    }
+
+    shell_print(sh, "Network statistics every %u ms", stats_interval);
+
+    return 0;
+}
+
+static int cmd_ws_limit(const struct shell *sh, size_t argc, char **argv) {
+    unsigned long values[4];
+    int err = 0;
+
+    if (argc == 5) {
+        for (int i = 0; i < ARRAY_SIZE(values); i++) {
+            values[i] = shell_strtoul(argv[i + 1], 10, &err);
+            if (err != 0 || values[i] > UINT32_MAX) {
+                shell_error(sh, "Invalid limit %s", argv[i + 1]);
+                return -EINVAL;
+            }
+        }
+
+        limits.message_rate = values[0];
+        limits.message_burst = values[1];
+        limits.byte_rate = values[2];
+        limits.byte_burst = values[3];
+        /* Applied by each connection before its next message is charged */
+        atomic_inc(&limits_generation);
+    } else if (argc != 1) {
+        shell_error(sh, "Give all four limits or none");
+        return -EINVAL;
+    }
+
+    shell_print(sh, "%u messages/s, burst %u, %u bytes/s, burst %u (0 is unlimited)",
+                limits.message_rate, limits.message_burst, limits.byte_rate,
+                limits.byte_burst);
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(ws_cmds,
+    SHELL_CMD(list, NULL, "Connections with their message, byte and latency counters",
+              cmd_ws_list),
+    SHELL_CMD(reset, NULL, "Reset the connection and throttling counters", cmd_ws_reset),
+    SHELL_CMD_ARG(interval, NULL, "Show or set the network statistics interval [ms]",
+                  cmd_ws_interval, 1, 1),
+    SHELL_CMD_ARG(limit, NULL,
+                  "Show or set the echo limits "
+                  "[msg_rate msg_burst byte_rate byte_burst]",
+                  cmd_ws_limit, 1, 4),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(ws, &ws_cmds, "WebSocket connections of the application", NULL);
+#endif /* CONFIG_SHELL */
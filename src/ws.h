@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <zephyr/kernel.h>
 #include <zephyr/net/http/server.h>
 
 /**
@@ -11,7 +12,7 @@
  *
  * @param ws_socket Socket file descriptor associated with websocket
  * @param request_ctx Request context associated with websocket HTTP upgrade request
- * @param user_data User data pointer
+ * @param user_data The struct ws_buffer_pool of the resource, see WsBuffers.h
  *
  * @return 0 on success
  */
@@ -27,3 +28,37 @@ int ws_echo_setup(int ws_socket, struct http_request_ctx *request_ctx, void *use
  * @return 0 on success
  */
 int ws_netstats_setup(int ws_socket, struct http_request_ctx *request_ctx, void *user_data);
+
+/**
+ * @brief Slab the websocket handlers take their receive buffers from
+ *
+ * @return The slab, or NULL with CONFIG_USERSPACE, where every handler
+ *         keeps a buffer of its own
+ */
+struct k_mem_slab *ws_recv_slab(void);
+
+/**
+ * @brief How often a handler gave up waiting for a free receive buffer
+ *
+ * @return The count since boot, always 0 with CONFIG_USERSPACE
+ */
+uint32_t ws_recv_timeouts(void);
+
+/**
+ * @brief How often the echo connections were over their rate limits
+ */
+struct ws_throttle_stats {
+    /** Messages after which a connection was over its message rate */
+    uint32_t messages;
+    /** Messages after which a connection was over its byte rate */
+    uint32_t bytes;
+    /** Milliseconds the connections were paused, summed up */
+    uint32_t delay_ms;
+};
+
+/**
+ * @brief Read the throttling counters of the echo connections since boot
+ *
+ * @param stats Filled with the current values
+ */
+void ws_throttle_stats_get(struct ws_throttle_stats *stats);
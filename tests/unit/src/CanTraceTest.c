@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "CanTrace.h"
+
+#define FLUSH_INTERVAL CONFIG_NET_SAMPLE_CAN_FLUSH_INTERVAL
+
+static struct can_trace trace;
+
+static int configure(const char *text)
+{
+    char command[CAN_TRACE_COMMAND_LEN];
+
+    /* Parsed in place */
+    strcpy(command, text);
+    return can_trace_configure(&trace, command, strlen(command));
+}
+
+static void feed(uint8_t channel, uint32_t id, uint8_t flags)
+{
+    struct can_gateway_record record = {
+        .id = sys_cpu_to_le32(id),
+        .channel = channel,
+        .flags = flags,
+    };
+
+    can_trace_feed(&trace, &record, 1);
+}
+
+static const struct can_gateway_record *find(const struct can_gateway_record *records,
+                                             size_t count, uint32_t id)
+{
+    for (size_t i = 0; i < count; i++) {
+        if (sys_le32_to_cpu(records[i].id) == id &&
+            !(records[i].flags & CAN_GATEWAY_OVERFLOW)) {
+            return &records[i];
+        }
+    }
+
+    return NULL;
+}
+
+static void before(void *fixture)
+{
+    ARG_UNUSED(fixture);
+
+    can_trace_reset(&trace);
+}
+
+ZTEST(can_trace, test_filters)
+{
+    const struct can_gateway_record *records;
+    size_t count;
+
+    zassert_true(can_trace_passthrough(&trace));
+    zassert_ok(configure("{\"filters\":[{\"id\":256,\"mask\":1792,\"ext\":false}]}"));
+    zassert_false(can_trace_passthrough(&trace));
+
+    feed(0, 0x100, 0);
+    feed(0, 0x1ff, 0);
+    feed(0, 0x200, 0);
+    feed(0, 0x100, CAN_GATEWAY_EXTENDED);
+
+    count = can_trace_take(&trace, 0, &records);
+    zassert_equal(count, 2);
+    zassert_equal(sys_le32_to_cpu(records[0].id), 0x100);
+    zassert_equal(sys_le32_to_cpu(records[1].id), 0x1ff);
+    can_trace_sent(&trace, 0);
+
+    /* Not due before the interval is over */
+    feed(0, 0x100, 0);
+    zassert_equal(can_trace_take(&trace, FLUSH_INTERVAL - 1, &records), 0);
+    zassert_equal(can_trace_take(&trace, FLUSH_INTERVAL, &records), 1);
+}
+
+ZTEST(can_trace, test_channels)
+{
+    const struct can_gateway_record *records;
+
+    zassert_ok(configure("{\"channels\":2}"));
+
+    feed(0, 1, 0);
+    feed(1, 2, 0);
+
+    zassert_equal(can_trace_take(&trace, 0, &records), 1);
+    zassert_equal(records[0].channel, 1);
+}
+
+ZTEST(can_trace, test_bad_commands)
+{
+    zassert_equal(configure("{\"channels\":256}"), -EINVAL);
+    zassert_equal(configure("{\"channels\":-1}"), -EINVAL);
+    zassert_equal(configure("{\"interval\":-5}"), -EINVAL);
+    zassert_equal(configure("{\"filters\":[{\"id\":-1,\"mask\":0,\"ext\":false}]}"), -EINVAL);
+    zassert_equal(configure("filters"), -EINVAL);
+
+    /* Nothing was applied */
+    zassert_true(can_trace_passthrough(&trace));
+
+    zassert_ok(configure("{\"interval\":5000}"));
+    zassert_equal(trace.interval, 1000, "interval not clamped");
+}
+
+ZTEST(can_trace, test_latest_compacts)
+{
+    const struct can_gateway_record *records;
+    const struct can_gateway_record *record;
+    size_t count;
+
+    zassert_ok(configure("{\"latest\":true}"));
+
+    feed(0, 1, 0);
+    feed(0, 2, 0);
+    feed(0, 1, 0);
+    feed(0, 2, 0);
+    feed(0, 1, 0);
+
+    count = can_trace_take(&trace, 0, &records);
+    zassert_equal(count, 2);
+
+    record = find(records, count, 1);
+    zassert_not_null(record);
+    zassert_equal(record->count, 3);
+
+    record = find(records, count, 2);
+    zassert_not_null(record);
+    zassert_equal(record->count, 2);
+}
+
+ZTEST(can_trace, test_untracked_reported)
+{
+    const struct can_gateway_record *records;
+    size_t count;
+
+    zassert_ok(configure("{\"latest\":true}"));
+
+    for (uint32_t id = 0; id < CAN_TRACE_IDS + 3; id++) {
+        feed(0, id, 0);
+    }
+
+    count = can_trace_take(&trace, 0, &records);
+    zassert_equal(count, CAN_TRACE_IDS + 1);
+    zassert_equal(records[count - 1].flags, CAN_GATEWAY_OVERFLOW);
+    zassert_equal(sys_le32_to_cpu(records[count - 1].id), 3);
+}
+
+ZTEST(can_trace, test_queue_overrun_compacts)
+{
+    const struct can_gateway_record *records;
+    const struct can_gateway_record *record;
+    size_t count;
+
+    zassert_ok(configure("{\"channels\":255}"));
+
+    for (uint32_t i = 0; i < CAN_TRACE_FRAMES + 1; i++) {
+        feed(0, i % 4, 0);
+    }
+
+    count = can_trace_take(&trace, 0, &records);
+    zassert_equal(count, 4, "overrun queue sent instead of a snapshot");
+
+    record = find(records, count, 0);
+    zassert_not_null(record);
+    zassert_equal(record->count, MIN(DIV_ROUND_UP(CAN_TRACE_FRAMES + 1, 4), UINT8_MAX));
+    can_trace_sent(&trace, 0);
+
+    /* Raw again from the next interval */
+    feed(0, 0, 0);
+    feed(0, 0, 0);
+    zassert_equal(can_trace_take(&trace, FLUSH_INTERVAL, &records), 2);
+}
+
+ZTEST(can_trace, test_ring_overflow_forwarded)
+{
+    const struct can_gateway_record *records;
+
+    feed(0, 5, CAN_GATEWAY_OVERFLOW);
+
+    zassert_equal(can_trace_take(&trace, 0, &records), 1);
+    zassert_equal(records[0].flags, CAN_GATEWAY_OVERFLOW);
+    zassert_equal(sys_le32_to_cpu(records[0].id), 5);
+    can_trace_sent(&trace, 0);
+
+    /* Reported once */
+    zassert_equal(can_trace_take(&trace, FLUSH_INTERVAL, &records), 0);
+}
+
+ZTEST(can_trace, test_slow_client_backed_off)
+{
+    const struct can_gateway_record *records;
+    const struct can_gateway_record *record;
+    size_t count;
+
+    for (int i = 0; i < 10; i++) {
+        can_trace_sent(&trace, FLUSH_INTERVAL);
+    }
+    zassert_equal(trace.interval, 1000);
+    zassert_false(can_trace_passthrough(&trace));
+
+    /* Compacted while backed off */
+    feed(0, 7, 0);
+    feed(0, 7, 0);
+    feed(0, 7, 0);
+    count = can_trace_take(&trace, 0, &records);
+    zassert_equal(count, 1);
+    record = find(records, count, 7);
+    zassert_not_null(record);
+    zassert_equal(record->count, 3);
+
+    /* and back to the requested interval once sends are fast again */
+    for (int i = 0; i < 100 && trace.interval > FLUSH_INTERVAL; i++) {
+        can_trace_sent(&trace, 0);
+    }
+    zassert_equal(trace.interval, FLUSH_INTERVAL);
+    zassert_true(can_trace_passthrough(&trace));
+}
+
+ZTEST(can_trace, test_blocked_client_skips)
+{
+    const struct can_gateway_record *records;
+
+    zassert_true(can_trace_blocked(&trace, 0));
+    zassert_equal(trace.interval, 2 * FLUSH_INTERVAL);
+
+    /* Nothing is due until the backed off interval is over */
+    zassert_false(can_trace_blocked(&trace, 2 * FLUSH_INTERVAL - 1));
+
+    feed(0, 9, 0);
+    feed(0, 9, 0);
+    zassert_equal(can_trace_take(&trace, 2 * FLUSH_INTERVAL, &records), 1);
+    zassert_equal(records[0].count, 2);
+}
+
+ZTEST_SUITE(can_trace, NULL, NULL, before, NULL, NULL);
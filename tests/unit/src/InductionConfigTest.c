@@ -0,0 +1,141 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "InductionConfig.h"
+
+/* Bit n is field n of DHCP_t */
+#define FIELD_DHCP       BIT(0)
+#define FIELD_IP4ADDRESS BIT(1)
+#define FIELD_NETMASK    BIT(2)
+#define FIELD_CAN_1_0    BIT(3)
+#define FIELD_CAN_2_3    BIT(10)
+
+static int parse(InductionConfigParser_t *parser, const char *text)
+{
+    InductionConfigParser_init(parser);
+    InductionConfigParser_feed(parser, text, strlen(text));
+    return InductionConfigParser_finish(parser);
+}
+
+static void check_message(const InductionConfigParser_t *parser)
+{
+    zassert_equal(parser->fields,
+                  FIELD_DHCP | FIELD_IP4ADDRESS | FIELD_CAN_1_0 | FIELD_CAN_2_3);
+    zassert_str_equal(parser->config.cfg.DHCP, "off");
+    zassert_str_equal(parser->config.cfg.IP4Address, "10.0.0.2");
+    zassert_equal(parser->config.cfg.isEnabled_CAN_1_0, 1);
+    zassert_equal(parser->config.cfg.isEnabled_CAN_2_3, -7);
+}
+
+ZTEST(induction_config_parser, test_whole_message)
+{
+    InductionConfigParser_t parser;
+
+    zassert_ok(parse(&parser, "{\"DHCP\":\"off\",\"IP4Address\":\"10.0.0.2\","
+                              "\"isEnabled_CAN_1_0\":true,\"isEnabled_CAN_2_3\":-7}"));
+    check_message(&parser);
+}
+
+ZTEST(induction_config_parser, test_chunk_boundaries)
+{
+    static const char text[] =
+        "{ \"DHCP\": \"off\", \"unknown\": \"x\\\"y\", "
+        "\"IP4Address\":\"10.0.0.2\",\"isEnabled_CAN_1_0\": true, "
+        "\"isEnabled_CAN_2_3\":-7 }";
+    InductionConfigParser_t parser;
+
+    /* Split in two at every position, then fed a byte at a time */
+    for (size_t split = 0; split <= strlen(text); split++) {
+        InductionConfigParser_init(&parser);
+        zassert_ok(InductionConfigParser_feed(&parser, text, split));
+        zassert_ok(InductionConfigParser_feed(&parser, &text[split], strlen(text) - split));
+        zassert_ok(InductionConfigParser_finish(&parser), "split at %zu", split);
+        check_message(&parser);
+    }
+
+    InductionConfigParser_init(&parser);
+    for (size_t i = 0; i < strlen(text); i++) {
+        zassert_ok(InductionConfigParser_feed(&parser, &text[i], 1));
+    }
+    zassert_ok(InductionConfigParser_finish(&parser));
+    check_message(&parser);
+}
+
+ZTEST(induction_config_parser, test_escapes)
+{
+    InductionConfigParser_t parser;
+
+    zassert_ok(parse(&parser, "{\"NetMask\":\"a\\\"b\\\\c\\/d\"}"));
+    zassert_str_equal(parser.config.cfg.NetMask, "a\"b\\c/d");
+    zassert_equal(parser.fields, FIELD_NETMASK);
+
+    /* Would be decoded wrongly, so they are refused for our fields */
+    zassert_equal(parse(&parser, "{\"NetMask\":\"\\u0041\"}"), -EINVAL);
+    zassert_equal(parse(&parser, "{\"NetMask\":\"a\\nb\"}"), -EINVAL);
+
+    /* and only skipped in the values of other keys */
+    zassert_ok(parse(&parser, "{\"other\":\"\\u0041\\n\",\"DHCP\":\"on\"}"));
+    zassert_equal(parser.fields, FIELD_DHCP);
+
+    /* An escaped quote in a key does not end it */
+    zassert_ok(parse(&parser, "{\"DH\\\"CP\":\"on\"}"));
+    zassert_equal(parser.fields, 0);
+}
+
+ZTEST(induction_config_parser, test_errors)
+{
+    InductionConfigParser_t parser;
+
+    zassert_equal(parse(&parser, "{\"DHCP\":\"0123456789abcdef\"}"), -E2BIG);
+    zassert_equal(parse(&parser, "{\"DHCP\":7}"), -EINVAL);
+    zassert_equal(parse(&parser, "{\"isEnabled_CAN_1_0\":\"on\"}"), -EINVAL);
+    zassert_equal(parse(&parser, "{\"isEnabled_CAN_1_0\":12x}"), -EINVAL);
+    zassert_equal(parse(&parser, "{\"isEnabled_CAN_1_0\":4294967296}"), -EINVAL);
+    zassert_equal(parse(&parser, "{\"DHCP\":\"on\""), -EINVAL);
+    zassert_equal(parse(&parser, "{\"DHCP\":\"on\"} x"), -EINVAL);
+
+    /* The configuration is flat, whatever the key */
+    zassert_equal(parse(&parser, "{\"other\":{\"DHCP\":\"on\"}}"), -ENOTSUP);
+
+    /* The first error sticks */
+    InductionConfigParser_init(&parser);
+    zassert_equal(InductionConfigParser_feed(&parser, "{\"DHCP\":[", 9), -ENOTSUP);
+    zassert_equal(InductionConfigParser_feed(&parser, "]}", 2), -ENOTSUP);
+    zassert_equal(InductionConfigParser_finish(&parser), -ENOTSUP);
+}
+
+ZTEST(induction_config_parser, test_apply_writes_parsed_fields)
+{
+    InductionConfigParser_t parser;
+    InductionConfig_t config;
+
+    InductionConfig_get(&config);
+    strcpy(config.dhcp, "on");
+    strcpy(config.netmask, "255.255.255.0");
+    config.cfg.isEnabled_CAN_1_1 = 1;
+    InductionConfig_set(&config);
+
+    zassert_ok(parse(&parser, "{\"NetMask\":\"255.0.0.0\",\"isEnabled_CAN_1_1\":false}"));
+
+    /* Changed while the input was parsed, and not part of it */
+    strcpy(config.dhcp, "off");
+    InductionConfig_set(&config);
+
+    InductionConfigParser_apply(&parser);
+
+    InductionConfig_get(&config);
+    zassert_str_equal(config.cfg.DHCP, "off");
+    zassert_str_equal(config.cfg.NetMask, "255.0.0.0");
+    zassert_equal(config.cfg.isEnabled_CAN_1_1, 0);
+}
+
+ZTEST_SUITE(induction_config_parser, NULL, NULL, NULL, NULL, NULL);
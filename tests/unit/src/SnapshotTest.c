@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "InductionConfig.h"
+
+static void set_netmask(const char *netmask)
+{
+    InductionConfig_t config;
+
+    InductionConfig_get(&config);
+    strcpy(config.netmask, netmask);
+    InductionConfig_set(&config);
+}
+
+ZTEST(config_snapshot, test_held_snapshot_is_stable)
+{
+    const InductionConfig_t *held;
+    const InductionConfig_t *current;
+
+    set_netmask("255.255.0.0");
+    held = InductionConfig_acquire();
+
+    set_netmask("255.255.255.128");
+    zassert_str_equal(held->cfg.NetMask, "255.255.0.0", "held snapshot was reused");
+
+    current = InductionConfig_acquire();
+    zassert_not_equal(current, held);
+    zassert_str_equal(current->cfg.NetMask, "255.255.255.128");
+
+    InductionConfig_release(current);
+    InductionConfig_release(held);
+}
+
+ZTEST(config_snapshot, test_unchanged_config_not_republished)
+{
+    const InductionConfig_t *first;
+    const InductionConfig_t *second;
+
+    set_netmask("255.255.255.0");
+    first = InductionConfig_acquire();
+    InductionConfig_release(first);
+
+    set_netmask("255.255.255.0");
+    second = InductionConfig_acquire();
+    InductionConfig_release(second);
+
+    zassert_equal(first, second);
+}
+
+/* With every spare snapshot held, a change is published once one of them
+ * is released, the writer does not wait for it
+ */
+ZTEST(config_snapshot, test_publication_deferred_while_held)
+{
+    const InductionConfig_t *held[3];
+    const InductionConfig_t *current;
+
+    set_netmask("255.0.0.0");
+    held[0] = InductionConfig_acquire();
+    set_netmask("255.128.0.0");
+    held[1] = InductionConfig_acquire();
+    set_netmask("255.192.0.0");
+    held[2] = InductionConfig_acquire();
+
+    set_netmask("255.224.0.0");
+    zassert_str_equal(held[0]->cfg.NetMask, "255.0.0.0", "published into a held snapshot");
+
+    current = InductionConfig_acquire();
+    zassert_equal(current, held[2], "nothing free to publish into");
+    InductionConfig_release(current);
+
+    /* Retried from the system work queue */
+    InductionConfig_release(held[0]);
+    k_msleep(10);
+
+    current = InductionConfig_acquire();
+    zassert_equal(current, held[0], "the released snapshot is the only free one");
+    zassert_str_equal(current->cfg.NetMask, "255.224.0.0");
+    zassert_str_equal(held[1]->cfg.NetMask, "255.128.0.0");
+    zassert_str_equal(held[2]->cfg.NetMask, "255.192.0.0");
+
+    InductionConfig_release(current);
+    InductionConfig_release(held[1]);
+    InductionConfig_release(held[2]);
+}
+
+ZTEST_SUITE(config_snapshot, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "TagDb.h"
+
+#define READER_STACK_SIZE (1024 + CONFIG_TEST_EXTRA_STACK_SIZE)
+
+static K_THREAD_STACK_DEFINE(reader_stack, READER_STACK_SIZE);
+static struct k_thread reader_thread;
+static struct tag_value reader_values[2];
+
+struct notified_listener {
+    struct tag_listener listener;
+    uint32_t calls;
+    uint32_t tags;
+};
+
+static void count_notify(struct tag_listener *listener, uint32_t tags)
+{
+    struct notified_listener *notified = CONTAINER_OF(listener, struct notified_listener,
+                                                      listener);
+
+    notified->calls++;
+    notified->tags |= tags;
+}
+
+static uint32_t read_u32(enum tag_id id)
+{
+    struct tag_value value;
+
+    tag_db_get(id, &value);
+    return value.u32;
+}
+
+static void write_u32(enum tag_id id, uint32_t value)
+{
+    tag_db_write_begin();
+    tag_db_set_u32(id, value);
+    tag_db_write_end();
+}
+
+static void reader(void *p1, void *p2, void *p3)
+{
+    ARG_UNUSED(p1);
+    ARG_UNUSED(p2);
+    ARG_UNUSED(p3);
+
+    tag_db_read(TAG_BYTES_RECV, ARRAY_SIZE(reader_values), reader_values);
+}
+
+ZTEST(tag_db, test_read_does_not_wait_for_writer)
+{
+    uint32_t before = read_u32(TAG_BYTES_RECV);
+    k_tid_t tid;
+
+    tag_db_write_begin();
+    tag_db_set_u32(TAG_BYTES_RECV, before + 1);
+    tag_db_set_u32(TAG_BYTES_SENT, before + 1);
+
+    /* The write lock is held, a reader still gets the committed values */
+    tid = k_thread_create(&reader_thread, reader_stack, K_THREAD_STACK_SIZEOF(reader_stack),
+                          reader, NULL, NULL, NULL,
+                          k_thread_priority_get(k_current_get()), 0, K_NO_WAIT);
+    zassert_ok(k_thread_join(tid, K_MSEC(100)), "reader blocked on the writer");
+    zassert_equal(reader_values[0].u32, before, "staged value visible before the commit");
+
+    zassert_equal(tag_db_write_end(), TAG_MASK(TAG_BYTES_RECV) | TAG_MASK(TAG_BYTES_SENT));
+    zassert_equal(read_u32(TAG_BYTES_RECV), before + 1);
+    zassert_equal(read_u32(TAG_BYTES_SENT), before + 1);
+}
+
+ZTEST(tag_db, test_version_moves_on_change_only)
+{
+    struct tag_value first;
+    struct tag_value second;
+
+    write_u32(TAG_TCP_RECV, read_u32(TAG_TCP_RECV) + 1);
+    tag_db_get(TAG_TCP_RECV, &first);
+
+    tag_db_write_begin();
+    tag_db_set_u32(TAG_TCP_RECV, first.u32);
+    zassert_equal(tag_db_write_end(), 0, "an unchanged value was reported");
+
+    tag_db_get(TAG_TCP_RECV, &second);
+    zassert_equal(second.version, first.version);
+
+    write_u32(TAG_TCP_RECV, first.u32 + 1);
+    tag_db_get(TAG_TCP_RECV, &second);
+    zassert_equal(second.version, first.version + 1);
+}
+
+ZTEST(tag_db, test_string_truncated)
+{
+    struct tag_value value;
+    struct tag_value saved;
+
+    tag_db_get(TAG_NETMASK, &saved);
+
+    tag_db_write_begin();
+    tag_db_set_str(TAG_NETMASK, "0123456789abcdefghij");
+    tag_db_write_end();
+
+    tag_db_get(TAG_NETMASK, &value);
+    zassert_str_equal(value.str, "0123456789abcde");
+
+    tag_db_write_begin();
+    tag_db_set_str(TAG_NETMASK, saved.str);
+    tag_db_write_end();
+}
+
+ZTEST(tag_db, test_listener_dirty_bits)
+{
+    struct notified_listener notified = {
+        .listener = {
+            .tags = TAG_MASK(TAG_IPV4_RECV) | TAG_MASK(TAG_IPV4_SENT),
+            .notify = count_notify,
+        },
+    };
+    uint32_t value = read_u32(TAG_IPV4_RECV);
+
+    tag_db_listen(&notified.listener);
+
+    /* Tags of no interest leave the listener alone */
+    write_u32(TAG_IPV6_RECV, read_u32(TAG_IPV6_RECV) + 1);
+    zassert_equal(notified.calls, 0);
+    zassert_equal(tag_db_changes(&notified.listener), 0);
+
+    write_u32(TAG_IPV4_RECV, ++value);
+    zassert_equal(notified.calls, 1);
+    zassert_equal(notified.tags, TAG_MASK(TAG_IPV4_RECV));
+
+    /* Still dirty, so not signalled again */
+    write_u32(TAG_IPV4_RECV, ++value);
+    zassert_equal(notified.calls, 1);
+
+    /* Another tag of interest is signalled on its own */
+    write_u32(TAG_IPV4_SENT, read_u32(TAG_IPV4_SENT) + 1);
+    zassert_equal(notified.calls, 2);
+
+    zassert_equal(tag_db_changes(&notified.listener),
+                  TAG_MASK(TAG_IPV4_RECV) | TAG_MASK(TAG_IPV4_SENT));
+    zassert_equal(tag_db_changes(&notified.listener), 0, "changes not cleared");
+
+    /* Taking the changes arms the notification again */
+    write_u32(TAG_IPV4_RECV, ++value);
+    zassert_equal(notified.calls, 3);
+
+    tag_db_unlisten(&notified.listener);
+    write_u32(TAG_IPV4_RECV, ++value);
+    zassert_equal(notified.calls, 3, "notified after unlisten");
+}
+
+ZTEST_SUITE(tag_db, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2025
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "TokenBucket.h"
+
+/* Uptime only moves while the test sleeps, so without a sleep the expected
+ * delays are exact
+ */
+
+ZTEST(token_bucket, test_burst_then_limited)
+{
+    struct token_bucket bucket;
+
+    token_bucket_init(&bucket, 10, 5);
+
+    for (int i = 0; i < 5; i++) {
+        zassert_equal(token_bucket_take(&bucket, 1), 0, "token %d of the burst", i);
+    }
+
+    /* One token at 10 per second is paid back in 100 ms */
+    zassert_equal(token_bucket_take(&bucket, 1), 100);
+}
+
+ZTEST(token_bucket, test_debt_and_refill)
+{
+    struct token_bucket bucket;
+    int64_t start;
+
+    token_bucket_init(&bucket, 10, 5);
+
+    /* Taken in full even though only 5 are there */
+    zassert_equal(token_bucket_take(&bucket, 8), 300);
+
+    /* Sleeps end on a tick, so they may take a little longer */
+    start = k_uptime_get();
+    k_msleep(200);
+    zassert_equal(token_bucket_take(&bucket, 0), 300 - (k_uptime_get() - start),
+                  "refill not credited");
+
+    k_msleep(100);
+    zassert_equal(token_bucket_take(&bucket, 0), 0, "debt not paid back");
+
+    /* Refilled up to the burst only */
+    k_msleep(2000);
+    zassert_equal(token_bucket_take(&bucket, 5), 0);
+    zassert_equal(token_bucket_take(&bucket, 1), 100);
+}
+
+ZTEST(token_bucket, test_rounds_delay_up)
+{
+    struct token_bucket bucket;
+
+    token_bucket_init(&bucket, 3, 0);
+
+    /* A third of a second is 333.3 ms, waiting 333 would still owe */
+    zassert_equal(token_bucket_take(&bucket, 1), 334);
+}
+
+ZTEST(token_bucket, test_no_limit)
+{
+    struct token_bucket bucket;
+
+    token_bucket_init(&bucket, 0, 0);
+
+    zassert_equal(token_bucket_take(&bucket, UINT32_MAX), 0);
+    zassert_equal(token_bucket_take(&bucket, UINT32_MAX), 0);
+}
+
+ZTEST(token_bucket, test_configure_keeps_debt)
+{
+    struct token_bucket bucket;
+
+    token_bucket_init(&bucket, 10, 5);
+    zassert_equal(token_bucket_take(&bucket, 7), 200);
+
+    /* The same debt is paid back faster at the new rate */
+    token_bucket_configure(&bucket, 20, 5);
+    zassert_equal(token_bucket_take(&bucket, 0), 100);
+
+    /* A smaller burst caps the balance at once */
+    token_bucket_init(&bucket, 10, 5);
+    token_bucket_configure(&bucket, 10, 2);
+    zassert_equal(token_bucket_take(&bucket, 3), 100);
+}
+
+ZTEST_SUITE(token_bucket, NULL, NULL, NULL, NULL, NULL);